@@ -5,6 +5,7 @@ import { GatesPanel } from "@/components/GatesPanel";
 import { TelemetryPanel } from "@/components/TelemetryPanel";
 import type { GateConfig, GateRow, TimingGate, Telemetry } from "@/lib/types";
 import { FAKE_CONFIGS, generateFakeGates, generateFakeTelemetry } from "@/lib/types";
+import { hexToBytes, parseTelemetryFrame } from "@/lib/telemetry";
 import { ThemeToggle } from "@/components/theme-toggle.tsx";
 import {Button} from "@/components/ui/button.tsx";
 import {Input} from "@/components/ui/input.tsx";
@@ -31,8 +32,9 @@ const GATE_HISTORY_MAX = 20;
 function App() {
   const [gates, setGates] = useState<TimingGate[]>([]);
   const [configs, setConfigs] = useState<GateConfig[]>([]);
-  const [telemetry, setTelemetry] = useState<Telemetry[]>([]);
-  const [telemHistory, setTelemHistory] = useState<Record<string, { t: number; raw: string }[]>>({});
+  const [telemMap, setTelemMap] = useState<Record<string, number[]>>({});
+  const [telemSeenAt, setTelemSeenAt] = useState<number>(0);
+  const [telemHistory, setTelemHistory] = useState<Record<string, { t: number; raw: number[] }[]>>({});
   const [gateHistory, setGateHistory] = useState<Record<string, { diff_us: number; t: number; timestamp_us: number }[]>>({});
   const prevGateTimestamps = useRef<Record<string, number>>({});
   const [recvConnected, setRecvConnected] = useState<boolean>(false);
@@ -55,6 +57,37 @@ function App() {
     for (const g of changed) prev[g.mac] = g.timestamp_us;
   };
 
+  const applyTelemetry = (values: Record<string, number[]>, seenAt?: number) => {
+    setTelemMap(prev => ({ ...prev, ...values }));
+    if (seenAt !== undefined) setTelemSeenAt(seenAt);
+    setTelemHistory(prev => {
+      const next = { ...prev };
+      const now = Date.now();
+      const windowMs = 30_000; // keep last 30 seconds
+      for (const [key, raw] of Object.entries(values)) {
+        const arr = next[key] ? [...next[key]] : [];
+        arr.push({ t: now, raw });
+        const cutoff = now - windowMs;
+        const pruned = arr.filter(p => p.t >= cutoff);
+        next[key] = pruned;
+      }
+      return next;
+    });
+  };
+
+  // JSON rows from /telemetry carry hex strings plus the receiver's telemetryPing (ms since last frame).
+  // A ?since= delta only includes telemetryPing when a frame arrived after the cursor.
+  const applyTelemetryRows = (rows: Telemetry[]) => {
+    const values: Record<string, number[]> = {};
+    let ping: number | undefined;
+    for (const { key, value } of rows) {
+      if (key === "telemetryPing") ping = parseInt(value, 10);
+      else values[key] = hexToBytes(value);
+    }
+    if (ping === undefined) applyTelemetry(values);
+    else applyTelemetry(values, Date.now() - (Number.isFinite(ping) ? ping : 9999));
+  };
+
   const fetchConfigs = () =>
     fetch("/gate-config").then(r => r.json()).then(setConfigs).catch(() => {});
 
@@ -102,91 +135,125 @@ function App() {
         const newGates = generateFakeGates();
         setGates(newGates);
         recordGateHistory(newGates);
-        const generated = generateFakeTelemetry();
-        setTelemetry(generated);
-        setTelemHistory(prev => {
-          const next = { ...prev };
-          const now = Date.now();
-          const windowMs = 30_000;
-          for (const item of generated) {
-            const arr = next[item.key] ? [...next[item.key]] : [];
-            arr.push({ t: now, raw: item.value });
-            // prune old entries outside the time window
-            const cutoff = now - windowMs;
-            const pruned = arr.filter(p => p.t >= cutoff);
-            next[item.key] = pruned;
-          }
-          return next;
-        });
+        applyTelemetryRows(generateFakeTelemetry());
       }, 500);
       return () => clearInterval(id);
     } else {
+      // ?since= deltas only carry the gates that changed, so merge by mac.
+      const applyTiming = (newGates: TimingGate[]) => {
+        if (newGates.length === 0) return;
+        setGates(prev => [...prev.filter(g => !newGates.some(n => n.mac === g.mac)), ...newGates]);
+        recordGateHistory(newGates);
+        setConfigs(prev => {
+          const toRegister = newGates.filter(g => !prev.find(c => c.mac === g.mac));
+          if (toRegister.length === 0) return prev;
+          const next = [...prev];
+          for (const g of toRegister) {
+            const newCfg: GateConfig = { mac: g.mac, mode: "delta", group: "", order: next.length };
+            next.push(newCfg);
+            postConfig(newCfg).then(fetchConfigs);
+          }
+          return next;
+        });
+      };
+
+      // Telemetry arrives as binary frames and gate events as JSON text over one WebSocket.
+      let ws: WebSocket | null = null;
+      let retry: number | undefined;
+      let closed = false;
+      const connect = () => {
+        const sock = new WebSocket(`${location.protocol === "https:" ? "wss" : "ws"}://${location.host}/ws`);
+        sock.binaryType = "arraybuffer";
+        sock.onopen = () => setRecvConnected(true);
+        sock.onmessage = e => {
+          if (typeof e.data === "string") {
+            applyTiming(JSON.parse(e.data));
+            return;
+          }
+          const frame = parseTelemetryFrame(e.data as ArrayBuffer);
+          if (frame) applyTelemetry(frame.values, Date.now());
+        };
+        sock.onclose = () => {
+          setRecvConnected(false);
+          if (!closed) retry = window.setTimeout(connect, 2000);
+        };
+        ws = sock;
+      };
+      connect();
+
+      // Polling fallback: each endpoint returns X-State-Version, sent back as ?since= so an
+      // unchanged receiver answers 304 and a changed one only the rows that moved.
+      const cursors: Record<string, string> = {};
+      const pollDelta = <T,>(path: string, apply: (rows: T) => void) =>
+        fetchWithTimeout(cursors[path] ? `${path}?since=${cursors[path]}` : path, {}, 1200)
+          .then(r => {
+            if (r.status === 304) return;
+            if (!r.ok) throw new Error(r.statusText);
+            const version = r.headers.get("X-State-Version");
+            return r.json().then((rows: T) => {
+              apply(rows);
+              if (version) cursors[path] = version;
+            });
+          })
+          .catch(() => {});
+
+      // Gate triggers are rare but latency matters, so while the socket is down one
+      // /timing/wait long-poll stays open and hands over each trigger as it lands.
+      let waitCursor = "";
+      let waiting = false;
+      const waitGates = () => {
+        if (closed || waiting || ws?.readyState === WebSocket.OPEN) return;
+        waiting = true;
+        fetchWithTimeout(waitCursor ? `/timing/wait?since=${waitCursor}` : "/timing/wait", {}, 30_000)
+          .then(r => {
+            const version = r.headers.get("X-State-Version");
+            if (r.status === 204) {
+              if (version) waitCursor = version;
+              return;
+            }
+            if (!r.ok) throw new Error(r.statusText);
+            return r.json().then((rows: TimingGate[]) => {
+              applyTiming(rows);
+              if (version) waitCursor = version;
+            });
+          })
+          .then(() => 0, () => 1000)
+          .then(delay => {
+            waiting = false;
+            window.setTimeout(waitGates, delay);
+          });
+      };
+
       const id = setInterval(() => {
         fetchWithTimeout("/gate-config")
           .then(r => r.json())
           .then(setConfigs)
           .catch(() => {});
 
-        fetchWithTimeout("/timing", {}, 1200)
-          .then(r => r.json())
-          .then((newGates: TimingGate[]) => {
-            setGates(newGates);
-            recordGateHistory(newGates);
-            setConfigs(prev => {
-              const toRegister = newGates.filter(g => !prev.find(c => c.mac === g.mac));
-              if (toRegister.length === 0) return prev;
-              const next = [...prev];
-              for (const g of toRegister) {
-                const newCfg: GateConfig = { mac: g.mac, mode: "delta", group: "", order: next.length };
-                next.push(newCfg);
-                postConfig(newCfg).then(fetchConfigs);
-              }
-              return next;
-            });
-          }).catch(() => {});
+        // While the socket is down, fall back to polling.
+        if (ws?.readyState === WebSocket.OPEN) return;
 
-        fetchWithTimeout("/telemetry", {}, 1200)
-          .then(r => r.json())
-          .then(v => {
-            setTelemetry(v);
-            setTelemHistory(prev => {
-              const next = { ...prev };
-              const now = Date.now();
-              const windowMs = 30_000; // keep last 30 seconds
-              for (const item of v) {
-                const arr = next[item.key] ? [...next[item.key]] : [];
-                arr.push({ t: now, raw: item.value });
-                const cutoff = now - windowMs;
-                const pruned = arr.filter(p => p.t >= cutoff);
-                next[item.key] = pruned;
-              }
-              return next;
-            });
-          }).catch(() => {});
+        waitGates();
+        pollDelta<TimingGate[]>("/timing", applyTiming);
+        pollDelta<Telemetry[]>("/telemetry", applyTelemetryRows);
 
         fetchWithTimeout("/status", {}, 800)
           .then(r => r.text())
-          .then(v => {
-            const ok = v === "OK";
-            setRecvConnected(ok);
-          })
-          .catch(() => {
-            setRecvConnected(false);
-          });
-      }, 100);
-      return () => clearInterval(id);
+          .then(v => setRecvConnected(v === "OK"))
+          .catch(() => setRecvConnected(false));
+      }, 1000);
+      return () => {
+        closed = true;
+        clearInterval(id);
+        clearTimeout(retry);
+        ws?.close();
+      };
     }
   }, [fake]);
 
-  const telemMap = Object.fromEntries(telemetry.map(t => [t.key, t.value]));
   const groups = buildGroups(configs, gates);
 
-  const lastTelemPing = (() => {
-    const raw = telemMap['telemetryPing'] ?? telemMap.telemetryPing;
-    if (raw === undefined || raw === null) return 9999;
-    const n = typeof raw === 'number' ? raw : parseInt(String(raw), 10);
-    return Number.isFinite(n) ? n : 9999;
-  })();
+  const lastTelemPing = telemSeenAt ? Date.now() - telemSeenAt : 9999;
 
   const [loggerName, setLoggerName] = useState<string>("");
 
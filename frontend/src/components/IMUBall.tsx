@@ -1,20 +1,17 @@
-type TelemHistory = Record<string, { t: number; raw: string }[]>;
+import { fieldValue } from '@/lib/telemetry';
 
-function lastRaw(hist: TelemHistory, key: string): string | undefined {
+type TelemHistory = Record<string, { t: number; raw: number[] }[]>;
+
+function lastRaw(hist: TelemHistory, key: string): number[] | undefined {
   const arr = hist[key] ?? [];
   return arr.length ? arr[arr.length - 1].raw : undefined;
 }
 
-function i16be(b: number[], i: number): number {
-  const v = (b[i] << 8) | b[i + 1];
-  return v > 32767 ? v - 65536 : v;
-}
-
-function parseAccel(raw: string | undefined): { x: number; y: number } | null {
-  if (!raw) return null;
-  const b = raw.split(' ').map(h => parseInt(h, 16));
-  if (b.length < 4) return null;
-  return { x: i16be(b, 0), y: i16be(b, 2) };
+function parseAccel(b: number[] | undefined): { x: number; y: number } | null {
+  if (!b) return null;
+  const x = fieldValue('imu_accel', 'X', b);
+  const y = fieldValue('imu_accel', 'Y', b);
+  return x === null || y === null ? null : { x, y };
 }
 
 export default function IMUBall({ telemHistory }: { telemHistory: TelemHistory }) {
@@ -56,8 +53,8 @@ export default function IMUBall({ telemHistory }: { telemHistory: TelemHistory }
       </svg>
       {accel && (
         <div className="flex gap-4 text-xs font-mono tabular-nums text-muted-foreground">
-          <span>X {accel.x > 0 ? '+' : ''}{accel.x} mg</span>
-          <span>Y {accel.y > 0 ? '+' : ''}{accel.y} mg</span>
+          <span>X {accel.x > 0 ? '+' : ''}{accel.x.toFixed(1)} mg</span>
+          <span>Y {accel.y > 0 ? '+' : ''}{accel.y.toFixed(1)} mg</span>
         </div>
       )}
     </div>
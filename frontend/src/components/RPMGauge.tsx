@@ -51,23 +51,21 @@ export function Gauge({ value, max, label, unit, zones }: GaugeProps) {
   );
 }
 
-type TelemHistory = Record<string, { t: number; raw: string }[]>;
+type TelemHistory = Record<string, { t: number; raw: number[] }[]>;
 
-function lastRaw(hist: TelemHistory, key: string): string | undefined {
+function lastRaw(hist: TelemHistory, key: string): number[] | undefined {
   const arr = hist[key] ?? [];
   return arr.length ? arr[arr.length - 1].raw : undefined;
 }
 
-function parseU16BE(raw: string | undefined, byteOffset: number): number | null {
-  if (!raw) return null;
-  const b = raw.split(' ').map(x => parseInt(x, 16));
+function parseU16BE(b: number[] | undefined, byteOffset: number): number | null {
+  if (!b) return null;
   if (b.length < byteOffset + 2 || Number.isNaN(b[byteOffset]) || Number.isNaN(b[byteOffset + 1])) return null;
   return (b[byteOffset] << 8) | b[byteOffset + 1];
 }
 
-function parseU8(raw: string | undefined, byteOffset: number): number | null {
-  if (!raw) return null;
-  const b = raw.split(' ').map(x => parseInt(x, 16));
+function parseU8(b: number[] | undefined, byteOffset: number): number | null {
+  if (!b) return null;
   if (b.length <= byteOffset || Number.isNaN(b[byteOffset])) return null;
   return b[byteOffset];
 }
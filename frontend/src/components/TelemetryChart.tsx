@@ -1,25 +1,25 @@
 import { useMemo, useState, useRef, useEffect } from 'react';
 import { Button } from '@/components/ui/button';
 
-interface Series { key: string; label: string; unit: string; color: string; extractor: (raw: string) => number | null }
+interface Series { key: string; label: string; unit: string; color: string; extractor: (b: number[]) => number | null }
 interface Point { t: number; v: number }
 
 const COLORS = ["#ef4444", "#f59e0b", "#10b981", "#60a5fa", "#7c3aed", "#ec4899", "#14b8a6"];
 
 function hexToSeries() {
   const series: Series[] = [
-    { key: 'eng_f0', label: 'RPM', unit: 'rpm', color: COLORS[0], extractor: (r) => { const b = r.split(' ').map(x=>parseInt(x,16)); if (b.length>=2) return (b[0]<<8)|b[1]; return null } },
-    { key: 'oil_temp', label: 'Oil Temp', unit: '°C', color: COLORS[1], extractor: (r) => { const b = r.split(' ').map(x=>parseInt(x,16)); // try eng_f0 byte 3
+    { key: 'eng_f0', label: 'RPM', unit: 'rpm', color: COLORS[0], extractor: (b) => { if (b.length>=2) return (b[0]<<8)|b[1]; return null } },
+    { key: 'oil_temp', label: 'Oil Temp', unit: '°C', color: COLORS[1], extractor: (b) => { // try eng_f0 byte 3
         if (b.length>=4) return b[3]; return null } },
-    { key: 'oil_press', label: 'Oil Press', unit: 'kPa', color: COLORS[2], extractor: (r) => { const b = r.split(' ').map(x=>parseInt(x,16)); // try eng_f0 u16be at 4
+    { key: 'oil_press', label: 'Oil Press', unit: 'kPa', color: COLORS[2], extractor: (b) => { // try eng_f0 u16be at 4
         if (b.length>=6) return (b[4]<<8)|b[5]; return null } },
-    { key: 'fuel_press', label: 'Fuel Press', unit: 'kPa', color: COLORS[3], extractor: (r) => { const b = r.split(' ').map(x=>parseInt(x,16)); // eng_f2 u16be at 2
+    { key: 'fuel_press', label: 'Fuel Press', unit: 'kPa', color: COLORS[3], extractor: (b) => { // eng_f2 u16be at 2
         if (b.length>=4) return (b[2]<<8)|b[3]; return null } },
   ];
   return series;
 }
 
-export default function TelemetryChart({ telemHistory, height = 180 }: { telemHistory: Record<string, { t: number; raw: string }[]>; height?: number }) {
+export default function TelemetryChart({ telemHistory, height = 180 }: { telemHistory: Record<string, { t: number; raw: number[] }[]>; height?: number }) {
     const seriesDefs = useMemo(() => hexToSeries(), []);
     const [enabled, setEnabled] = useState<Record<string, boolean>>(() => Object.fromEntries(seriesDefs.map(s => [s.key, s.key === 'eng_f0' || s.key === 'oil_press'])));
   // responsive width measurement
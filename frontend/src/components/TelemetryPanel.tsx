@@ -4,7 +4,7 @@ import TelemetryChart from "./TelemetryChart";
 import RPMGauge, { OilTempGauge, OilPressGauge } from "./RPMGauge";
 import IMUBall from "./IMUBall";
 
-interface Props { telemMap: Record<string, string>; telemHistory?: Record<string, { t: number; raw: string }[]> }
+interface Props { telemMap: Record<string, number[]>; telemHistory?: Record<string, { t: number; raw: number[] }[]> }
 
 export function TelemetryPanel({ telemMap, telemHistory }: Props) {
   const hist = telemHistory ?? {};
@@ -20,7 +20,7 @@ export function TelemetryPanel({ telemMap, telemHistory }: Props) {
       <div className="grid grid-cols-2 gap-4 items-start">
         {TELEM_SECTIONS.map(section => {
           const entries = section.keys.flatMap(k => {
-            const d = decode(k, telemMap[k] ?? "");
+            const d = decode(k, telemMap[k] ?? []);
             return d ? d.fields.map(f => ({ label: `${d.label} ${f.name}`, value: f.value })) : [];
           });
           if (!entries.length) return null;
@@ -1,39 +1,50 @@
+import { TELEM_SEGMENTS, type TelemetryFieldDef } from "./telemetry_schema";
+
 export interface TelemetryField { name: string; value: string; }
 export interface DecodedTelemetry { label: string; fields: TelemetryField[]; }
 
-const bytes = (hex: string): number[] => hex.split(" ").map(h => parseInt(h, 16));
-const u16be = (b: number[], i: number) => (b[i] << 8) | b[i + 1];
-const i16be = (b: number[], i: number) => { const v = u16be(b, i); return v > 32767 ? v - 65536 : v; };
-const i16le = (b: number[], i: number) => { const v = b[i] | (b[i + 1] << 8); return v > 32767 ? v - 65536 : v; };
-
-function wheelFields(b: number[]): TelemetryField[] {
-  return [
-    { name: "Speed", value: u16be(b, 0) + " rpm" },
-    { name: "Temp",  value: i16be(b, 2) + " °C"  },
-    { name: "Load",  value: u16be(b, 4) + " N"   },
-  ];
+export const hexToBytes = (hex: string): number[] => hex.split(" ").map(h => parseInt(h, 16));
+
+// Field layout, scaling and byte order come from tools/telemetry_schema.json,
+// the same table the receiver decodes with.
+const SEGMENT_BY_KEY = new Map(TELEM_SEGMENTS.map(s => [s.key, s]));
+
+export function fieldRaw(f: TelemetryFieldDef, b: number[]): number | null {
+  const i = f.offset;
+  if (f.type === "u8") return b.length > i && !Number.isNaN(b[i]) ? b[i] : null;
+  if (b.length < i + 2 || Number.isNaN(b[i]) || Number.isNaN(b[i + 1])) return null;
+  const v = f.be ? (b[i] << 8) | b[i + 1] : b[i] | (b[i + 1] << 8);
+  return f.type === "i16" && v > 32767 ? v - 65536 : v;
+}
+
+// Same integer arithmetic as telemetry_format_field() on the receiver, so
+// both print identical strings.
+export function formatField(f: TelemetryFieldDef, raw: number): string {
+  if (f.labels?.length) return f.labels[Math.max(0, Math.min(raw, f.labels.length - 1))];
+  const p = 10 ** f.decimals;
+  const n = raw * f.num * p;
+  const q = Math.trunc((2 * n + (n < 0 ? -f.den : f.den)) / (2 * f.den));
+  const a = Math.abs(q);
+  const sign = q < 0 ? "-" : "";
+  if (!f.decimals) return sign + a;
+  return sign + Math.floor(a / p) + "." + String(a % p).padStart(f.decimals, "0");
 }
 
-export function decode(key: string, raw: string): DecodedTelemetry | null {
-  const b = bytes(raw);
-  switch (key) {
-    case "drs":       return { label: "DRS",     fields: [{ name: "State", value: b[0] ? "Open" : "Closed" }] };
-    case "imu_gyro":  return { label: "Gyro",    fields: [{ name: "X", value: (i16le(b,0) * 0.0175).toFixed(2) + " °/s" }, { name: "Y", value: (i16le(b,2) * 0.0175).toFixed(2) + " °/s" }, { name: "Z", value: (i16le(b,4) * 0.0175).toFixed(2) + " °/s" }] };
-    case "imu_accel": return { label: "Accel",   fields: [{ name: "X", value: (i16le(b,0) * 0.122).toFixed(2) + " mg"  }, { name: "Y", value: (i16le(b,2) * 0.122).toFixed(2) + " mg"  }, { name: "Z", value: (i16le(b,4) * 0.122).toFixed(2) + " mg"  }] };
-    case "wheel_fl":  return { label: "FL",      fields: wheelFields(b) };
-    case "wheel_fr":  return { label: "FR",      fields: wheelFields(b) };
-    case "wheel_rr":  return { label: "RR",      fields: wheelFields(b) };
-    case "wheel_rl":  return { label: "RL",      fields: wheelFields(b) };
-    case "sg_fl":     return { label: "FL",      fields: [{ name: "Pos", value: u16be(b, 0) + "" }] };
-    case "sg_fr":     return { label: "FR",      fields: [{ name: "Pos", value: u16be(b, 0) + "" }] };
-    case "sg_rr":     return { label: "RR",      fields: [{ name: "Pos", value: u16be(b, 0) + "" }] };
-    case "sg_rl":     return { label: "RL",      fields: [{ name: "Pos", value: u16be(b, 0) + "" }] };
-    case "eng_f0":    return { label: "Engine",  fields: [{ name: "RPM", value: u16be(b, 0) + " rpm" }, { name: "ECT", value: b[2] + " °C" }, { name: "Oil Temp", value: b[3] + " °C" }, { name: "Oil Press", value: u16be(b, 4) + " kPa" }, { name: "Neutral", value: b[6] ? "Yes" : "No" }] };
-    case "eng_f1":    return { label: "Engine",  fields: [{ name: "Lambda", value: b[0] + "" }, { name: "TPS", value: b[1] + "%" }, { name: "Gear", value: b[2] + "" }, { name: "WSPD", value: u16be(b, 3) + " km/h" }, { name: "Oil Press", value: u16be(b, 5) + " kPa" }] };
-    case "eng_f2":    return { label: "Engine",  fields: [{ name: "APS", value: u16be(b, 0) + "" }, { name: "Fuel Press", value: u16be(b, 2) + " kPa" }] };
-    case "shifter":   return { label: "Shifter", fields: [{ name: "S0", value: b[0] + "" }, { name: "S1", value: b[1] + "" }, { name: "S2", value: b[2] + "" }] };
-    default: return null;
-  }
+// Scaled value in the field's unit, for gauges and plots.
+export function fieldValue(key: string, name: string, b: number[]): number | null {
+  const f = SEGMENT_BY_KEY.get(key)?.fields.find(f => f.name === name);
+  const raw = f ? fieldRaw(f, b) : null;
+  return f && raw !== null ? (raw * f.num) / f.den : null;
+}
+
+export function decode(key: string, b: number[]): DecodedTelemetry | null {
+  const seg = SEGMENT_BY_KEY.get(key);
+  if (!seg || b.length < seg.len) return null;
+  const fields = seg.fields.map(f => {
+    const text = formatField(f, fieldRaw(f, b) ?? 0);
+    return { name: f.name, value: f.unit ? `${text} ${f.unit}` : text };
+  });
+  return { label: seg.label, fields };
 }
 
 export const TELEM_SECTIONS: { title: string; keys: string[] }[] = [
@@ -43,10 +54,25 @@ export const TELEM_SECTIONS: { title: string; keys: string[] }[] = [
   { title: "Suspension", keys: ["sg_fl", "sg_fr", "sg_rr", "sg_rl"] },
 ];
 
-export const TELEM_KEYS = [
-  {k:"drs",b:1},{k:"imu_gyro",b:6},{k:"imu_accel",b:6},
-  {k:"wheel_fl",b:6},{k:"wheel_fr",b:6},{k:"wheel_rr",b:6},{k:"wheel_rl",b:6},
-  {k:"sg_fl",b:2},{k:"sg_fr",b:2},{k:"sg_rr",b:2},{k:"sg_rl",b:2},
-  {k:"eng_f0",b:7},{k:"eng_f1",b:7},{k:"eng_f2",b:4},{k:"shifter",b:3},
-];
+export const TELEM_KEYS = TELEM_SEGMENTS.map(s => ({ k: s.key, b: s.len }));
 
+// Binary telemetry frame pushed over /ws, built by render_telemetry_frame() in main/stream.c:
+// u8 type, u8 len, u16 valid (LE), u32 rx_ms (LE), then len payload bytes laid out as TELEM_KEYS.
+export const WS_FRAME_TELEMETRY = 0x01;
+const WS_HEADER_LEN = 8;
+
+export function parseTelemetryFrame(buf: ArrayBuffer): { rxMs: number; values: Record<string, number[]> } | null {
+  const v = new DataView(buf);
+  if (v.byteLength < WS_HEADER_LEN || v.getUint8(0) !== WS_FRAME_TELEMETRY) return null;
+  const len   = Math.min(v.getUint8(1), v.byteLength - WS_HEADER_LEN);
+  const valid = v.getUint16(2, true);
+  const rxMs  = v.getUint32(4, true);
+  const payload = new Uint8Array(buf, WS_HEADER_LEN, len);
+  const values: Record<string, number[]> = {};
+  let off = 0;
+  TELEM_KEYS.forEach(({ k, b }, s) => {
+    if ((valid & (1 << s)) && off + b <= len) values[k] = Array.from(payload.subarray(off, off + b));
+    off += b;
+  });
+  return { rxMs, values };
+}
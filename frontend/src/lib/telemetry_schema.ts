@@ -0,0 +1,96 @@
+// Generated by tools/gen_telemetry.py from tools/telemetry_schema.json. Do not edit.
+
+export type TelemetryFieldType = "u8" | "u16" | "i16";
+
+export interface TelemetryFieldDef {
+  name: string;
+  type: TelemetryFieldType;
+  be: boolean;
+  offset: number;    // within the segment
+  num: number;       // scale = num / den
+  den: number;
+  decimals: number;
+  unit: string;
+  labels?: string[];
+  series?: string;
+}
+
+export interface TelemetrySegmentDef {
+  id: number;
+  key: string;
+  label: string;
+  len: number;
+  offset: number;    // within the payload
+  fields: TelemetryFieldDef[];
+}
+
+export const TELEM_SEGMENTS: TelemetrySegmentDef[] = [
+  { id: 1, key: "drs", label: "DRS", len: 1, offset: 0, fields: [
+    { name: "State", type: "u8", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", labels: ["Closed", "Open"] },
+  ]},
+  { id: 2, key: "imu_gyro", label: "Gyro", len: 6, offset: 1, fields: [
+    { name: "X", type: "i16", be: true, offset: 0, num: 7, den: 400, decimals: 2, unit: "°/s", series: "gyro_x" },
+    { name: "Y", type: "i16", be: true, offset: 2, num: 7, den: 400, decimals: 2, unit: "°/s", series: "gyro_y" },
+    { name: "Z", type: "i16", be: true, offset: 4, num: 7, den: 400, decimals: 2, unit: "°/s", series: "gyro_z" },
+  ]},
+  { id: 3, key: "imu_accel", label: "Accel", len: 6, offset: 7, fields: [
+    { name: "X", type: "i16", be: true, offset: 0, num: 61, den: 500, decimals: 2, unit: "mg", series: "accel_x" },
+    { name: "Y", type: "i16", be: true, offset: 2, num: 61, den: 500, decimals: 2, unit: "mg", series: "accel_y" },
+    { name: "Z", type: "i16", be: true, offset: 4, num: 61, den: 500, decimals: 2, unit: "mg", series: "accel_z" },
+  ]},
+  { id: 4, key: "wheel_fl", label: "FL", len: 6, offset: 13, fields: [
+    { name: "Speed", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "rpm", series: "wheel_fl_speed" },
+    { name: "Temp", type: "i16", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "°C" },
+    { name: "Load", type: "u16", be: true, offset: 4, num: 1, den: 1, decimals: 0, unit: "N" },
+  ]},
+  { id: 5, key: "wheel_fr", label: "FR", len: 6, offset: 19, fields: [
+    { name: "Speed", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "rpm", series: "wheel_fr_speed" },
+    { name: "Temp", type: "i16", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "°C" },
+    { name: "Load", type: "u16", be: true, offset: 4, num: 1, den: 1, decimals: 0, unit: "N" },
+  ]},
+  { id: 6, key: "wheel_rr", label: "RR", len: 6, offset: 25, fields: [
+    { name: "Speed", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "rpm", series: "wheel_rr_speed" },
+    { name: "Temp", type: "i16", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "°C" },
+    { name: "Load", type: "u16", be: true, offset: 4, num: 1, den: 1, decimals: 0, unit: "N" },
+  ]},
+  { id: 7, key: "wheel_rl", label: "RL", len: 6, offset: 31, fields: [
+    { name: "Speed", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "rpm", series: "wheel_rl_speed" },
+    { name: "Temp", type: "i16", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "°C" },
+    { name: "Load", type: "u16", be: true, offset: 4, num: 1, den: 1, decimals: 0, unit: "N" },
+  ]},
+  { id: 8, key: "sg_fl", label: "FL", len: 2, offset: 37, fields: [
+    { name: "Pos", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "sg_fl" },
+  ]},
+  { id: 9, key: "sg_fr", label: "FR", len: 2, offset: 39, fields: [
+    { name: "Pos", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "sg_fr" },
+  ]},
+  { id: 10, key: "sg_rr", label: "RR", len: 2, offset: 41, fields: [
+    { name: "Pos", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "sg_rr" },
+  ]},
+  { id: 11, key: "sg_rl", label: "RL", len: 2, offset: 43, fields: [
+    { name: "Pos", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "sg_rl" },
+  ]},
+  { id: 12, key: "eng_f0", label: "Engine", len: 7, offset: 45, fields: [
+    { name: "RPM", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "rpm", series: "rpm" },
+    { name: "ECT", type: "u8", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "°C", series: "ect" },
+    { name: "Oil Temp", type: "u8", be: true, offset: 3, num: 1, den: 1, decimals: 0, unit: "°C", series: "oil_temp" },
+    { name: "Oil Press", type: "u16", be: true, offset: 4, num: 1, den: 1, decimals: 0, unit: "kPa", series: "oil_press" },
+    { name: "Neutral", type: "u8", be: true, offset: 6, num: 1, den: 1, decimals: 0, unit: "", labels: ["No", "Yes"] },
+  ]},
+  { id: 13, key: "eng_f1", label: "Engine", len: 7, offset: 52, fields: [
+    { name: "Lambda", type: "u8", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "lambda" },
+    { name: "TPS", type: "u8", be: true, offset: 1, num: 1, den: 1, decimals: 0, unit: "%", series: "tps" },
+    { name: "Gear", type: "u8", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "", series: "gear" },
+    { name: "WSPD", type: "u16", be: true, offset: 3, num: 1, den: 1, decimals: 0, unit: "km/h", series: "wspd" },
+    { name: "Oil Press", type: "u16", be: true, offset: 5, num: 1, den: 1, decimals: 0, unit: "kPa" },
+  ]},
+  { id: 14, key: "eng_f2", label: "Engine", len: 4, offset: 59, fields: [
+    { name: "APS", type: "u16", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "", series: "aps" },
+    { name: "Fuel Press", type: "u16", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "kPa", series: "fuel_press" },
+  ]},
+  { id: 15, key: "shifter", label: "Shifter", len: 3, offset: 63, fields: [
+    { name: "S0", type: "u8", be: true, offset: 0, num: 1, den: 1, decimals: 0, unit: "" },
+    { name: "S1", type: "u8", be: true, offset: 1, num: 1, den: 1, decimals: 0, unit: "" },
+    { name: "S2", type: "u8", be: true, offset: 2, num: 1, den: 1, decimals: 0, unit: "" },
+  ]},
+];
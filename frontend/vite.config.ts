@@ -1,11 +1,52 @@
 import path from "path"
+import fs from "fs"
+import crypto from "crypto"
+import zlib from "zlib"
 import tailwindcss from "@tailwindcss/vite"
 import react from "@vitejs/plugin-react"
-import { defineConfig } from "vite"
+import { defineConfig, type Plugin } from "vite"
+
+// The receiver embeds dist/ with fixed file names (main/CMakeLists.txt), so
+// instead of hashed file names the asset links in index.html get a
+// ?v=<content hash> query, which the firmware answers with an immutable
+// Cache-Control. Every file also gets a .gz copy for Content-Encoding: gzip.
+// It runs as a post plugin so that vite:build-html has already emitted
+// index.html into the bundle when generateBundle rewrites it.
+function receiverAssets(): Plugin {
+  let outDir = "dist"
+  return {
+    name: "receiver-assets",
+    apply: "build",
+    enforce: "post",
+    configResolved(config) {
+      outDir = path.resolve(config.root, config.build.outDir)
+    },
+    generateBundle(_, bundle) {
+      const versions: Record<string, string> = {}
+      for (const file of Object.values(bundle)) {
+        const body = file.type === "chunk" ? file.code : file.source
+        versions[file.fileName] = crypto.createHash("sha256").update(body).digest("hex").slice(0, 10)
+      }
+      const html = bundle["index.html"]
+      if (html?.type !== "asset") this.error("index.html is not in the bundle; asset links would be left unversioned")
+      let source = html.source.toString()
+      for (const [name, v] of Object.entries(versions)) {
+        source = source.split(`"/${name}"`).join(`"/${name}?v=${v}"`)
+      }
+      html.source = source
+    },
+    writeBundle(_, bundle) {
+      for (const name of Object.keys(bundle)) {
+        const file = path.join(outDir, name)
+        fs.writeFileSync(`${file}.gz`, zlib.gzipSync(fs.readFileSync(file), { level: 9 }))
+      }
+    },
+  }
+}
 
 // https://vite.dev/config/
 export default defineConfig({
-  plugins: [react(), tailwindcss()],
+  plugins: [react(), tailwindcss(), receiverAssets()],
   resolve: {
     alias: {
       "@": path.resolve(__dirname, "./src"),
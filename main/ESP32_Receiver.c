@@ -15,11 +15,20 @@
 #include "esp_log.h"
 #include "esp_mac.h"
 #include "esp_now.h"
-#include "esp_crc.h"
 #include "esp_timer.h"
 #include "ESP32_Receiver.h"
 #include "esp_heap_caps.h"
 #include "server.h"
+#include "packet_pool.h"
+#include "telemetry.h"
+#include "history.h"
+#include "flash_log.h"
+#include "stream.h"
+#include "peers.h"
+#include "metrics.h"
+#include "laps.h"
+#include "gate_store.h"
+#include "tx.h"
 
 #define ESPNOW_QUEUE_SIZE 16
 #define ACK_TIMER_INTERVAL_MS (15 * 1000)
@@ -27,10 +36,9 @@
 #define MAX_PING_MS (11 * 1000);
 
 static QueueHandle_t s_espnow_queue;
-static mac_address_list_t mac_list;
 
-mac_address_list_t* get_mac_list(void) {
-    return &mac_list;
+unsigned espnow_queue_depth(void) {
+    return s_espnow_queue ? uxQueueMessagesWaiting(s_espnow_queue) : 0;
 }
 
 static TimerHandle_t ack_timer;
@@ -40,35 +48,6 @@ static const char *TAG = "receiver";
 
 uint16_t s_espnow_seq[ESPNOW_DATA_MAX] = { 0, 0 };
 
-// single definition of lastTelemetryPing (declared extern in the header)
-uint32_t lastTelemetryPing = 0;
-
-const segment_t segments[] = {
-    { 0x01,  1,  0, "drs"       },
-    { 0x02,  6,  1, "imu_gyro"  },
-    { 0x03,  6,  7, "imu_accel" },
-    { 0x04,  6, 13, "wheel_fl"  },
-    { 0x05,  6, 19, "wheel_fr"  },
-    { 0x06,  6, 25, "wheel_rr"  },
-    { 0x07,  6, 31, "wheel_rl"  },
-    { 0x08,  2, 37, "sg_fl"     },
-    { 0x09,  2, 39, "sg_fr"     },
-    { 0x0A,  2, 41, "sg_rr"     },
-    { 0x0B,  2, 43, "sg_rl"     },
-    { 0x0C,  7, 45, "eng_f0"    },
-    { 0x0D,  7, 52, "eng_f1"    },
-    { 0x0E,  4, 59, "eng_f2"    },
-    { 0x0F,  3, 63, "shifter"   },
-};
-const int NUM_SEGMENTS = sizeof(segments) / sizeof(segments[0]);
-
-void mac_to_string(const uint8_t *mac_addr, char *mac_string) {
-    snprintf(mac_string, 18, "%02x:%02x:%02x:%02x:%02x:%02x",
-             mac_addr[0], mac_addr[1], mac_addr[2],
-             mac_addr[3], mac_addr[4], mac_addr[5]);
-}
-
-
 static TaskHandle_t ack_task_handle = NULL;
 static TaskHandle_t ping_task_handle = NULL;
 
@@ -104,31 +83,13 @@ void ping_task(void *pvParameter) {
 }
 
 void send_pings() {
-    espnow_data_t *buf = malloc(sizeof(espnow_data_t));
-    if (buf == NULL) {
-        ESP_LOGE(TAG, "Malloc send buffer fail");
-        return;
-    }
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *p = peer_at(i);
+        if (!peer_has(p, PEER_F_LISTED)) continue;
+        const uint8_t *dest_mac = p->mac;
 
-    buf->type = ESPNOW_DATA_PING;
-    buf->seq_num = s_espnow_seq[ESPNOW_DATA_UNICAST]++;
-    buf->crc = 0;
-    buf->crc = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, sizeof(espnow_data_t));
-
-    for (size_t i = 0; i < mac_list.count; i++) {
-        const uint8_t *dest_mac = mac_list.mac_list[i].addr;
-
-        if (!esp_now_is_peer_exist(dest_mac)) {
-            esp_now_peer_info_t peer;
-            memset(&peer, 0, sizeof(esp_now_peer_info_t));
-            peer.channel = 1;
-            peer.ifidx = ESP_IF_WIFI_STA;
-            peer.encrypt = false;
-            memcpy(peer.peer_addr, dest_mac, ESP_NOW_ETH_ALEN);
-            ESP_ERROR_CHECK(esp_now_add_peer(&peer));
-        }
-
-        const esp_err_t ret = esp_now_send(dest_mac, (uint8_t *)buf, sizeof(espnow_data_t));
+        const esp_err_t ret = tx_ping(dest_mac);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Send ping error: %s", esp_err_to_name(ret));
         } else {
@@ -137,17 +98,15 @@ void send_pings() {
 
         vTaskDelay(pdMS_TO_TICKS(50));
 
-        if ((esp_timer_get_time() - mac_list.mac_list[i].lastPing) > 11 * 1000 * 1000ULL) {
-            ESP_LOGW(TAG, "No ping response from: "MACSTR"", MAC2STR(mac_list.mac_list[i].addr));
+        if ((esp_timer_get_time() - p->last_ping_us) > 11 * 1000 * 1000ULL) {
+            ESP_LOGW(TAG, "No ping response from: %s", p->mac_str);
         }
     }
 
     ESP_LOGI(TAG, "Macs:");
-    for (size_t j = 0; j < mac_list.count; j++) {
-        ESP_LOGI(TAG, MACSTR, MAC2STR(mac_list.mac_list[j].addr));
+    for (int j = 0; j < count; j++) {
+        if (peer_has(peer_at(j), PEER_F_LISTED)) ESP_LOGI(TAG, "%s", peer_at(j)->mac_str);
     }
-
-    free(buf);
 }
 
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
@@ -193,10 +152,13 @@ void espnow_send_cb(const esp_now_send_info_t *tx_info, esp_now_send_status_t st
         return;
     }
 
+    metrics_inc(status == ESP_NOW_SEND_SUCCESS ? METRIC_TX_CB_OK : METRIC_TX_CB_FAIL);
+
     evt.id = ESPNOW_SEND_CB;
     memcpy(send_cb->mac_addr, tx_info->des_addr, ESP_NOW_ETH_ALEN);
     send_cb->status = status;
     if (xQueueSend(s_espnow_queue, &evt, ESPNOW_MAXDELAY) != pdTRUE) {
+        metrics_inc(METRIC_TX_QUEUE_DROP);
         ESP_LOGW(TAG, "Send send queue fail");
     }
 }
@@ -211,102 +173,70 @@ void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *data, i
         return;
     }
 
-    if (esp_get_free_heap_size() < 10000) {
-        ESP_LOGW(TAG, "Heap low (%lu bytes), dropping packet", esp_get_free_heap_size());
+    metrics_inc(METRIC_RX_FRAMES);
+
+    if (len > sizeof(espnow_data_t)) {
+        metrics_inc(METRIC_RX_DROP_OVERSIZE);
+        ESP_LOGW(TAG, "Receive frame too long (%d bytes), dropping packet", len);
         return;
     }
 
-    evt.id = ESPNOW_RECV_CB;
-    memcpy(recv_cb->mac_addr, mac_addr, ESP_NOW_ETH_ALEN);
-    recv_cb->data = malloc(len);
-    if (recv_cb->data == NULL) {
-        ESP_LOGE(TAG, "Malloc receive data fail");
+    espnow_data_t *pkt = packet_pool_take();
+    if (pkt == NULL) {
+        metrics_inc(METRIC_RX_DROP_POOL);
+        ESP_LOGW(TAG, "Packet pool exhausted, dropping packet");
         return;
     }
-    memcpy(recv_cb->data, data, len);
+
+    evt.id = ESPNOW_RECV_CB;
+    memcpy(recv_cb->mac_addr, mac_addr, ESP_NOW_ETH_ALEN);
+    memcpy(pkt, data, len);
+    recv_cb->data = (uint8_t *)pkt;
     recv_cb->data_len = len;
+    recv_cb->rx_us = esp_timer_get_time();
+    metrics_observe(&metrics_rx_queue_depth, uxQueueMessagesWaiting(s_espnow_queue));
     if (xQueueSend(s_espnow_queue, &evt, ESPNOW_MAXDELAY) != pdTRUE) {
+        metrics_inc(METRIC_RX_DROP_QUEUE);
         ESP_LOGW(TAG, "Send receive queue fail");
-        free(recv_cb->data);
+        packet_pool_unget(pkt);
     }
 }
 
-int espnow_data_parse(uint8_t *data, uint16_t data_len, uint8_t *state, uint16_t *seq, int *magic) {
+int espnow_data_parse(uint8_t *data, uint16_t data_len, espnow_frame_status_t *status, uint16_t *seq, int *magic) {
     espnow_data_t *buf = (espnow_data_t *)data;
-    uint16_t crc, crc_cal = 0;
-
-    if (data_len < offsetof(espnow_data_t, data)) {
-        ESP_LOGE(TAG, "Receive ESPNOW data too short, len:%d", data_len);
-        return -1;
-    }
 
+    *status = espnow_frame_check(buf, data_len);
+    switch (*status) {
+        case ESPNOW_FRAME_SHORT:
+            metrics_inc(METRIC_RX_SHORT);
+            ESP_LOGE(TAG, "Receive ESPNOW data too short, len:%d", data_len);
+            return ESPNOW_PARSE_SHORT;
+        case ESPNOW_FRAME_BAD_LEN:
+            metrics_inc(METRIC_RX_BAD_LEN);
+            ESP_LOGW(TAG, "Frame len %u does not fit %u received bytes", buf->len, data_len);
+            return ESPNOW_PARSE_BAD_LEN;
+        case ESPNOW_FRAME_BAD_CRC:
+            metrics_inc(METRIC_RX_CRC_FAIL);
+            return ESPNOW_PARSE_BAD_CRC;
+        case ESPNOW_FRAME_OK_LEGACY:
+            metrics_inc(METRIC_RX_CRC_LEGACY);
+            break;
+        case ESPNOW_FRAME_OK:
+            break;
+    }
+
+    metrics_count_type(buf->type);
     *seq = buf->seq_num;
-    crc = buf->crc;
-    buf->crc = 0;
-    crc_cal = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, data_len);
-
-    // if (crc_cal == crc) {
-    //     return buf->type;
-    // }
-
     return buf->type;
 }
 
-void add_mac_to_list(const uint8_t *mac_addr) {
-    if (mac_list.count >= MAX_MAC_ADDRESSES) {
-        ESP_LOGW(TAG, "MAC address list is full");
-        return;
-    }
-
-    if (is_mac_in_list(mac_addr)) {
-        return;
-    }
-
-    memcpy(mac_list.mac_list[mac_list.count].addr, mac_addr, ESP_NOW_ETH_ALEN);
-    mac_list.count++;
-
-    ESP_LOGI(TAG, "Added MAC to list: " MACSTR " (Total: %d)", MAC2STR(mac_addr), mac_list.count);
-}
-
-bool is_mac_in_list(const uint8_t *mac_addr) {
-    for (int i = 0; i < mac_list.count; i++) {
-        if (memcmp(mac_list.mac_list[i].addr, mac_addr, ESP_NOW_ETH_ALEN) == 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
 void send_ack(const uint8_t *dest_mac) {
-    espnow_data_t *buf = malloc(sizeof(espnow_data_t));
-    if (buf == NULL) {
-        ESP_LOGE(TAG, "Malloc send buffer fail");
-        return;
-    }
-
-    buf->type = ESPNOW_DATA_ACK;
-    buf->seq_num = s_espnow_seq[ESPNOW_DATA_UNICAST]++;
-    buf->crc = 0;
-    buf->crc = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, sizeof(espnow_data_t));
-
-    if (!esp_now_is_peer_exist(dest_mac)) {
-        esp_now_peer_info_t peer;
-        memset(&peer, 0, sizeof(esp_now_peer_info_t));
-        peer.channel = 1;
-        peer.ifidx = ESP_IF_WIFI_STA;
-        peer.encrypt = false;
-        memcpy(peer.peer_addr, dest_mac, ESP_NOW_ETH_ALEN);
-        ESP_ERROR_CHECK(esp_now_add_peer(&peer));
-    }
-
-    esp_err_t ret = esp_now_send(dest_mac, (uint8_t *)buf, sizeof(espnow_data_t));
+    esp_err_t ret = tx_ack(dest_mac);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Send ACK error: %s", esp_err_to_name(ret));
     } else {
         ESP_LOGI(TAG, "Sent ACK to " MACSTR, MAC2STR(dest_mac));
     }
-
-    free(buf);
 }
 
 void espnow_data_prepare(espnow_send_param_t *send_param) {
@@ -316,13 +246,13 @@ void espnow_data_prepare(espnow_send_param_t *send_param) {
 
     buf->type = ESPNOW_DATA_REQUEST;
     buf->seq_num = s_espnow_seq[buf->type]++;
-    buf->crc = 0;
-    buf->crc = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, send_param->len);
+    buf->len = sizeof(buf->data);
+    espnow_frame_seal(buf);
 }
 
 void espnow_task(void *pvParameter) {
     espnow_event_t evt;
-    uint8_t recv_state = 0;
+    espnow_frame_status_t recv_status;
     uint16_t recv_seq = 0;
     int recv_magic = 0;
     int ret;
@@ -330,7 +260,10 @@ void espnow_task(void *pvParameter) {
 
     while (xQueueReceive(s_espnow_queue, &evt, portMAX_DELAY) == pdTRUE) {
         if (++pkt_count % 100 == 0) {
-            ESP_LOGI(TAG, "Heap free: %lu bytes", esp_get_free_heap_size());
+            packet_pool_stats_t pool;
+            packet_pool_get_stats(&pool);
+            ESP_LOGI(TAG, "Heap free: %lu bytes, pool in flight: %lu, pool drops: %lu",
+                     esp_get_free_heap_size(), pool.taken - pool.returned, pool.exhausted);
         }
         switch (evt.id) {
             case ESPNOW_SEND_CB:
@@ -347,162 +280,100 @@ void espnow_task(void *pvParameter) {
             {
                 event_recv_cb_t *recv_cb = &evt.info.recv_cb;
                 espnow_data_t *packet = (espnow_data_t*)recv_cb->data;
-
-                ret = espnow_data_parse(recv_cb->data, recv_cb->data_len, &recv_state, &recv_seq, &recv_magic);
-
-                if (ret == ESPNOW_DATA_ACK) {
+                int64_t start_us = esp_timer_get_time();
+                uint32_t start_ms = (uint32_t)(start_us / 1000);
+                peer_seq_result_t seq_result = PEER_SEQ_NEW;
+                metrics_observe(&metrics_rx_latency_us, (uint32_t)(start_us - recv_cb->rx_us));
+
+                ret = espnow_data_parse(recv_cb->data, recv_cb->data_len, &recv_status, &recv_seq, &recv_magic);
+
+                // One registry lookup per packet. Registry slots are permanent, so only a
+                // frame that passed the check and carries one of our types may claim one;
+                // corrupt or foreign traffic is counted against peers already known.
+                // NULL for an unknown sender, or when the table is full.
+                bool accepted = ret >= 0 && ret <= ESPNOW_GATE_STUCK;
+                peer_t *sender = accepted ? peer_get_or_add(recv_cb->mac_addr) : peer_find(recv_cb->mac_addr);
+                if (sender) peer_rx_count(&sender->rx, recv_status);
+
+                if (ret < 0) {
+                    if (ret == ESPNOW_PARSE_BAD_CRC) {
+                        ESP_LOGW(TAG, "CRC error from "MACSTR", dropping frame", MAC2STR(recv_cb->mac_addr));
+                    }
+                } else if (ret == ESPNOW_DATA_ACK) {
                     ESP_LOGI(TAG, "Received ACK from "MACSTR", seq: %d", MAC2STR(recv_cb->mac_addr), recv_seq);
-                    add_mac_to_list(recv_cb->mac_addr);
+                    if (sender && peer_set(sender, PEER_F_LISTED)) {
+                        ESP_LOGI(TAG, "Added MAC to list: %s", sender->mac_str);
+                    }
                 } else if (ret == ESPNOW_DATA_REQUEST) {
                     ESP_LOGI(TAG, "Received request from "MACSTR", seq: %d", MAC2STR(recv_cb->mac_addr), recv_seq);
 
                     size_t payload_len = packet->len;
                     if (payload_len > 0 && payload_len <= sizeof(packet->data)) {
-                        char* buffer = malloc(payload_len + 1);
-                        if (buffer != NULL) {
-                            int index = mac_index(recv_cb->mac_addr);
-                            mac_list.mac_list[index].last_data_seq = recv_seq;
-
-                            memcpy(buffer, packet->data, payload_len);
-                            buffer[payload_len] = '\0';
-
-                            ESP_LOGI(TAG, "Received data: %s", buffer);
-
-                            char mac_addr_string[18];
-                            mac_to_string(recv_cb->mac_addr, mac_addr_string);
-
-                            addGateTime(mac_addr_string, buffer);
-                            setGateStuck(mac_addr_string, false);
-                            free(buffer);
-
-                            espnow_data_t *ok_pkt = malloc(sizeof(espnow_data_t));
-                            if (ok_pkt != NULL) {
-                                memset(ok_pkt, 0, sizeof(espnow_data_t));
-                                ok_pkt->type    = ESPNOW_DATA_OK;
-                                ok_pkt->seq_num = recv_seq;
-                                ok_pkt->len     = 0;
-                                ok_pkt->crc     = 0;
-                                ok_pkt->crc     = esp_crc16_le(UINT16_MAX, (uint8_t const *)ok_pkt, sizeof(espnow_data_t));
-
-                                if (!esp_now_is_peer_exist(recv_cb->mac_addr)) {
-                                    esp_now_peer_info_t peer;
-                                    memset(&peer, 0, sizeof(esp_now_peer_info_t));
-                                    peer.channel = 1;
-                                    peer.ifidx   = ESP_IF_WIFI_STA;
-                                    peer.encrypt = false;
-                                    memcpy(peer.peer_addr, recv_cb->mac_addr, ESP_NOW_ETH_ALEN);
-                                    ESP_ERROR_CHECK(esp_now_add_peer(&peer));
-                                }
-
-                                esp_err_t ok_ret = esp_now_send(recv_cb->mac_addr, (uint8_t *)ok_pkt, sizeof(espnow_data_t));
-                                if (ok_ret != ESP_OK) {
-                                    ESP_LOGE(TAG, "Failed to send OK to "MACSTR": %s", MAC2STR(recv_cb->mac_addr), esp_err_to_name(ok_ret));
-                                } else {
-                                    ESP_LOGI(TAG, "Sent OK for seq %d to "MACSTR"", recv_seq, MAC2STR(recv_cb->mac_addr));
-                                }
-                                free(ok_pkt);
-                            } else {
-                                ESP_LOGE(TAG, "Failed to allocate OK packet");
+                        char buffer[sizeof(packet->data) + 1];
+                        memcpy(buffer, packet->data, payload_len);
+                        buffer[payload_len] = '\0';
+
+                        ESP_LOGI(TAG, "Received data: %s", buffer);
+
+                        // A duplicate is a retransmit after our OK was lost: answer it again,
+                        // but record the trigger only once. A stale one is from an older run.
+                        if (sender) seq_result = peer_seq_check(&sender->gate_seq, recv_seq, start_ms);
+                        if (peer_seq_drop(seq_result)) {
+                            metrics_inc(seq_result == PEER_SEQ_STALE ? METRIC_RX_STALE : METRIC_RX_DUPLICATE);
+                            ESP_LOGW(TAG, "%s request seq %d from %s, not applied",
+                                     seq_result == PEER_SEQ_STALE ? "Stale" : "Duplicate", recv_seq, sender->mac_str);
+                        } else {
+                            if (sender) {
+                                addGateTime(sender, buffer);
+                                setGateStuck(sender, false);
                             }
+                            flash_log_gate(recv_cb->mac_addr, packet->data, payload_len,
+                                           esp_timer_get_time() / (int64_t)1000);
+                        }
+
+                        esp_err_t ok_ret = tx_ok(recv_cb->mac_addr, recv_seq);
+                        if (ok_ret != ESP_OK) {
+                            ESP_LOGE(TAG, "Failed to send OK to "MACSTR": %s", MAC2STR(recv_cb->mac_addr), esp_err_to_name(ok_ret));
                         } else {
-                            ESP_LOGE(TAG, "Failed to allocate buffer for received data");
+                            ESP_LOGI(TAG, "Sent OK for seq %d to "MACSTR"", recv_seq, MAC2STR(recv_cb->mac_addr));
                         }
                     } else {
                         ESP_LOGE(TAG, "Invalid payload length: %zu", payload_len);
                     }
                 } else if (ret == ESPNOW_DATA_PING) {
                     ESP_LOGI(TAG, "Received ping from "MACSTR"", MAC2STR(recv_cb->mac_addr));
-                    int index = mac_index(recv_cb->mac_addr);
-                    if (index == -1) {
-                        ESP_LOGW(TAG, "Unable to locate mac in list");
-                        add_mac_to_list(recv_cb->mac_addr);
-                        index = mac_index(recv_cb->mac_addr);
-                    }
-                    if (index != -1) {
-                        mac_list.mac_list[index].lastPing = esp_timer_get_time();
+                    if (sender) {
+                        if (peer_set(sender, PEER_F_LISTED)) {
+                            ESP_LOGW(TAG, "Ping from unlisted peer, added %s", sender->mac_str);
+                        }
+                        sender->last_ping_us = esp_timer_get_time();
                     }
+                } else if (ret == ESPNOW_TELEMETRY && sender &&
+                           peer_seq_drop(seq_result = peer_seq_check(&sender->telemetry_seq, recv_seq, start_ms))) {
+                    metrics_inc(seq_result == PEER_SEQ_STALE ? METRIC_RX_STALE : METRIC_RX_DUPLICATE);
                 } else if (ret == ESPNOW_TELEMETRY) {
-                    uint32_t time_ms = esp_timer_get_time() / (int64_t)1000;
-                    char time_str[16];
-                    snprintf(time_str, sizeof(time_str), "%lu", time_ms - lastTelemetryPing);
-                    addString("telemetryPing", time_str);
-                    lastTelemetryPing = time_ms;
-
-                    const uint8_t *payload = packet->data;
-                    size_t payload_len = packet->len;
-
-                    for (int s = 0; s < NUM_SEGMENTS; s++) {
-                        if ((size_t)(segments[s].offset + segments[s].len) > payload_len) {
-                            ESP_LOGW(TAG, "Packet too short for segment %s (offset=%d end=%d pkt_len=%zu)",
-                                     segments[s].name, segments[s].offset,
-                                     segments[s].offset + segments[s].len, payload_len);
-                            continue;
-                        }
-
-                        const uint8_t *d = &payload[segments[s].offset];
-
-                        if (segments[s].id == 0x02) { // IMU Gyro
-                            int16_t gx = (int16_t)((d[0] << 8) | d[1]);
-                            int16_t gy = (int16_t)((d[2] << 8) | d[3]);
-                            int16_t gz = (int16_t)((d[4] << 8) | d[5]);
-                            char conv[64];
-                            snprintf(conv, sizeof(conv), "%.2f,%.2f,%.2f",
-                                     gx * 17.50f, gy * 17.50f, gz * 17.50f);
-                            addString(segments[s].name, conv);
-                        } else if (segments[s].id == 0x03) { // IMU Accel
-                            int16_t ax = (int16_t)((d[0] << 8) | d[1]);
-                            int16_t ay = (int16_t)((d[2] << 8) | d[3]);
-                            int16_t az = (int16_t)((d[4] << 8) | d[5]);
-                            char conv[64];
-                            snprintf(conv, sizeof(conv), "%.6f,%.6f,%.6f",
-                                     ((float)ax * 0.122f) / 1000.0f,
-                                     ((float)ay * 0.122f) / 1000.0f,
-                                     ((float)az * 0.122f) / 1000.0f);
-                            addString(segments[s].name, conv);
-                        } else {
-                            char hex[64] = {0};
-                            int hpos = 0;
-                            for (int b = 0; b < segments[s].len; b++) {
-                                hpos += snprintf(hex + hpos, sizeof(hex) - hpos,
-                                                 b ? " %02X" : "%02X", d[b]);
-                            }
-                            addString(segments[s].name, hex);
-                        }
+                    uint32_t rx_ms = esp_timer_get_time() / (int64_t)1000;
+                    int src = telemetry_update(sender ? peer_index(sender) : -1, recv_cb->mac_addr,
+                                               packet->data, packet->len, rx_ms);
+                    flash_log_telemetry(packet->data, packet->len, rx_ms);
+                    if (src >= 0) {
+                        telemetry_snapshot_t snap;
+                        telemetry_snapshot(src, &snap);
+                        history_append(src, &snap);
+                        if (src == TELEMETRY_SOURCE_DEFAULT) stream_notify(STREAM_EVENT_TELEMETRY);
                     }
                 } else if (ret == ESPNOW_GATE_STUCK) {
-                    char mac_addr_string[18];
-                    mac_to_string(recv_cb->mac_addr, mac_addr_string);
                     bool is_stuck = (packet->len > 0 && packet->data[0] == 1);
-                    ESP_LOGW(TAG, "Gate %s: %s", mac_addr_string, is_stuck ? "STUCK" : "cleared");
-                    setGateStuck(mac_addr_string, is_stuck);
-
-                    espnow_data_t *ok_pkt = malloc(sizeof(espnow_data_t));
-                    if (ok_pkt != NULL) {
-                        memset(ok_pkt, 0, sizeof(espnow_data_t));
-                        ok_pkt->type    = ESPNOW_DATA_OK;
-                        ok_pkt->seq_num = recv_seq;
-                        ok_pkt->len     = 0;
-                        ok_pkt->crc     = 0;
-                        ok_pkt->crc     = esp_crc16_le(UINT16_MAX, (uint8_t const *)ok_pkt, sizeof(espnow_data_t));
-
-                        if (!esp_now_is_peer_exist(recv_cb->mac_addr)) {
-                            esp_now_peer_info_t peer;
-                            memset(&peer, 0, sizeof(esp_now_peer_info_t));
-                            peer.channel = 1;
-                            peer.ifidx   = ESP_IF_WIFI_STA;
-                            peer.encrypt = false;
-                            memcpy(peer.peer_addr, recv_cb->mac_addr, ESP_NOW_ETH_ALEN);
-                            ESP_ERROR_CHECK(esp_now_add_peer(&peer));
-                        }
+                    ESP_LOGW(TAG, "Gate "MACSTR": %s", MAC2STR(recv_cb->mac_addr), is_stuck ? "STUCK" : "cleared");
+                    if (sender) setGateStuck(sender, is_stuck);
 
-                        esp_now_send(recv_cb->mac_addr, (uint8_t *)ok_pkt, sizeof(espnow_data_t));
-                        free(ok_pkt);
-                    }
+                    tx_ok(recv_cb->mac_addr, recv_seq);
                 } else {
                     ESP_LOGI(TAG, "Received invalid data from: "MACSTR"", MAC2STR(recv_cb->mac_addr));
                 }
 
-                free(recv_cb->data);
+                packet_pool_give(packet);
+                metrics_observe(&metrics_rx_process_us, (uint32_t)(esp_timer_get_time() - start_us));
                 break;
             }
             default:
@@ -512,19 +383,6 @@ void espnow_task(void *pvParameter) {
     }
 }
 
-int mac_index(const uint8_t *mac_addr) {
-    uint8_t idx = 0;
-    for (int i = 0; i < mac_list.count; i++) {
-        if (memcmp(mac_addr, mac_list.mac_list[i].addr, ESP_NOW_ETH_ALEN) == 0) {
-            return idx;
-        }
-
-        idx++;
-    }
-
-    return -1;
-}
-
 esp_err_t softap_init(void) {
     wifi_config_t wifi_ap_config = {
         .ap = {
@@ -549,6 +407,19 @@ esp_err_t softap_init(void) {
 }
 
 esp_err_t espnow_init(void) {
+    packet_pool_init();
+    peers_init();
+    laps_init();
+    gate_store_init();
+    laps_reconfigure();
+    if (telemetry_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Telemetry disabled");
+    }
+    if (history_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Telemetry history disabled");
+    }
+    flash_log_init();
+
     s_espnow_queue = xQueueCreate(ESPNOW_QUEUE_SIZE, sizeof(espnow_event_t));
     if (s_espnow_queue == NULL) {
         ESP_LOGE(TAG, "Create queue fail");
@@ -560,20 +431,7 @@ esp_err_t espnow_init(void) {
     ESP_ERROR_CHECK( esp_now_register_recv_cb(espnow_recv_cb) );
     ESP_ERROR_CHECK( esp_wifi_set_protocol(ESP_IF_WIFI_STA, WIFI_PROTOCOL_11B|WIFI_PROTOCOL_11G|WIFI_PROTOCOL_11N|WIFI_PROTOCOL_LR) );
 
-    esp_now_peer_info_t *peer = malloc(sizeof(esp_now_peer_info_t));
-    if (peer == NULL) {
-        ESP_LOGE(TAG, "Malloc peer information fail");
-        vQueueDelete(s_espnow_queue);
-        esp_now_deinit();
-        return ESP_FAIL;
-    }
-    memset(peer, 0, sizeof(esp_now_peer_info_t));
-    peer->channel = 1;
-    peer->ifidx = ESP_IF_WIFI_STA;
-    peer->encrypt = false;
-    memcpy(peer->peer_addr, s_broadcast_mac, ESP_NOW_ETH_ALEN);
-    ESP_ERROR_CHECK( esp_now_add_peer(peer) );
-    free(peer);
+    ESP_ERROR_CHECK( tx_ensure_peer(s_broadcast_mac) );
 
     ack_timer = xTimerCreate("ACK_Timer",
                             pdMS_TO_TICKS(ACK_TIMER_INTERVAL_MS),
@@ -1,7 +1,6 @@
 #ifndef ESP32_RECEIVER_ESP32_RECEIVER_H
 #define ESP32_RECEIVER_ESP32_RECEIVER_H
 
-#define MAX_MAC_ADDRESSES 50
 #define ESPNOW_MAXDELAY 512
 #define SOFTAP_SSID "SDM Telemetry"
 #define SOFTAP_PASS "244466666"
@@ -9,6 +8,7 @@
 #define MAX_STA_CONN 4
 
 #include "esp_now.h"
+#include "protocol.h"
 
 static uint8_t s_broadcast_mac[ESP_NOW_ETH_ALEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
 
@@ -17,17 +17,6 @@ typedef enum {
     ESPNOW_RECV_CB,
 } event_id_t;
 
-typedef enum {
-    ESPNOW_DATA_ACK,
-    ESPNOW_DATA_REQUEST,
-    ESPNOW_DATA_PING,
-    ESPNOW_GATE_IDENT,
-    ESPNOW_DATA_OK,
-    ESPNOW_TELEMETRY,
-    ESPNOW_SET_LOGGER_NAME,
-    ESPNOW_GATE_STUCK,
-} espnow_msg_type_t;
-
 typedef enum {
     ESPNOW_DATA_BROADCAST,
     ESPNOW_DATA_UNICAST,
@@ -43,6 +32,7 @@ typedef struct {
     uint8_t mac_addr[ESP_NOW_ETH_ALEN];
     uint8_t *data;
     int data_len;
+    int64_t rx_us;      // esp_timer_get_time() in the receive callback
 } event_recv_cb_t;
 
 typedef union {
@@ -55,25 +45,6 @@ typedef struct {
     event_info_t info;
 } espnow_event_t;
 
-typedef struct __attribute__((packed)) {
-    uint8_t  type;
-    uint16_t seq_num;
-    uint16_t crc;
-    uint8_t  len;
-    uint8_t  data[200];
-} espnow_data_t;
-
-typedef struct {
-    uint8_t addr[ESP_NOW_ETH_ALEN];
-    uint16_t last_data_seq;
-    int64_t lastPing;
-} mac_address_t;
-
-typedef struct {
-    mac_address_t mac_list[MAX_MAC_ADDRESSES];
-    int count;
-} mac_address_list_t;
-
 typedef struct {
     bool unicast;                         //Send unicast ESPNOW data.
     bool broadcast;                       //Send broadcast ESPNOW data.
@@ -86,25 +57,21 @@ typedef struct {
 /* Sequence counters — defined in ESP32_Receiver.c, declared here for server.c */
 extern uint16_t s_espnow_seq[ESPNOW_DATA_MAX];
 
-extern uint32_t lastTelemetryPing;
-
-typedef struct { uint8_t id; uint8_t len; uint8_t offset; const char* name; } segment_t;
-extern const segment_t segments[];
-extern const int NUM_SEGMENTS;
-
 void espnow_deinit(espnow_send_param_t *send_param);
 esp_err_t espnow_init(void);
 void espnow_send_cb(const esp_now_send_info_t *tx_info, esp_now_send_status_t status);
 void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *data, int len);
-mac_address_list_t* get_mac_list(void);
 void espnow_task(void *pvParameter);
-int espnow_data_parse(uint8_t *data, uint16_t data_len, uint8_t *state, uint16_t *seq, int *magic);
+// espnow_data_parse() results below 0; otherwise the frame's espnow_msg_type_t.
+#define ESPNOW_PARSE_SHORT   -1
+#define ESPNOW_PARSE_BAD_CRC -2
+#define ESPNOW_PARSE_BAD_LEN -3
+
+int espnow_data_parse(uint8_t *data, uint16_t data_len, espnow_frame_status_t *status, uint16_t *seq, int *magic);
 void espnow_data_prepare(espnow_send_param_t *send_param);
-void add_mac_to_list(const uint8_t *mac_addr);
-bool is_mac_in_list(const uint8_t *mac_addr);
 void send_ack(const uint8_t *dest_mac);
 esp_err_t softap_init(void);
-int mac_index(const uint8_t *mac_addr);
 void send_pings();
+unsigned espnow_queue_depth(void);
 
 #endif //ESP32_RECEIVER_ESP32_RECEIVER_H
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "flash_log.h"
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_crc.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/message_buffer.h"
+#include "freertos/task.h"
+#include "server.h"
+
+static const char *TAG = "flash_log";
+
+#define BLOCK_HDR_LEN sizeof(flash_log_block_t)
+#define BLOCK_DATA_MAX (FLASH_LOG_BLOCK_SIZE - BLOCK_HDR_LEN)
+#define RECORD_MAX (sizeof(flash_log_record_t) + UINT8_MAX)
+
+_Static_assert(sizeof(flash_log_block_t) == 16, "block header layout changed");
+
+static const esp_partition_t *part;
+static uint32_t sector_count;
+static MessageBufferHandle_t log_queue;
+
+// Writer task state
+static uint8_t block[FLASH_LOG_BLOCK_SIZE];
+static size_t block_used;
+static uint16_t block_count;
+static atomic_uint head_sector;
+static atomic_uint next_seq;
+
+static atomic_uint stat_blocks;
+static atomic_uint stat_records;
+static atomic_uint stat_dropped;
+static atomic_uint stat_errors;
+
+static uint32_t block_crc(const flash_log_block_t *hdr, const uint8_t *data) {
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)&hdr->seq,
+                                sizeof(hdr->seq) + sizeof(hdr->used) + sizeof(hdr->count));
+    return esp_crc32_le(crc, data, hdr->used);
+}
+
+static bool header_valid(const flash_log_block_t *hdr) {
+    return hdr->magic == FLASH_LOG_MAGIC && hdr->used <= BLOCK_DATA_MAX;
+}
+
+// Resume after the newest block left by the previous boot. Only headers are
+// read here; record CRCs are checked when the log is downloaded.
+static void find_head(void) {
+    uint32_t newest_seq = 0;
+    uint32_t newest_sector = 0;
+    bool found = false;
+
+    for (uint32_t s = 0; s < sector_count; s++) {
+        flash_log_block_t hdr;
+        if (esp_partition_read(part, s * FLASH_LOG_BLOCK_SIZE, &hdr, sizeof(hdr)) != ESP_OK) continue;
+        if (!header_valid(&hdr)) continue;
+        if (!found || (int32_t)(hdr.seq - newest_seq) > 0) {
+            newest_seq = hdr.seq;
+            newest_sector = s;
+            found = true;
+        }
+    }
+
+    if (found) {
+        atomic_store(&head_sector, (newest_sector + 1) % sector_count);
+        atomic_store(&next_seq, newest_seq + 1);
+    } else {
+        atomic_store(&head_sector, 0);
+        atomic_store(&next_seq, 1);
+    }
+}
+
+static void write_block(void) {
+    if (block_count == 0) return;
+
+    flash_log_block_t *hdr = (flash_log_block_t *)block;
+    hdr->magic = FLASH_LOG_MAGIC;
+    hdr->seq   = atomic_load(&next_seq);
+    hdr->used  = block_used;
+    hdr->count = block_count;
+    hdr->crc   = block_crc(hdr, block + BLOCK_HDR_LEN);
+
+    uint32_t sector = atomic_load(&head_sector);
+    size_t offset = sector * FLASH_LOG_BLOCK_SIZE;
+
+    // Records first, then the rest of the header, then the magic: until the
+    // magic word is programmed the block does not count, so a reset at any
+    // point leaves either the whole block or none of it.
+    const size_t magic_len = sizeof(hdr->magic);
+    esp_err_t err = esp_partition_erase_range(part, offset, FLASH_LOG_BLOCK_SIZE);
+    if (err == ESP_OK) err = esp_partition_write(part, offset + BLOCK_HDR_LEN, block + BLOCK_HDR_LEN, block_used);
+    if (err == ESP_OK) err = esp_partition_write(part, offset + magic_len, block + magic_len, BLOCK_HDR_LEN - magic_len);
+    if (err == ESP_OK) err = esp_partition_write(part, offset, &hdr->magic, magic_len);
+
+    if (err == ESP_OK) {
+        atomic_fetch_add(&stat_blocks, 1);
+        atomic_fetch_add(&stat_records, block_count);
+    } else {
+        atomic_fetch_add(&stat_errors, 1);
+        ESP_LOGE(TAG, "Write to sector %lu failed: %s", (unsigned long)sector, esp_err_to_name(err));
+    }
+
+    // Move on even after an error so one bad sector cannot stall the log.
+    atomic_store(&next_seq, hdr->seq + 1);
+    atomic_store(&head_sector, (sector + 1) % sector_count);
+    block_used = 0;
+    block_count = 0;
+}
+
+static void flash_log_task(void *arg) {
+    uint8_t rec[RECORD_MAX];
+
+    for (;;) {
+        TickType_t wait = block_count ? pdMS_TO_TICKS(FLASH_LOG_FLUSH_MS) : portMAX_DELAY;
+        size_t n = xMessageBufferReceive(log_queue, rec, sizeof(rec), wait);
+        if (n == 0) {
+            write_block();
+            continue;
+        }
+
+        if (block_used + n > BLOCK_DATA_MAX) write_block();
+        memcpy(block + BLOCK_HDR_LEN + block_used, rec, n);
+        block_used += n;
+        block_count++;
+    }
+}
+
+esp_err_t flash_log_init(void) {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                    FLASH_LOG_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No \"%s\" partition, flash logging disabled", FLASH_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sector_count = part->size / FLASH_LOG_BLOCK_SIZE;
+    if (sector_count < 2) {
+        part = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    log_queue = xMessageBufferCreate(FLASH_LOG_QUEUE_BYTES);
+    if (log_queue == NULL) {
+        part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    find_head();
+    ESP_LOGI(TAG, "Logging to \"%s\": %lu sectors, resuming at sector %lu seq %lu",
+             part->label, (unsigned long)sector_count,
+             (unsigned long)atomic_load(&head_sector), (unsigned long)atomic_load(&next_seq));
+
+    // Below every other task: flash erases stall this task, never the receive path.
+    xTaskCreate(flash_log_task, "flash_log", 3072, NULL, 1, NULL);
+    return ESP_OK;
+}
+
+static void enqueue(uint8_t type, uint32_t t_ms, const uint8_t *a, size_t a_len,
+                    const uint8_t *b, size_t b_len) {
+    if (log_queue == NULL) return;
+    if (a_len + b_len > UINT8_MAX) b_len = UINT8_MAX - a_len;
+
+    uint8_t rec[RECORD_MAX];
+    flash_log_record_t *hdr = (flash_log_record_t *)rec;
+    hdr->type = type;
+    hdr->len  = a_len + b_len;
+    hdr->t_ms = t_ms;
+    memcpy(rec + sizeof(*hdr), a, a_len);
+    if (b_len) memcpy(rec + sizeof(*hdr) + a_len, b, b_len);
+
+    size_t n = sizeof(*hdr) + hdr->len;
+    if (xMessageBufferSend(log_queue, rec, n, 0) != n) {
+        atomic_fetch_add_explicit(&stat_dropped, 1, memory_order_relaxed);
+    }
+}
+
+void flash_log_telemetry(const uint8_t *payload, size_t len, uint32_t t_ms) {
+    enqueue(FLASH_LOG_REC_TELEMETRY, t_ms, payload, len > UINT8_MAX ? UINT8_MAX : len, NULL, 0);
+}
+
+void flash_log_gate(const uint8_t *mac, const uint8_t *data, size_t len, uint32_t t_ms) {
+    enqueue(FLASH_LOG_REC_GATE, t_ms, mac, 6, data, len);
+}
+
+void flash_log_get_stats(flash_log_stats_t *out) {
+    out->blocks_written  = atomic_load_explicit(&stat_blocks, memory_order_relaxed);
+    out->records_written = atomic_load_explicit(&stat_records, memory_order_relaxed);
+    out->records_dropped = atomic_load_explicit(&stat_dropped, memory_order_relaxed);
+    out->write_errors    = atomic_load_explicit(&stat_errors, memory_order_relaxed);
+    out->next_seq        = atomic_load_explicit(&next_seq, memory_order_relaxed);
+    out->head_sector     = atomic_load_explicit(&head_sector, memory_order_relaxed);
+    out->sector_count    = sector_count;
+}
+
+static esp_err_t flash_log_download_handler(httpd_req_t *req) {
+    set_cors(req);
+
+    if (part == NULL) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Flash log not available");
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"telemetry.tlog\"");
+
+    // httpd runs handlers on a single task, so one scratch block is enough
+    static uint8_t buf[FLASH_LOG_BLOCK_SIZE];
+    flash_log_block_t *hdr = (flash_log_block_t *)buf;
+
+    // The sector about to be written holds the oldest data once the log has
+    // wrapped, so walking forward from it yields blocks in write order.
+    uint32_t start = atomic_load(&head_sector);
+    for (uint32_t i = 0; i < sector_count; i++) {
+        size_t offset = ((start + i) % sector_count) * FLASH_LOG_BLOCK_SIZE;
+        if (esp_partition_read(part, offset, hdr, BLOCK_HDR_LEN) != ESP_OK) continue;
+        if (!header_valid(hdr)) continue;
+        if (esp_partition_read(part, offset + BLOCK_HDR_LEN, buf + BLOCK_HDR_LEN, hdr->used) != ESP_OK) continue;
+
+        // Also catches a sector the writer erased while we were reading it.
+        if (block_crc(hdr, buf + BLOCK_HDR_LEN) != hdr->crc) continue;
+
+        if (httpd_resp_send_chunk(req, (const char *)buf, BLOCK_HDR_LEN + hdr->used) != ESP_OK) {
+            ESP_LOGW(TAG, "Download aborted by client");
+            return ESP_FAIL;
+        }
+    }
+
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+const httpd_uri_t flash_log_download_uri = {
+    .uri      = "/log/download",
+    .method   = HTTP_GET,
+    .handler  = flash_log_download_handler,
+    .user_ctx = NULL
+};
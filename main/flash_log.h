@@ -0,0 +1,69 @@
+#ifndef ESP32_RECEIVER_FLASH_LOG_H
+#define ESP32_RECEIVER_FLASH_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Append-only log of telemetry frames and gate triggers in the "tlog" data
+// partition. The partition is used as a circular run of 4 KB blocks, one per
+// flash sector, so every sector is erased once per lap (natural wear
+// leveling). Each block is:
+//
+//   flash_log_block_t header (16 bytes) | records ... | 0xFF padding
+//
+// and each record is a flash_log_record_t header followed by len bytes.
+// The header is written last and its magic word after the rest of it, so a
+// block interrupted by a reset never carries the magic and is ignored on the
+// next boot.
+
+#define FLASH_LOG_PARTITION_LABEL "tlog"
+#define FLASH_LOG_BLOCK_SIZE 4096
+#define FLASH_LOG_MAGIC 0x474C4454u       // "TDLG"
+#define FLASH_LOG_QUEUE_BYTES 8192        // producer -> writer message buffer
+#define FLASH_LOG_FLUSH_MS 2000           // write a partial block after this long idle
+
+typedef enum {
+    FLASH_LOG_REC_TELEMETRY = 0x01,       // raw telemetry payload
+    FLASH_LOG_REC_GATE      = 0x02,       // sender mac[6] + "timestamp_us,diff_us"
+} flash_log_rec_type_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;       // increments per block written
+    uint16_t used;      // record bytes following the header
+    uint16_t count;     // records in the block
+    uint32_t crc;       // esp_crc32_le over seq..count and the record bytes
+} flash_log_block_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t len;
+    uint32_t t_ms;      // receiver uptime
+} flash_log_record_t;
+
+typedef struct {
+    uint32_t blocks_written;
+    uint32_t records_written;
+    uint32_t records_dropped;   // message buffer full
+    uint32_t write_errors;
+    uint32_t next_seq;
+    uint32_t head_sector;       // next sector to be written
+    uint32_t sector_count;
+} flash_log_stats_t;
+
+esp_err_t flash_log_init(void);
+
+// Producer side — espnow_task only. Never blocks; drops the record if the
+// writer has fallen behind.
+void flash_log_telemetry(const uint8_t *payload, size_t len, uint32_t t_ms);
+void flash_log_gate(const uint8_t *mac, const uint8_t *data, size_t len, uint32_t t_ms);
+
+void flash_log_get_stats(flash_log_stats_t *out);
+
+// GET /log/download streams every valid block, oldest first.
+extern const httpd_uri_t flash_log_download_uri;
+
+#endif //ESP32_RECEIVER_FLASH_LOG_H
@@ -0,0 +1,52 @@
+#ifndef ESP32_RECEIVER_FMT_H
+#define ESP32_RECEIVER_FMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-to-decimal without printf. newlib's vfprintf costs several
+// microseconds per call on the ESP32 even for integers; these are a digit
+// loop. Output is not NUL-terminated; the return value is its length.
+
+#define FMT_U64_MAX 20     // digits in UINT64_MAX
+#define FMT_I64_MAX 21     // plus sign
+#define FMT_FIXED_MAX 22   // plus sign and decimal point
+
+static inline size_t fmt_u64(char *out, uint64_t v) {
+    char tmp[FMT_U64_MAX];
+    size_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+static inline size_t fmt_i64(char *out, int64_t v) {
+    if (v >= 0) return fmt_u64(out, (uint64_t)v);
+    out[0] = '-';
+    return 1 + fmt_u64(out + 1, -(uint64_t)v);
+}
+
+// v in units of 10^-decimals, e.g. (-1234, 2) -> "-12.34", (5, 3) -> "0.005".
+static inline size_t fmt_fixed(char *out, int64_t v, unsigned decimals) {
+    if (decimals == 0) return fmt_i64(out, v);
+
+    size_t n = 0;
+    uint64_t a = v < 0 ? -(uint64_t)v : (uint64_t)v;
+    if (v < 0) out[n++] = '-';
+
+    char digits[FMT_U64_MAX];
+    size_t len = fmt_u64(digits, a);
+    // Left-pad to at least decimals + 1 digits so there is a leading 0.
+    size_t width = len > decimals ? len : decimals + 1;
+    size_t point = width - decimals;
+    for (size_t i = 0; i < width; i++) {
+        if (i == point) out[n++] = '.';
+        out[n++] = i < width - len ? '0' : digits[i - (width - len)];
+    }
+    return n;
+}
+
+#endif //ESP32_RECEIVER_FMT_H
@@ -0,0 +1,153 @@
+#include "gate_store.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include "peers.h"
+
+static const char *TAG = "gate_store";
+
+#define GATE_STORE_NAMESPACE "peers"
+#define GATE_STORE_KEY "gate_cfg"
+#define GATE_STORE_ENTRY_MAX (ESP_NOW_ETH_ALEN + 1 + 2 + 1 + sizeof(((gate_config_t *)0)->group) - 1)
+#define GATE_STORE_BLOB_MAX (2 + PEER_MAX * GATE_STORE_ENTRY_MAX)
+
+typedef struct {
+    uint8_t data[GATE_STORE_BLOB_MAX];
+    size_t len;
+} gate_blob_t;
+
+static gate_blob_t pending;       // latest snapshot, written when the timer fires
+static gate_blob_t saved;         // what NVS holds
+static SemaphoreHandle_t store_lock;
+static esp_timer_handle_t save_timer;
+
+static void serialize(gate_blob_t *b) {
+    uint8_t *p = b->data;
+    uint8_t *count = &p[1];
+    p[0] = GATE_STORE_FORMAT;
+    *count = 0;
+    p += 2;
+
+    int n = peer_count();
+    for (int i = 0; i < n; i++) {
+        peer_t *peer = peer_at(i);
+        if (!peer_has(peer, PEER_F_CONFIG)) continue;
+        const gate_config_t *cfg = &peer->config;
+        int16_t order = cfg->order > INT16_MAX ? INT16_MAX : (int16_t)cfg->order;
+        size_t group_len = strnlen(cfg->group, sizeof(cfg->group) - 1);
+
+        memcpy(p, peer->mac, ESP_NOW_ETH_ALEN);
+        p += ESP_NOW_ETH_ALEN;
+        *p++ = (uint8_t)cfg->mode;
+        *p++ = (uint8_t)(order & 0xFF);
+        *p++ = (uint8_t)((uint16_t)order >> 8);
+        *p++ = (uint8_t)group_len;
+        memcpy(p, cfg->group, group_len);
+        p += group_len;
+        (*count)++;
+    }
+    b->len = p - b->data;
+}
+
+static esp_err_t apply(const uint8_t *p, size_t len) {
+    if (len < 2 || p[0] != GATE_STORE_FORMAT) return ESP_ERR_INVALID_VERSION;
+    int count = p[1];
+    const uint8_t *end = p + len;
+    p += 2;
+
+    for (int i = 0; i < count; i++) {
+        if (end - p < ESP_NOW_ETH_ALEN + 4) return ESP_ERR_INVALID_SIZE;
+        const uint8_t *mac = p;
+        uint8_t mode = p[6];
+        int16_t order = (int16_t)(p[7] | (p[8] << 8));
+        size_t group_len = p[9];
+        p += ESP_NOW_ETH_ALEN + 4;
+        if (end - p < (ptrdiff_t)group_len || group_len >= sizeof(((gate_config_t *)0)->group)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        peer_t *peer = peer_get_or_add(mac);
+        if (peer == NULL) return ESP_ERR_NO_MEM;
+        gate_config_t *cfg = &peer->config;
+        cfg->mode = mode == GATE_MODE_SERIES ? GATE_MODE_SERIES : GATE_MODE_DELTA;
+        cfg->order = order;
+        memcpy(cfg->group, p, group_len);
+        cfg->group[group_len] = '\0';
+        peer_set(peer, PEER_F_CONFIG);
+        p += group_len;
+    }
+    return ESP_OK;
+}
+
+static void save_timer_cb(void *arg) {
+    // esp_timer task; the only place that writes NVS
+    static gate_blob_t blob;
+    xSemaphoreTake(store_lock, portMAX_DELAY);
+    blob = pending;
+    xSemaphoreGive(store_lock);
+
+    if (blob.len == saved.len && memcmp(blob.data, saved.data, blob.len) == 0) return;
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(GATE_STORE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, GATE_STORE_KEY, blob.data, blob.len);
+        if (err == ESP_OK) err = nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save gate configs: %s", esp_err_to_name(err));
+        return;
+    }
+    saved = blob;
+    ESP_LOGI(TAG, "Saved %u gate config(s), %u bytes", blob.data[1], (unsigned)blob.len);
+}
+
+void gate_store_schedule_save(void) {
+    if (save_timer == NULL) return;
+
+    xSemaphoreTake(store_lock, portMAX_DELAY);
+    serialize(&pending);
+    xSemaphoreGive(store_lock);
+
+    esp_timer_stop(save_timer);   // restart the debounce window
+    esp_timer_start_once(save_timer, (uint64_t)GATE_STORE_DEBOUNCE_MS * 1000);
+}
+
+esp_err_t gate_store_init(void) {
+    store_lock = xSemaphoreCreateMutex();
+    const esp_timer_create_args_t args = {
+        .callback = save_timer_cb,
+        .name = "gate_store",
+    };
+    esp_err_t err = esp_timer_create(&args, &save_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create save timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_handle_t nvs;
+    err = nvs_open(GATE_STORE_NAMESPACE, NVS_READONLY, &nvs);
+    if (err == ESP_OK) {
+        saved.len = sizeof(saved.data);
+        err = nvs_get_blob(nvs, GATE_STORE_KEY, saved.data, &saved.len);
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        saved.len = 0;
+        if (err != ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(TAG, "No stored gate configs: %s", esp_err_to_name(err));
+        return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+    }
+
+    err = apply(saved.data, saved.len);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Stored gate configs unreadable: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Loaded %u gate config(s)", saved.data[1]);
+    return ESP_OK;
+}
@@ -0,0 +1,31 @@
+#ifndef ESP32_RECEIVER_GATE_STORE_H
+#define ESP32_RECEIVER_GATE_STORE_H
+
+#include <esp_err.h>
+
+// Gate configs (mode, group and order per MAC) persisted in NVS as one blob,
+// namespace "peers", key "gate_cfg":
+//   u8 format       GATE_STORE_FORMAT
+//   u8 count
+//   count entries of
+//     u8  mac[6]
+//     u8  mode      gate_mode_t
+//     i16 order     (LE)
+//     u8  group_len
+//     u8  group[group_len]   not NUL-terminated
+//
+// Saves are coalesced: gate_store_schedule_save() snapshots the configs and
+// (re)arms a GATE_STORE_DEBOUNCE_MS timer, so a burst of UI edits costs one
+// flash write, and a snapshot equal to what is stored costs none.
+
+#define GATE_STORE_FORMAT 1
+#define GATE_STORE_DEBOUNCE_MS 2000
+
+// Loads the stored configs into the peer table. Call after peers_init() and
+// before the server starts.
+esp_err_t gate_store_init(void);
+
+// After a config change, from the task that writes configs.
+void gate_store_schedule_save(void);
+
+#endif //ESP32_RECEIVER_GATE_STORE_H
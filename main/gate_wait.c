@@ -0,0 +1,227 @@
+#include "gate_wait.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "json_writer.h"
+#include "seqlock.h"
+#include "server.h"
+#include "state_version.h"
+
+static const char *TAG = "gate_wait";
+
+#define GATE_WAIT_BIT_EVENT  (1u << 0)   // a gate event was pushed
+#define GATE_WAIT_BIT_WAITER (1u << 1)   // a request started waiting
+
+#define GATE_WAIT_BUF_SIZE 2048          // GATE_WAIT_RING events at ~110 bytes each
+
+typedef struct {
+    uint32_t version;
+    int64_t timestamp_us;
+    int64_t diff_us;
+    bool stuck;
+    char mac_str[18];
+} gate_event_t;
+
+typedef struct {
+    httpd_req_t *req;         // async copy of the /timing/wait request, NULL when free
+    uint32_t since;
+    int64_t deadline_us;
+} gate_waiter_t;
+
+// Written by espnow_task only; the httpd task and the wait task read it.
+static struct {
+    seqlock_t lock;
+    uint32_t head;            // events pushed so far
+    gate_event_t events[GATE_WAIT_RING];
+} ring;
+
+static gate_waiter_t waiters[GATE_WAIT_MAX_CLIENTS];
+static SemaphoreHandle_t waiters_lock;
+static EventGroupHandle_t wait_events;
+
+void gate_wait_push(const peer_t *peer, int64_t timestamp_us, int64_t diff_us,
+                    bool stuck, uint32_t version) {
+    seqlock_write_begin(&ring.lock);
+    gate_event_t *e = &ring.events[ring.head % GATE_WAIT_RING];
+    e->version = version;
+    e->timestamp_us = timestamp_us;
+    e->diff_us = diff_us;
+    e->stuck = stuck;
+    memcpy(e->mac_str, peer->mac_str, sizeof(e->mac_str));
+    ring.head++;
+    seqlock_write_end(&ring.lock);
+
+    if (wait_events != NULL) xEventGroupSetBits(wait_events, GATE_WAIT_BIT_EVENT);
+}
+
+// Copies the events newer than `since` into out, oldest first.
+static int collect_events(uint32_t since, gate_event_t out[GATE_WAIT_RING]) {
+    unsigned seq;
+    int n;
+    do {
+        seq = seqlock_read_begin(&ring.lock);
+        uint32_t head = ring.head;
+        n = head < GATE_WAIT_RING ? (int)head : GATE_WAIT_RING;
+        for (int i = 0; i < n; i++) {
+            out[i] = ring.events[(head - n + i) % GATE_WAIT_RING];
+        }
+    } while (seqlock_read_retry(&ring.lock, seq));
+
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        if (out[i].version > since) out[kept++] = out[i];
+    }
+    return kept;
+}
+
+static esp_err_t send_events(httpd_req_t *req, const gate_event_t *events, int n, char *buf, size_t len) {
+    json_writer_t w;
+    json_init_buffer(&w, buf, len, 1);
+    json_begin_array(&w);
+    for (int i = 0; i < n; i++) {
+        const gate_event_t *e = &events[i];
+        json_begin_object(&w);
+        json_key(&w, "mac");          json_string(&w, e->mac_str);
+        json_key(&w, "timestamp_us"); json_int(&w, e->timestamp_us);
+        json_key(&w, "diff_us");      json_int(&w, e->diff_us);
+        json_key(&w, "stuck");        json_bool(&w, e->stuck);
+        json_key(&w, "version");      json_uint(&w, e->version);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    size_t body = json_finish_buffer(&w);
+
+    char version[12];
+    snprintf(version, sizeof(version), "%lu", (unsigned long)events[n - 1].version);
+    set_cors(req);
+    httpd_resp_set_hdr(req, "X-State-Version", version);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, body);
+}
+
+static esp_err_t send_timeout(httpd_req_t *req, uint32_t since) {
+    char version[12];
+    snprintf(version, sizeof(version), "%lu", (unsigned long)since);
+    set_cors(req);
+    httpd_resp_set_hdr(req, "X-State-Version", version);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_status(req, HTTPD_204);
+    return httpd_resp_send(req, NULL, 0);
+}
+
+// Answers every waiter that has events or has timed out, and returns how long
+// the task may sleep before the next deadline.
+static TickType_t gate_wait_flush(void) {
+    static char buf[GATE_WAIT_BUF_SIZE];
+    gate_event_t events[GATE_WAIT_RING];
+    int64_t now = esp_timer_get_time();
+    int64_t next_due_us = INT64_MAX;
+
+    xSemaphoreTake(waiters_lock, portMAX_DELAY);
+    for (int i = 0; i < GATE_WAIT_MAX_CLIENTS; i++) {
+        gate_waiter_t *wt = &waiters[i];
+        if (wt->req == NULL) continue;
+
+        int n = collect_events(wt->since, events);
+        if (n > 0) {
+            send_events(wt->req, events, n, buf, sizeof(buf));
+        } else if (now >= wt->deadline_us) {
+            send_timeout(wt->req, wt->since);
+        } else {
+            if (wt->deadline_us < next_due_us) next_due_us = wt->deadline_us;
+            continue;
+        }
+        httpd_req_async_handler_complete(wt->req);
+        wt->req = NULL;
+    }
+    xSemaphoreGive(waiters_lock);
+
+    if (next_due_us == INT64_MAX) return portMAX_DELAY;
+    int64_t wait_ms = (next_due_us - now) / 1000;
+    return pdMS_TO_TICKS(wait_ms > 0 ? wait_ms : 1);
+}
+
+static void gate_wait_task(void *pvParameter) {
+    TickType_t wait = portMAX_DELAY;
+    for (;;) {
+        xEventGroupWaitBits(wait_events, GATE_WAIT_BIT_EVENT | GATE_WAIT_BIT_WAITER,
+                            pdTRUE, pdFALSE, wait);
+        wait = gate_wait_flush();
+    }
+}
+
+static uint32_t query_u32(const char *query, const char *key, uint32_t fallback) {
+    char param[12];
+    if (httpd_query_key_value(query, key, param, sizeof(param)) != ESP_OK) return fallback;
+    return (uint32_t)strtoul(param, NULL, 10);
+}
+
+static esp_err_t gate_wait_handler(httpd_req_t *req) {
+    // httpd runs handlers on a single task, so the handler can own these.
+    static char buf[GATE_WAIT_BUF_SIZE];
+    static gate_event_t events[GATE_WAIT_RING];
+
+    char query[48] = "";
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    uint32_t since = query_u32(query, "since", 0);
+    uint32_t timeout_ms = query_u32(query, "timeout_ms", GATE_WAIT_DEFAULT_TIMEOUT_MS);
+    if (timeout_ms < GATE_WAIT_MIN_TIMEOUT_MS) timeout_ms = GATE_WAIT_MIN_TIMEOUT_MS;
+    if (timeout_ms > GATE_WAIT_MAX_TIMEOUT_MS) timeout_ms = GATE_WAIT_MAX_TIMEOUT_MS;
+    if (since > state_version_current()) since = 0;   // cursor from before a reboot
+
+    int n = collect_events(since, events);
+    if (n > 0) return send_events(req, events, n, buf, sizeof(buf));
+
+    // Only the handler fills slots, so one found free stays free until it is claimed.
+    gate_waiter_t *slot = NULL;
+    xSemaphoreTake(waiters_lock, portMAX_DELAY);
+    for (int i = 0; i < GATE_WAIT_MAX_CLIENTS && slot == NULL; i++) {
+        if (waiters[i].req == NULL) slot = &waiters[i];
+    }
+    xSemaphoreGive(waiters_lock);
+
+    if (slot == NULL) {
+        set_cors(req);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_send(req, "Too many waiting clients", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    httpd_req_t *async_req = NULL;
+    if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to detach wait request");
+        return ESP_FAIL;
+    }
+
+    xSemaphoreTake(waiters_lock, portMAX_DELAY);
+    slot->since = since;
+    slot->deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    slot->req = async_req;
+    xSemaphoreGive(waiters_lock);
+
+    // An event pushed since collect_events() above is picked up by this rescan.
+    xEventGroupSetBits(wait_events, GATE_WAIT_BIT_WAITER);
+    return ESP_OK;
+}
+
+const httpd_uri_t gate_wait_uri = {
+    .uri       = "/timing/wait",
+    .method    = HTTP_GET,
+    .handler   = gate_wait_handler,
+    .user_ctx  = NULL
+};
+
+void gate_wait_init(void) {
+    waiters_lock = xSemaphoreCreateMutex();
+    wait_events = xEventGroupCreate();
+    xTaskCreate(gate_wait_task, "gate_wait", 4096, NULL, 3, NULL);
+}
@@ -0,0 +1,35 @@
+#ifndef ESP32_RECEIVER_GATE_WAIT_H
+#define ESP32_RECEIVER_GATE_WAIT_H
+
+#include <esp_http_server.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "peers.h"
+
+// Long-poll for gate events: GET /timing/wait?since=<version>[&timeout_ms=]
+// answers as soon as a gate trigger or stuck change newer than `since` exists,
+// with a JSON array of those events, or 204 once timeout_ms passes without
+// one. X-State-Version carries the cursor for the next call.
+//
+// A waiting request is detached from httpd (async handler), so it holds a
+// socket but not the server task. At most GATE_WAIT_MAX_CLIENTS requests wait
+// at once; further ones get 503. Together with STREAM_MAX_CLIENTS this stays
+// below SERVER_MAX_OPEN_SOCKETS (7), leaving room for plain requests; see
+// server.h for the budget.
+
+#define GATE_WAIT_MAX_CLIENTS 2
+#define GATE_WAIT_RING 16              // recent events kept for late waiters
+#define GATE_WAIT_DEFAULT_TIMEOUT_MS 25000
+#define GATE_WAIT_MIN_TIMEOUT_MS 1000
+#define GATE_WAIT_MAX_TIMEOUT_MS 30000
+
+void gate_wait_init(void);
+
+// Records a gate event stamped with state version `version` and wakes the
+// waiters. espnow_task only, after the version is published.
+void gate_wait_push(const peer_t *peer, int64_t timestamp_us, int64_t diff_us,
+                    bool stuck, uint32_t version);
+
+extern const httpd_uri_t gate_wait_uri;
+
+#endif //ESP32_RECEIVER_GATE_WAIT_H
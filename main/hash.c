@@ -2,61 +2,196 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define TABLE_SIZE 100
+struct HashArenaBlock {
+    struct HashArenaBlock *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
 
-int key_hash(const char *key) {
-    unsigned int hash = 0;
-    while (*key) hash = (hash * 31) + (*key++);
-    return (int)(hash % TABLE_SIZE);
+// FNV-1a
+uint32_t key_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static char *arena_alloc(struct HashTable *table, size_t n) {
+    struct HashArenaBlock *block = table->arena;
+    if (block == NULL || block->size - block->used < n) {
+        size_t size = n > HASH_ARENA_BLOCK ? n : HASH_ARENA_BLOCK;
+        block = malloc(sizeof(*block) + size);
+        if (block == NULL) return NULL;
+        block->next = table->arena;
+        block->used = 0;
+        block->size = size;
+        table->arena = block;
+    }
+    char *p = block->data + block->used;
+    block->used += n;
+    return p;
+}
+
+// Size class of an n-byte block, or -1 when n is beyond the largest class.
+static int size_class(size_t n) {
+    int c = 0;
+    while (c < HASH_NUM_CLASSES && ((size_t)HASH_MIN_BLOCK << c) < n) c++;
+    return c < HASH_NUM_CLASSES ? c : -1;
+}
+
+static char *block_alloc(struct HashTable *table, int c) {
+    char *p = table->free_blocks[c];
+    if (p) {
+        memcpy(&table->free_blocks[c], p, sizeof(p));
+        return p;
+    }
+    return arena_alloc(table, (size_t)HASH_MIN_BLOCK << c);
+}
+
+static void block_free(struct HashTable *table, char *p, int c) {
+    memcpy(p, &table->free_blocks[c], sizeof(p));
+    table->free_blocks[c] = p;
+}
+
+static struct HashSlot *find(const struct HashTable *table, const char *key, uint32_t hash) {
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        struct HashSlot *slot = &table->slots[i];
+        if (slot->key == NULL) return NULL;
+        if (slot->hash == hash && strcmp(slot->key, key) == 0) return slot;
+    }
+}
+
+static struct HashSlot *empty_slot(struct HashSlot *slots, uint32_t capacity, uint32_t hash) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = hash & mask;
+    while (slots[i].key != NULL) i = (i + 1) & mask;
+    return &slots[i];
+}
+
+static bool grow(struct HashTable *table) {
+    uint32_t capacity = table->capacity * 2;
+    struct HashSlot *slots = calloc(capacity, sizeof(*slots));
+    if (slots == NULL) return false;
+
+    for (uint32_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].key == NULL) continue;
+        *empty_slot(slots, capacity, table->slots[i].hash) = table->slots[i];
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return true;
 }
 
 struct HashTable hashtable_create() {
-    struct HashTable table;
-    table.size = TABLE_SIZE;
-    table.bucket = calloc(TABLE_SIZE, sizeof(char*));
-    table.values = calloc(TABLE_SIZE, sizeof(char*));
+    struct HashTable table = {0};
+    table.slots = calloc(HASH_INITIAL_CAPACITY, sizeof(*table.slots));
+    if (table.slots) table.capacity = HASH_INITIAL_CAPACITY;
     return table;
 }
 
-void hashtable_insert(struct HashTable *table, const char *key, const char *value) {
-    if (!table || !key) return;
+void hashtable_destroy(struct HashTable *table) {
+    struct HashArenaBlock *block = table->arena;
+    while (block) {
+        struct HashArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(table->slots);
+    *table = (struct HashTable){0};
+}
 
-    const int index = key_hash(key);
+bool hashtable_insert(struct HashTable *table, const char *key, const char *value) {
+    if (!table || !key || !value || table->capacity == 0) return false;
 
-    // Linear probe: find existing slot for this key, or first empty slot
-    for (int i = 0; i < TABLE_SIZE; i++) {
-        int slot = (index + i) % TABLE_SIZE;
+    uint32_t hash = key_hash(key);
+    size_t value_len = strlen(value);
+    int value_class = size_class(value_len + 1);
+    if (value_class < 0) return false;
+    struct HashSlot *slot = find(table, key, hash);
 
-        if (table->bucket[slot] == NULL) {
-            // Empty slot
-            table->bucket[slot] = strdup(key);
-            table->values[slot] = strdup(value);
-            return;
+    if (slot) {
+        if (value_len < slot->value_cap) {
+            memcpy(slot->value, value, value_len + 1);
+            return true;
         }
+        char *p = block_alloc(table, value_class);
+        if (p == NULL) return false;
+        memcpy(p, value, value_len + 1);
+        block_free(table, slot->value, size_class(slot->value_cap));
+        slot->value = p;
+        slot->value_cap = (uint16_t)(HASH_MIN_BLOCK << value_class);
+        return true;
+    }
 
-        if (strcmp(table->bucket[slot], key) == 0) {
-            // Key already exists
-            free(table->values[slot]);
-            table->values[slot] = strdup(value);
-            return;
-        }
+    size_t key_len = strlen(key);
+    int key_class = size_class(key_len + 1);
+    if (key_class < 0) return false;
+
+    // Keep load at or under 3/4 so probe runs stay short.
+    if ((table->count + 1) * 4 > table->capacity * 3 && !grow(table)) return false;
+
+    char *k = block_alloc(table, key_class);
+    if (k == NULL) return false;
+    char *v = block_alloc(table, value_class);
+    if (v == NULL) {
+        block_free(table, k, key_class);
+        return false;
     }
+    memcpy(k, key, key_len + 1);
+    memcpy(v, value, value_len + 1);
+
+    slot = empty_slot(table->slots, table->capacity, hash);
+    slot->hash = hash;
+    slot->key = k;
+    slot->value = v;
+    slot->value_cap = (uint16_t)(HASH_MIN_BLOCK << value_class);
+    table->count++;
+    return true;
 }
 
-const char *hashtable_get(struct HashTable *table, char *key) {
-    if (!table || !key) return NULL;
+const char *hashtable_get(const struct HashTable *table, const char *key) {
+    if (!table || !key || table->capacity == 0) return NULL;
+
+    struct HashSlot *slot = find(table, key, key_hash(key));
+    return slot ? slot->value : NULL;
+}
 
-    int index = key_hash(key);
+bool hashtable_remove(struct HashTable *table, const char *key) {
+    if (!table || !key || table->capacity == 0) return false;
 
-    for (int i = 0; i < TABLE_SIZE; i++) {
-        int slot = (index + i) % TABLE_SIZE;
-        if (table->bucket[slot] == NULL) return NULL;
-        if (strcmp(table->bucket[slot], key) == 0) return table->values[slot];
-    }
+    struct HashSlot *slot = find(table, key, key_hash(key));
+    if (slot == NULL) return false;
+    block_free(table, slot->key, size_class(strlen(slot->key) + 1));
+    block_free(table, slot->value, size_class(slot->value_cap));
 
-    return NULL;
+    // Backward shift: pull later members of the run into the hole unless
+    // that would move one before its home slot.
+    uint32_t mask = table->capacity - 1;
+    uint32_t hole = (uint32_t)(slot - table->slots);
+    for (uint32_t i = (hole + 1) & mask; table->slots[i].key != NULL; i = (i + 1) & mask) {
+        uint32_t home = table->slots[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table->slots[hole] = table->slots[i];
+            hole = i;
+        }
+    }
+    table->slots[hole] = (struct HashSlot){0};
+    table->count--;
+    return true;
 }
 
-char** hashtable_list_keys(struct HashTable *table) {
-    return table->bucket;
-}
\ No newline at end of file
+bool hashtable_next(const struct HashTable *table, uint32_t *pos, const char **key, const char **value) {
+    while (*pos < table->capacity) {
+        const struct HashSlot *slot = &table->slots[(*pos)++];
+        if (slot->key == NULL) continue;
+        *key = slot->key;
+        *value = slot->value;
+        return true;
+    }
+    return false;
+}
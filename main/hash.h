@@ -2,20 +2,62 @@
 #define ESP32_RECEIVER_HASH_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-int key_hash(const char *key);
-bool key_equals(char *key, char *other);
+// String -> string map. Open addressing with linear probing over a
+// power-of-two slot array that doubles past 3/4 load; removal shifts the
+// rest of the probe run back, so there are no tombstones and a miss stops
+// at the first empty slot. Each slot caches its key's hash, so probes only
+// strcmp on a full hash match.
+//
+// Keys and values live in a chained arena instead of one strdup each,
+// carved in power-of-two size classes. A value overwritten with one that
+// fits its block is rewritten in place; otherwise it moves to a larger
+// block. Blocks given up by an overwrite or a removal go on their class's
+// free list and are reused before the arena grows, so the arena stays
+// bounded by the largest live contents rather than by the write history.
+// Pointers returned by hashtable_get() stay valid until that key is
+// overwritten or removed.
+//
+// Not thread-safe: a caller sharing a table between tasks serialises every
+// call, and holds the same lock while it reads through returned pointers.
+
+#define HASH_INITIAL_CAPACITY 16    // power of two
+#define HASH_ARENA_BLOCK 1024       // bytes per arena block, larger for big entries
+#define HASH_MIN_BLOCK 8            // smallest size class
+#define HASH_NUM_CLASSES 13         // 8 B .. 32 KB; longer keys or values are refused
+
+struct HashSlot {
+    uint32_t hash;
+    uint16_t value_cap;  // size of the block at value, NUL included
+    char *key;           // NULL when the slot is empty
+    char *value;
+};
+
+struct HashArenaBlock;
 
 struct HashTable {
-    int size;           // Size of bucket array
-    char **bucket;      // Array of pointers to keys/values
-    char **values;      // Array of pointers to strings
+    uint32_t capacity;   // slot count, a power of two
+    uint32_t count;
+    struct HashSlot *slots;
+    struct HashArenaBlock *arena;
+    char *free_blocks[HASH_NUM_CLASSES];   // linked through each block's first bytes
 };
 
+uint32_t key_hash(const char *key);
+
 struct HashTable hashtable_create();
+void hashtable_destroy(struct HashTable *table);
+
+// false when out of memory or the key or value is too long; the table is
+// unchanged in that case.
+bool hashtable_insert(struct HashTable *table, const char *key, const char *value);
+const char *hashtable_get(const struct HashTable *table, const char *key);
+bool hashtable_remove(struct HashTable *table, const char *key);
 
-void hashtable_insert(struct HashTable *table, const char *key, const char *value);
-const char *hashtable_get(struct HashTable *table, char *key);
-char** hashtable_list_keys(struct HashTable *table);
+// Walks the entries in slot order. Start with *pos = 0; returns false when
+// done. Not stable across inserts or removals.
+bool hashtable_next(const struct HashTable *table, uint32_t *pos, const char **key, const char **value);
 
-#endif //ESP32_RECEIVER_HASH_H
\ No newline at end of file
+#endif //ESP32_RECEIVER_HASH_H
@@ -0,0 +1,314 @@
+#include "history.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "protocol.h"
+#include "seqlock.h"
+#include "telemetry_schema.h"
+
+static const char *TAG = "history";
+
+// Channels are the schema fields with a "series" key, in raw sensor units.
+#define NUM_CHANNELS TELEMETRY_NUM_SERIES
+
+#define CHANNEL_FIELD(c) (&telemetry_fields[telemetry_series[c]])
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t raw[HISTORY_FRAME_MAX];
+} frame_entry_t;
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t sum;   // 4096 frames of u16 still fit
+} agg_t;
+
+typedef struct {
+    uint32_t t_start;
+    uint32_t t_end;
+    uint32_t count;
+    agg_t ch[NUM_CHANNELS];
+} bucket_t;
+
+typedef struct {
+    bucket_t *ring;
+    int capacity;
+    int head;            // next slot to write
+    int count;
+    bucket_t open;       // accumulating, not yet visible to queries
+    int open_children;
+} level_t;
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+    uint32_t count;
+} bin_t;
+
+// One per telemetry source that has history.
+typedef struct {
+    frame_entry_t *frames;
+    int frames_head;
+    int frames_count;
+    level_t levels[HISTORY_LEVELS];      // levels[0] unused; L0 is frames[]
+    seqlock_t lock;
+    bool ready;
+} source_history_t;
+
+static size_t frame_len;
+static source_history_t histories[HISTORY_MAX_SOURCES];
+
+// Query scratch; httpd runs handlers on a single task.
+static bin_t bins[HISTORY_MAX_POINTS];
+
+static const int level_capacity[HISTORY_LEVELS] = {
+    HISTORY_L0_FRAMES, HISTORY_L1_BUCKETS, HISTORY_L2_BUCKETS, HISTORY_L3_BUCKETS
+};
+
+static void history_free(source_history_t *h) {
+    free(h->frames);
+    h->frames = NULL;
+    for (int k = 1; k < HISTORY_LEVELS; k++) {
+        free(h->levels[k].ring);
+        h->levels[k].ring = NULL;
+    }
+}
+
+static esp_err_t history_alloc(source_history_t *h) {
+    h->frames = calloc(HISTORY_L0_FRAMES, sizeof(frame_entry_t));
+    if (h->frames == NULL) goto nomem;
+    for (int k = 1; k < HISTORY_LEVELS; k++) {
+        h->levels[k].capacity = level_capacity[k];
+        h->levels[k].ring = calloc(h->levels[k].capacity, sizeof(bucket_t));
+        if (h->levels[k].ring == NULL) goto nomem;
+    }
+    h->ready = true;
+    return ESP_OK;
+
+nomem:
+    history_free(h);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t history_init(void) {
+    frame_len = telemetry_frame_len();
+    if (frame_len > HISTORY_FRAME_MAX) {
+        ESP_LOGE(TAG, "Telemetry frame (%zu bytes) larger than HISTORY_FRAME_MAX", frame_len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int ready = 0;
+    while (ready < HISTORY_MAX_SOURCES && history_alloc(&histories[ready]) == ESP_OK) ready++;
+    if (ready == 0) {
+        ESP_LOGE(TAG, "Not enough heap for telemetry history");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "History ready: %d source(s), %d channels, %u bytes each",
+             ready, (int)NUM_CHANNELS,
+             (unsigned)(HISTORY_L0_FRAMES * sizeof(frame_entry_t) +
+                        (HISTORY_L1_BUCKETS + HISTORY_L2_BUCKETS + HISTORY_L3_BUCKETS) * sizeof(bucket_t)));
+    if (ready < HISTORY_MAX_SOURCES) {
+        ESP_LOGW(TAG, "Heap ran out after %d of %d history sources", ready, HISTORY_MAX_SOURCES);
+    }
+    return ESP_OK;
+}
+
+static int32_t channel_value(int c, const uint8_t *raw) {
+    return telemetry_field_raw(CHANNEL_FIELD(c), raw);
+}
+
+static void bucket_reset(bucket_t *b) {
+    b->count = 0;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        b->ch[c].min = INT32_MAX;
+        b->ch[c].max = INT32_MIN;
+        b->ch[c].sum = 0;
+    }
+}
+
+static void bucket_add_frame(bucket_t *b, uint32_t t_ms, const uint8_t *raw) {
+    if (b->count == 0) b->t_start = t_ms;
+    b->t_end = t_ms;
+    b->count++;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        int32_t v = channel_value(c, raw);
+        if (v < b->ch[c].min) b->ch[c].min = v;
+        if (v > b->ch[c].max) b->ch[c].max = v;
+        b->ch[c].sum += v;
+    }
+}
+
+static void bucket_merge(bucket_t *dst, const bucket_t *src) {
+    if (dst->count == 0) dst->t_start = src->t_start;
+    dst->t_end = src->t_end;
+    dst->count += src->count;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        if (src->ch[c].min < dst->ch[c].min) dst->ch[c].min = src->ch[c].min;
+        if (src->ch[c].max > dst->ch[c].max) dst->ch[c].max = src->ch[c].max;
+        dst->ch[c].sum += src->ch[c].sum;
+    }
+}
+
+void history_append(int src, const telemetry_snapshot_t *snap) {
+    if (src < 0 || src >= HISTORY_MAX_SOURCES || !histories[src].ready) return;
+    source_history_t *h = &histories[src];
+    level_t *levels = h->levels;
+
+    seqlock_write_begin(&h->lock);
+
+    frame_entry_t *f = &h->frames[h->frames_head];
+    f->t_ms = snap->rx_ms;
+    memcpy(f->raw, snap->raw, frame_len);
+    h->frames_head = (h->frames_head + 1) % HISTORY_L0_FRAMES;
+    if (h->frames_count < HISTORY_L0_FRAMES) h->frames_count++;
+
+    if (levels[1].open_children == 0) bucket_reset(&levels[1].open);
+    bucket_add_frame(&levels[1].open, f->t_ms, f->raw);
+    levels[1].open_children++;
+
+    // Close every level whose open bucket is full, feeding the next one up.
+    for (int k = 1; k < HISTORY_LEVELS && levels[k].open_children == HISTORY_FANOUT; k++) {
+        level_t *lv = &levels[k];
+        bucket_t *closed = &lv->ring[lv->head];
+        *closed = lv->open;
+        lv->head = (lv->head + 1) % lv->capacity;
+        if (lv->count < lv->capacity) lv->count++;
+        lv->open_children = 0;
+
+        if (k + 1 < HISTORY_LEVELS) {
+            level_t *up = &levels[k + 1];
+            if (up->open_children == 0) bucket_reset(&up->open);
+            bucket_merge(&up->open, closed);
+            up->open_children++;
+        }
+    }
+
+    seqlock_write_end(&h->lock);
+}
+
+bool history_available(int src) {
+    return src >= 0 && src < HISTORY_MAX_SOURCES && histories[src].ready;
+}
+
+int history_find_channel(const char *key) {
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        if (strcmp(CHANNEL_FIELD(c)->series, key) == 0) return c;
+    }
+    return -1;
+}
+
+int history_channel_count(void) {
+    return NUM_CHANNELS;
+}
+
+const char *history_channel_name(int ch) {
+    return (ch >= 0 && ch < NUM_CHANNELS) ? CHANNEL_FIELD(ch)->series : NULL;
+}
+
+const telemetry_field_t *history_channel_field(int ch) {
+    return (ch >= 0 && ch < NUM_CHANNELS) ? CHANNEL_FIELD(ch) : NULL;
+}
+
+static uint32_t level_oldest(const source_history_t *h, int k) {
+    if (k == 0) {
+        int oldest = (h->frames_head - h->frames_count + HISTORY_L0_FRAMES) % HISTORY_L0_FRAMES;
+        return h->frames[oldest].t_ms;
+    }
+    const level_t *lv = &h->levels[k];
+    return lv->ring[(lv->head - lv->count + lv->capacity) % lv->capacity].t_start;
+}
+
+static int level_count(const source_history_t *h, int k) {
+    return k == 0 ? h->frames_count : h->levels[k].count;
+}
+
+static void bin_add(int b, int32_t min, int32_t max, int64_t sum, uint32_t count) {
+    bin_t *bin = &bins[b];
+    if (bin->count == 0 || min < bin->min) bin->min = min;
+    if (bin->count == 0 || max > bin->max) bin->max = max;
+    bin->sum += sum;
+    bin->count += count;
+}
+
+// Walks from the coarsest useful level down to raw frames; each finer level
+// only contributes what is newer than the last entry already binned. An
+// entry that starts before from_ms but reaches into the range goes to the
+// first bin, so the start of the range is not lost between two buckets.
+static int query_once(const source_history_t *h, int ch, uint32_t from_ms, uint32_t to_ms, int nbins, uint64_t width) {
+    memset(bins, 0, sizeof(bins[0]) * nbins);
+
+    int start = 0;
+    while (start + 1 < HISTORY_LEVELS && level_count(h, start) > 0 && level_oldest(h, start) > from_ms &&
+           level_count(h, start + 1) > 0) {
+        start++;
+    }
+
+    uint32_t cursor = from_ms;
+    for (int k = start; k >= 0; k--) {
+        int n = level_count(h, k);
+        for (int i = 0; i < n; i++) {
+            uint32_t t_start, t_end;
+            int32_t min, max;
+            int64_t sum;
+            uint32_t count;
+            if (k == 0) {
+                const frame_entry_t *f = &h->frames[(h->frames_head - n + i + HISTORY_L0_FRAMES) % HISTORY_L0_FRAMES];
+                t_start = t_end = f->t_ms;
+                min = max = channel_value(ch, f->raw);
+                sum = min;
+                count = 1;
+            } else {
+                const level_t *lv = &h->levels[k];
+                const bucket_t *b = &lv->ring[(lv->head - n + i + lv->capacity) % lv->capacity];
+                t_start = b->t_start;
+                t_end = b->t_end;
+                min = b->ch[ch].min;
+                max = b->ch[ch].max;
+                sum = b->ch[ch].sum;
+                count = b->count;
+            }
+            if (t_end < cursor || t_start > to_ms) continue;
+            uint32_t t = t_start > from_ms ? t_start : from_ms;
+            bin_add((int)((t - from_ms) / width), min, max, sum, count);
+            cursor = t_end + 1;
+        }
+    }
+    return start;
+}
+
+bool history_query(int src, int ch, uint32_t from_ms, uint32_t to_ms, int points, history_result_t *out) {
+    out->count = 0;
+    out->level = 0;
+    if (!history_available(src) || ch < 0 || ch >= NUM_CHANNELS || to_ms < from_ms) return true;
+
+    if (points <= 0) points = HISTORY_DEFAULT_POINTS;
+    if (points > HISTORY_MAX_POINTS) points = HISTORY_MAX_POINTS;
+    // 64-bit: from=0, to=UINT32_MAX spans 2^32 ms.
+    uint64_t span = (uint64_t)to_ms - from_ms + 1;
+    uint64_t width = (span + points - 1) / points;
+    int nbins = (int)((span + width - 1) / width);
+    assert(nbins >= 1 && nbins <= HISTORY_MAX_POINTS);
+
+    bool consistent = false;
+    for (int attempt = 0; attempt < 8 && !consistent; attempt++) {
+        source_history_t *h = &histories[src];
+        unsigned seq = seqlock_read_begin(&h->lock);
+        out->level = query_once(h, ch, from_ms, to_ms, nbins, width);
+        consistent = !seqlock_read_retry(&h->lock, seq);
+    }
+    if (!consistent) return false;
+
+    for (int b = 0; b < nbins; b++) {
+        if (bins[b].count == 0) continue;
+        history_point_t *p = &out->points[out->count++];
+        p->t_ms = from_ms + (uint32_t)(b * width);
+        p->min = bins[b].min;
+        p->max = bins[b].max;
+        p->mean = (int32_t)(bins[b].sum / bins[b].count);
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef ESP32_RECEIVER_HISTORY_H
+#define ESP32_RECEIVER_HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "telemetry.h"
+
+// Fixed-memory telemetry history. Level 0 is a ring of raw frames; each
+// coarser level is a ring of buckets holding per-channel min/max/sum over
+// HISTORY_FANOUT buckets of the level below. Queries pick the finest level
+// that still reaches back to the requested start and bin the result down to
+// the requested number of points. Each telemetry source gets its own set of
+// rings, allocated in history_init().
+
+#define HISTORY_FRAME_MAX 72      // >= telemetry_frame_len()
+#define HISTORY_L0_FRAMES 256
+#define HISTORY_FANOUT 16
+#define HISTORY_LEVELS 4          // L0 raw + 3 aggregate levels
+#define HISTORY_L1_BUCKETS 64
+#define HISTORY_L2_BUCKETS 32
+#define HISTORY_L3_BUCKETS 16
+#define HISTORY_MAX_POINTS 256
+#define HISTORY_DEFAULT_POINTS 100
+#define HISTORY_MAX_SOURCES 2     // each costs the full set of rings above
+
+// Values are raw sensor counts; history_channel_field() scales them.
+typedef struct {
+    uint32_t t_ms;   // bin start
+    int32_t min;
+    int32_t max;
+    int32_t mean;
+} history_point_t;
+
+typedef struct {
+    int level;       // coarsest level the result was read from
+    int count;
+    history_point_t points[HISTORY_MAX_POINTS];
+} history_result_t;
+
+esp_err_t history_init(void);
+
+// Writer side — espnow_task only. src is the telemetry source index; only
+// the first HISTORY_MAX_SOURCES sources keep history.
+void history_append(int src, const telemetry_snapshot_t *snap);
+bool history_available(int src);
+
+int history_find_channel(const char *key);
+int history_channel_count(void);
+const char *history_channel_name(int ch);
+// The schema field a channel records, for its unit and scale.
+const telemetry_field_t *history_channel_field(int ch);
+
+// Reader side. A bucket straddling from_ms is counted in the first point.
+// Returns false if the writer kept racing the query.
+bool history_query(int src, int ch, uint32_t from_ms, uint32_t to_ms, int points, history_result_t *out);
+
+#endif //ESP32_RECEIVER_HISTORY_H
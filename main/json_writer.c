@@ -0,0 +1,187 @@
+#include "json_writer.h"
+#include <string.h>
+#include "fmt.h"
+
+void json_init_stream(json_writer_t *w, httpd_req_t *req, char *buf, size_t len) {
+    memset(w, 0, sizeof(*w));
+    w->req = req;
+    w->buf = buf;
+    w->cap = len < JSON_FLUSH_BYTES ? len : JSON_FLUSH_BYTES;
+    w->err = ESP_OK;
+}
+
+void json_init_buffer(json_writer_t *w, char *buf, size_t len, size_t reserve) {
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->limit = len > 0 ? len - 1 : 0;   // room for the NUL
+    w->cap = w->limit > reserve ? w->limit - reserve : 0;
+    w->err = ESP_OK;
+}
+
+static void flush(json_writer_t *w) {
+    if (w->pos > 0 && w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->pos);
+    }
+    w->pos = 0;
+}
+
+static void put_slow(json_writer_t *w, const char *s, size_t n) {
+    if (w->overflow) return;
+    while (n > 0) {
+        size_t room = w->pos < w->cap ? w->cap - w->pos : 0;
+        if (room == 0) {
+            if (w->req == NULL) {
+                w->overflow = true;
+                return;
+            }
+            flush(w);
+            continue;
+        }
+        size_t k = n < room ? n : room;
+        memcpy(w->buf + w->pos, s, k);
+        w->pos += k;
+        s += k;
+        n -= k;
+    }
+}
+
+// Most writes fit in what is left of the buffer; only the rest flush or overflow.
+static inline void put(json_writer_t *w, const char *s, size_t n) {
+    if (!w->overflow && w->pos <= w->cap && n <= w->cap - w->pos) {
+        memcpy(w->buf + w->pos, s, n);
+        w->pos += n;
+        return;
+    }
+    put_slow(w, s, n);
+}
+
+static inline void putc_(json_writer_t *w, char c) {
+    if (!w->overflow && w->pos < w->cap) {
+        w->buf[w->pos++] = c;
+        return;
+    }
+    put_slow(w, &c, 1);
+}
+
+// Comma before every element except the first in its container, and never
+// between a key and its value.
+static void element(json_writer_t *w) {
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    uint32_t bit = 1u << w->depth;
+    if (w->has_items & bit) putc_(w, ',');
+    w->has_items |= bit;
+}
+
+static void open_container(json_writer_t *w, char c) {
+    element(w);
+    putc_(w, c);
+    if (w->depth < JSON_MAX_DEPTH - 1) w->depth++;
+    w->has_items &= ~(1u << w->depth);
+}
+
+static void close_container(json_writer_t *w, char c) {
+    w->has_items &= ~(1u << w->depth);
+    if (w->depth > 0) w->depth--;
+    w->after_key = false;
+    // Closing brackets may use the reserve, so a document whose last
+    // element was rolled back can still be closed.
+    if (w->req == NULL && !w->overflow && w->pos >= w->cap && w->pos < w->limit) {
+        w->buf[w->pos++] = c;
+        return;
+    }
+    putc_(w, c);
+}
+
+void json_begin_object(json_writer_t *w) { open_container(w, '{'); }
+void json_end_object(json_writer_t *w)   { close_container(w, '}'); }
+void json_begin_array(json_writer_t *w)  { open_container(w, '['); }
+void json_end_array(json_writer_t *w)    { close_container(w, ']'); }
+
+static void quoted(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    putc_(w, '"');
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        put(w, run, s - run);
+        run = s + 1;
+        switch (c) {
+            case '"':  put(w, "\\\"", 2); break;
+            case '\\': put(w, "\\\\", 2); break;
+            case '\n': put(w, "\\n", 2); break;
+            case '\r': put(w, "\\r", 2); break;
+            case '\t': put(w, "\\t", 2); break;
+            default: {
+                char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                put(w, u, sizeof(u));
+            }
+        }
+    }
+    put(w, run, s - run);
+    putc_(w, '"');
+}
+
+void json_key(json_writer_t *w, const char *key) {
+    element(w);
+    quoted(w, key);
+    putc_(w, ':');
+    w->after_key = true;
+}
+
+void json_string(json_writer_t *w, const char *s) {
+    element(w);
+    quoted(w, s);
+}
+
+void json_int(json_writer_t *w, long long v) {
+    char tmp[FMT_I64_MAX];
+    element(w);
+    put(w, tmp, fmt_i64(tmp, v));
+}
+
+void json_uint(json_writer_t *w, unsigned long long v) {
+    char tmp[FMT_U64_MAX];
+    element(w);
+    put(w, tmp, fmt_u64(tmp, v));
+}
+
+void json_fixed(json_writer_t *w, long long v, unsigned decimals) {
+    char tmp[FMT_FIXED_MAX];
+    element(w);
+    put(w, tmp, fmt_fixed(tmp, v, decimals));
+}
+
+void json_bool(json_writer_t *w, bool v) {
+    element(w);
+    if (v) put(w, "true", 4);
+    else put(w, "false", 5);
+}
+
+void json_null(json_writer_t *w) {
+    element(w);
+    put(w, "null", 4);
+}
+
+void json_rollback(json_writer_t *w, json_mark_t m) {
+    w->pos = m.pos;
+    w->depth = m.depth;
+    w->has_items = m.has_items;
+    w->after_key = m.after_key;
+    w->overflow = false;
+}
+
+size_t json_finish_buffer(json_writer_t *w) {
+    w->buf[w->pos] = '\0';
+    return w->pos;
+}
+
+esp_err_t json_finish_stream(json_writer_t *w) {
+    flush(w);
+    esp_err_t err = httpd_resp_send_chunk(w->req, NULL, 0);
+    return w->err != ESP_OK ? w->err : err;
+}
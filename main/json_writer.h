@@ -0,0 +1,70 @@
+#ifndef ESP32_RECEIVER_JSON_WRITER_H
+#define ESP32_RECEIVER_JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Streaming JSON writer. Commas between elements and string escaping are
+// handled here, so callers only describe structure.
+//
+// Stream mode (req != NULL): output goes to buf and is sent as one HTTP
+// chunk each time JSON_FLUSH_BYTES accumulate, i.e. about one TCP segment
+// per lwIP write instead of one write per row.
+//
+// Buffer mode (req == NULL): output stays in buf. Once full, further writes
+// set overflow; pair json_mark/json_rollback around each array element to
+// drop the element that did not fit.
+
+#define JSON_FLUSH_BYTES 1400     // fits one TCP_MSS (1440) with chunk framing
+#define JSON_MAX_DEPTH 8
+
+typedef struct {
+    httpd_req_t *req;
+    char *buf;
+    size_t cap;                   // bytes usable for elements
+    size_t limit;                 // buffer mode: cap + reserve, for closing brackets
+    size_t pos;
+    int depth;
+    uint32_t has_items;           // bit d: container at depth d already has an element
+    bool after_key;
+    bool overflow;
+    esp_err_t err;                // first send error in stream mode
+} json_writer_t;
+
+typedef struct {
+    size_t pos;
+    int depth;
+    uint32_t has_items;
+    bool after_key;
+} json_mark_t;
+
+void json_init_stream(json_writer_t *w, httpd_req_t *req, char *buf, size_t len);
+// Keeps `reserve` bytes free so closing brackets always fit after a rollback.
+void json_init_buffer(json_writer_t *w, char *buf, size_t len, size_t reserve);
+
+void json_begin_object(json_writer_t *w);
+void json_end_object(json_writer_t *w);
+void json_begin_array(json_writer_t *w);
+void json_end_array(json_writer_t *w);
+void json_key(json_writer_t *w, const char *key);
+void json_string(json_writer_t *w, const char *s);
+void json_int(json_writer_t *w, long long v);
+void json_uint(json_writer_t *w, unsigned long long v);
+// v in units of 10^-decimals, written as a decimal number: (-1234, 2) -> -12.34.
+void json_fixed(json_writer_t *w, long long v, unsigned decimals);
+void json_bool(json_writer_t *w, bool v);
+void json_null(json_writer_t *w);
+
+static inline json_mark_t json_mark(const json_writer_t *w) {
+    return (json_mark_t){ w->pos, w->depth, w->has_items, w->after_key };
+}
+void json_rollback(json_writer_t *w, json_mark_t m);
+
+// Buffer mode: NUL-terminates and returns the length. Stream mode: sends
+// what is left plus the terminating chunk and returns the first error.
+size_t json_finish_buffer(json_writer_t *w);
+esp_err_t json_finish_stream(json_writer_t *w);
+
+#endif //ESP32_RECEIVER_JSON_WRITER_H
@@ -0,0 +1,264 @@
+#include "laps.h"
+#include <esp_log.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "json_writer.h"
+#include "server.h"
+
+static const char *TAG = "laps";
+
+#define LAP_NONE INT64_MIN        // time not known (no lap yet, skipped gate)
+
+typedef struct {
+    char name[32];
+    int gate_count;
+    int peers[LAPS_MAX_GATES];                // peer records in course order
+
+    // Run in progress
+    bool active;
+    int next_gate;
+    int64_t start_us;
+    int64_t prev_us;
+    int64_t sectors_us[LAPS_MAX_SECTORS];
+
+    // Completed laps
+    uint32_t laps;
+    int64_t last_us;
+    int64_t last_delta_us;                    // against the best lap before it
+    int64_t last_sectors_us[LAPS_MAX_SECTORS];
+    int64_t last_sector_deltas_us[LAPS_MAX_SECTORS];
+    int64_t best_us;
+    int64_t best_sectors_us[LAPS_MAX_SECTORS];
+    int64_t theoretical_us;                   // sum of best sectors
+} lap_group_t;
+
+typedef struct {
+    int8_t group;                             // -1: not in a series group
+    int8_t pos;
+} lap_slot_t;
+
+static lap_group_t groups[LAPS_MAX_GROUPS];
+static int group_count;
+static lap_slot_t slots[PEER_MAX];
+static SemaphoreHandle_t laps_lock;
+
+static void reset_results(lap_group_t *g) {
+    g->active = false;
+    g->laps = 0;
+    g->last_us = g->last_delta_us = g->best_us = g->theoretical_us = LAP_NONE;
+    for (int s = 0; s < LAPS_MAX_SECTORS; s++) {
+        g->sectors_us[s] = g->last_sectors_us[s] = LAP_NONE;
+        g->last_sector_deltas_us[s] = g->best_sectors_us[s] = LAP_NONE;
+    }
+}
+
+static bool same_course(const lap_group_t *a, const lap_group_t *b) {
+    return strcmp(a->name, b->name) == 0 && a->gate_count == b->gate_count &&
+           memcmp(a->peers, b->peers, a->gate_count * sizeof(a->peers[0])) == 0;
+}
+
+void laps_reconfigure(void) {
+    // httpd task only (config writer), so one scratch copy is enough
+    static lap_group_t next[LAPS_MAX_GROUPS];
+    int next_count = 0;
+
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *peer = peer_at(i);
+        const gate_config_t *cfg = &peer->config;
+        if (!peer_has(peer, PEER_F_CONFIG) || cfg->mode != GATE_MODE_SERIES || cfg->group[0] == '\0') continue;
+
+        lap_group_t *g = NULL;
+        for (int k = 0; k < next_count && g == NULL; k++) {
+            if (strcmp(next[k].name, cfg->group) == 0) g = &next[k];
+        }
+        if (g == NULL) {
+            if (next_count == LAPS_MAX_GROUPS) {
+                ESP_LOGW(TAG, "Too many series groups, ignoring '%s'", cfg->group);
+                continue;
+            }
+            g = &next[next_count++];
+            memset(g, 0, sizeof(*g));
+            strncpy(g->name, cfg->group, sizeof(g->name) - 1);
+        }
+        if (g->gate_count == LAPS_MAX_GATES) {
+            ESP_LOGW(TAG, "Group '%s' has more than %d gates, ignoring %s", g->name, LAPS_MAX_GATES, peer->mac_str);
+            continue;
+        }
+
+        // Insertion by config.order keeps the course sorted.
+        int pos = g->gate_count++;
+        while (pos > 0 && peer_at(g->peers[pos - 1])->config.order > cfg->order) {
+            g->peers[pos] = g->peers[pos - 1];
+            pos--;
+        }
+        g->peers[pos] = i;
+    }
+
+    xSemaphoreTake(laps_lock, portMAX_DELAY);
+    int kept = 0;
+    for (int k = 0; k < next_count; k++) {
+        lap_group_t *g = &next[k];
+        if (g->gate_count < 2) continue;
+
+        const lap_group_t *old = NULL;
+        for (int j = 0; j < group_count && old == NULL; j++) {
+            if (same_course(&groups[j], g)) old = &groups[j];
+        }
+        if (old != NULL) *g = *old;
+        else reset_results(g);
+        next[kept++] = *g;
+    }
+
+    memcpy(groups, next, kept * sizeof(groups[0]));
+    group_count = kept;
+    for (int i = 0; i < PEER_MAX; i++) slots[i].group = -1;
+    for (int k = 0; k < group_count; k++) {
+        for (int p = 0; p < groups[k].gate_count; p++) {
+            slots[groups[k].peers[p]] = (lap_slot_t){ .group = (int8_t)k, .pos = (int8_t)p };
+        }
+    }
+    xSemaphoreGive(laps_lock);
+
+    ESP_LOGI(TAG, "%d series group(s)", group_count);
+}
+
+static void complete_lap(lap_group_t *g, int64_t lap_us) {
+    int sectors = g->gate_count - 1;
+    g->laps++;
+    g->last_us = lap_us;
+    g->last_delta_us = g->best_us != LAP_NONE ? lap_us - g->best_us : LAP_NONE;
+    if (g->best_us == LAP_NONE || lap_us < g->best_us) g->best_us = lap_us;
+
+    int64_t theoretical = 0;
+    for (int s = 0; s < sectors; s++) {
+        int64_t t = g->sectors_us[s];
+        int64_t best = g->best_sectors_us[s];
+        g->last_sectors_us[s] = t;
+        g->last_sector_deltas_us[s] = (t != LAP_NONE && best != LAP_NONE) ? t - best : LAP_NONE;
+        if (t != LAP_NONE && (best == LAP_NONE || t < best)) g->best_sectors_us[s] = t;
+
+        if (theoretical != LAP_NONE) {
+            theoretical = g->best_sectors_us[s] != LAP_NONE ? theoretical + g->best_sectors_us[s] : LAP_NONE;
+        }
+    }
+    g->theoretical_us = theoretical;
+    g->active = false;
+}
+
+void laps_on_trigger(const peer_t *peer, int64_t timestamp_us) {
+    int idx = peer_index(peer);
+    if (laps_lock == NULL || idx < 0) return;
+
+    xSemaphoreTake(laps_lock, portMAX_DELAY);
+    lap_slot_t slot = slots[idx];
+    if (slot.group < 0) {
+        xSemaphoreGive(laps_lock);
+        return;
+    }
+
+    lap_group_t *g = &groups[slot.group];
+    if (slot.pos == 0) {
+        g->active = true;
+        g->next_gate = 1;
+        g->start_us = g->prev_us = timestamp_us;
+        for (int s = 0; s < LAPS_MAX_SECTORS; s++) g->sectors_us[s] = LAP_NONE;
+    } else if (g->active && slot.pos >= g->next_gate) {
+        // Gates skipped since the last trigger leave their sectors unknown.
+        int64_t sector_us = timestamp_us - g->prev_us;
+        g->sectors_us[slot.pos - 1] = (slot.pos == g->next_gate && sector_us > 0) ? sector_us : LAP_NONE;
+        g->prev_us = timestamp_us;
+        g->next_gate = slot.pos + 1;
+
+        if (slot.pos == g->gate_count - 1) {
+            int64_t lap_us = timestamp_us - g->start_us;
+            if (lap_us > 0) complete_lap(g, lap_us);
+            else g->active = false;
+        }
+    }
+    xSemaphoreGive(laps_lock);
+}
+
+static void json_time(json_writer_t *w, int64_t us) {
+    if (us == LAP_NONE) json_null(w);
+    else json_int(w, us);
+}
+
+static void json_times(json_writer_t *w, const int64_t *us, int n) {
+    json_begin_array(w);
+    for (int i = 0; i < n; i++) json_time(w, us[i]);
+    json_end_array(w);
+}
+
+// GET /laps -> one object per series group
+static esp_err_t laps_get_handler(httpd_req_t *req) {
+    // httpd runs handlers on a single task, so these can be static.
+    static lap_group_t snap[LAPS_MAX_GROUPS];
+    static char buf[SERVER_RENDER_BUF_SIZE];
+
+    // Copy out so the send below never holds up espnow_task.
+    xSemaphoreTake(laps_lock, portMAX_DELAY);
+    int n = group_count;
+    memcpy(snap, groups, n * sizeof(snap[0]));
+    xSemaphoreGive(laps_lock);
+
+    set_cors(req);
+    httpd_resp_set_type(req, "application/json");
+
+    json_writer_t w;
+    json_init_stream(&w, req, buf, sizeof(buf));
+    json_begin_array(&w);
+    for (int k = 0; k < n; k++) {
+        const lap_group_t *g = &snap[k];
+        int sectors = g->gate_count - 1;
+
+        json_begin_object(&w);
+        json_key(&w, "group"); json_string(&w, g->name);
+        json_key(&w, "gates");
+        json_begin_array(&w);
+        for (int p = 0; p < g->gate_count; p++) json_string(&w, peer_at(g->peers[p])->mac_str);
+        json_end_array(&w);
+        json_key(&w, "laps");  json_uint(&w, g->laps);
+
+        json_key(&w, "run");
+        if (g->active) {
+            int64_t deltas[LAPS_MAX_SECTORS];
+            for (int s = 0; s < sectors; s++) {
+                bool known = g->sectors_us[s] != LAP_NONE && g->best_sectors_us[s] != LAP_NONE;
+                deltas[s] = known ? g->sectors_us[s] - g->best_sectors_us[s] : LAP_NONE;
+            }
+            json_begin_object(&w);
+            json_key(&w, "start_us");         json_int(&w, g->start_us);
+            json_key(&w, "next_gate");        json_int(&w, g->next_gate);
+            json_key(&w, "sectors_us");       json_times(&w, g->sectors_us, sectors);
+            json_key(&w, "sector_deltas_us"); json_times(&w, deltas, sectors);
+            json_end_object(&w);
+        } else {
+            json_null(&w);
+        }
+
+        json_key(&w, "last_us");               json_time(&w, g->last_us);
+        json_key(&w, "last_delta_us");         json_time(&w, g->last_delta_us);
+        json_key(&w, "last_sectors_us");       json_times(&w, g->last_sectors_us, sectors);
+        json_key(&w, "last_sector_deltas_us"); json_times(&w, g->last_sector_deltas_us, sectors);
+        json_key(&w, "best_us");               json_time(&w, g->best_us);
+        json_key(&w, "best_sectors_us");       json_times(&w, g->best_sectors_us, sectors);
+        json_key(&w, "theoretical_us");        json_time(&w, g->theoretical_us);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    return json_finish_stream(&w);
+}
+
+const httpd_uri_t laps_uri = {
+    .uri       = "/laps",
+    .method    = HTTP_GET,
+    .handler   = laps_get_handler,
+    .user_ctx  = NULL
+};
+
+void laps_init(void) {
+    laps_lock = xSemaphoreCreateMutex();
+    for (int i = 0; i < PEER_MAX; i++) slots[i].group = -1;
+}
@@ -0,0 +1,37 @@
+#ifndef ESP32_RECEIVER_LAPS_H
+#define ESP32_RECEIVER_LAPS_H
+
+#include <esp_http_server.h>
+#include <stdint.h>
+#include "peers.h"
+
+// Lap and sector timing for series-mode gate groups, computed on the
+// receiver as triggers arrive so results do not depend on a browser
+// polling at the right moment.
+//
+// A group is every configured peer with mode GATE_MODE_SERIES and the same
+// non-empty group name, ordered by config.order; it needs at least two
+// gates. The first gate starts a run, each following gate closes a sector
+// and the last gate completes the lap. A trigger on the first gate always
+// starts a new run. A trigger further down the course than expected closes
+// the lap with the skipped sectors unknown; one behind it is ignored.
+//
+// laps_on_trigger() does O(1) work per trigger. The peer -> (group, position)
+// map it uses is rebuilt by laps_reconfigure() whenever gate configs change;
+// groups whose name and gate sequence are unchanged keep their results.
+
+#define LAPS_MAX_GROUPS 8
+#define LAPS_MAX_GATES 8
+#define LAPS_MAX_SECTORS (LAPS_MAX_GATES - 1)
+
+void laps_init(void);
+
+// After any peer->config change; called from the task that writes configs.
+void laps_reconfigure(void);
+
+// espnow_task, from addGateTime.
+void laps_on_trigger(const peer_t *peer, int64_t timestamp_us);
+
+extern const httpd_uri_t laps_uri;
+
+#endif //ESP32_RECEIVER_LAPS_H
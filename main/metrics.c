@@ -0,0 +1,129 @@
+#include "metrics.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+atomic_uint metrics_counters[METRIC_COUNTER_MAX];
+atomic_uint metrics_msg_types[METRICS_MSG_TYPES];
+
+metrics_hist_t metrics_rx_latency_us;
+metrics_hist_t metrics_rx_process_us;
+metrics_hist_t metrics_rx_queue_depth;
+
+static const char *msg_type_names[METRICS_MSG_TYPES] = {
+    "ack", "request", "ping", "gate_ident", "ok", "telemetry", "set_logger_name", "gate_stuck", "unknown",
+};
+
+esp_err_t metrics_flush(metrics_writer_t *w) {
+    esp_err_t err = ESP_OK;
+    if (w->pos > 0) err = httpd_resp_send_chunk(w->req, w->buf, w->pos);
+    w->pos = 0;
+    return err;
+}
+
+void metrics_printf(metrics_writer_t *w, const char *fmt, ...) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(w->buf + w->pos, w->len - w->pos, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if (w->pos + n < w->len) {
+            w->pos += n;
+            return;
+        }
+        // Did not fit: flush what we have and format again into an empty buffer.
+        metrics_flush(w);
+    }
+}
+
+void metrics_write_counter(metrics_writer_t *w, const char *name, const char *help, uint32_t value) {
+    metrics_printf(w, "# HELP %s %s\n# TYPE %s counter\n%s %lu\n",
+                   name, help, name, name, (unsigned long)value);
+}
+
+void metrics_write_gauge(metrics_writer_t *w, const char *name, const char *help, int64_t value) {
+    metrics_printf(w, "# HELP %s %s\n# TYPE %s gauge\n%s %lld\n",
+                   name, help, name, name, (long long)value);
+}
+
+void metrics_write_hist(metrics_writer_t *w, const char *name, const char *help,
+                        const char *labels, const metrics_hist_t *h) {
+    if (help != NULL) {
+        metrics_printf(w, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    }
+    const char *sep = labels ? "," : "";
+    if (labels == NULL) labels = "";
+    const char *open = labels[0] ? "{" : "";
+    const char *close = labels[0] ? "}" : "";
+
+    uint32_t cumulative = 0;
+    for (int b = 0; b < METRICS_HIST_BUCKETS - 1; b++) {
+        cumulative += atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+        metrics_printf(w, "%s_bucket{%s%sle=\"%lu\"} %lu\n", name, labels, sep,
+                       (unsigned long)((1ul << b) - 1), (unsigned long)cumulative);
+    }
+    cumulative += atomic_load_explicit(&h->buckets[METRICS_HIST_BUCKETS - 1], memory_order_relaxed);
+    metrics_printf(w, "%s_bucket{%s%sle=\"+Inf\"} %lu\n", name, labels, sep, (unsigned long)cumulative);
+    metrics_printf(w, "%s_sum%s%s%s %lu\n%s_count%s%s%s %lu\n",
+                   name, open, labels, close, (unsigned long)atomic_load_explicit(&h->sum, memory_order_relaxed),
+                   name, open, labels, close, (unsigned long)atomic_load_explicit(&h->count, memory_order_relaxed));
+}
+
+#define COUNTER(w, id, name, help) \
+    metrics_write_counter(w, name, help, atomic_load_explicit(&metrics_counters[id], memory_order_relaxed))
+
+void metrics_write_pipeline(metrics_writer_t *w) {
+    COUNTER(w, METRIC_RX_FRAMES, "espnow_rx_frames_total", "Frames delivered to the receive callback");
+    metrics_printf(w, "# HELP espnow_rx_dropped_total Received frames dropped before espnow_task\n"
+                      "# TYPE espnow_rx_dropped_total counter\n");
+    metrics_printf(w, "espnow_rx_dropped_total{reason=\"oversize\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_DROP_OVERSIZE], memory_order_relaxed));
+    metrics_printf(w, "espnow_rx_dropped_total{reason=\"pool_exhausted\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_DROP_POOL], memory_order_relaxed));
+    metrics_printf(w, "espnow_rx_dropped_total{reason=\"queue_full\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_DROP_QUEUE], memory_order_relaxed));
+    metrics_printf(w, "# HELP espnow_rx_rejected_total Frames espnow_task discarded as malformed\n"
+                      "# TYPE espnow_rx_rejected_total counter\n");
+    metrics_printf(w, "espnow_rx_rejected_total{reason=\"short\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_SHORT], memory_order_relaxed));
+    metrics_printf(w, "espnow_rx_rejected_total{reason=\"length\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_BAD_LEN], memory_order_relaxed));
+    metrics_printf(w, "espnow_rx_rejected_total{reason=\"crc\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_RX_CRC_FAIL], memory_order_relaxed));
+    COUNTER(w, METRIC_RX_CRC_LEGACY, "espnow_rx_legacy_crc_total", "Frames accepted with a whole-frame CRC");
+    COUNTER(w, METRIC_RX_DUPLICATE, "espnow_rx_duplicates_total", "Gate and telemetry frames dropped as sequence duplicates");
+    COUNTER(w, METRIC_RX_STALE, "espnow_rx_stale_total", "Gate and telemetry frames dropped as far outside the sequence window");
+
+    metrics_printf(w, "# HELP espnow_rx_messages_total Received frames by message type\n"
+                      "# TYPE espnow_rx_messages_total counter\n");
+    for (int t = 0; t < METRICS_MSG_TYPES; t++) {
+        metrics_printf(w, "espnow_rx_messages_total{type=\"%s\"} %u\n", msg_type_names[t],
+                       atomic_load_explicit(&metrics_msg_types[t], memory_order_relaxed));
+    }
+
+    metrics_printf(w, "# HELP espnow_tx_callbacks_total Send callback results\n"
+                      "# TYPE espnow_tx_callbacks_total counter\n");
+    metrics_printf(w, "espnow_tx_callbacks_total{status=\"ok\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_TX_CB_OK], memory_order_relaxed));
+    metrics_printf(w, "espnow_tx_callbacks_total{status=\"fail\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_TX_CB_FAIL], memory_order_relaxed));
+    COUNTER(w, METRIC_TX_QUEUE_DROP, "espnow_tx_events_dropped_total", "Send callback events lost to a full queue");
+    COUNTER(w, METRIC_TX_FRAMES, "espnow_tx_frames_total", "Frames accepted by esp_now_send");
+    COUNTER(w, METRIC_TX_BYTES, "espnow_tx_bytes_total", "ESP-NOW payload bytes sent");
+    metrics_printf(w, "# HELP espnow_tx_airtime_us_total Estimated air time of sent frames at 1 Mbps, microseconds\n"
+                      "# TYPE espnow_tx_airtime_us_total counter\n");
+    metrics_printf(w, "espnow_tx_airtime_us_total{framing=\"variable\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_TX_AIRTIME_US], memory_order_relaxed));
+    metrics_printf(w, "espnow_tx_airtime_us_total{framing=\"fixed\"} %u\n",
+                   atomic_load_explicit(&metrics_counters[METRIC_TX_AIRTIME_FIXED_US], memory_order_relaxed));
+
+    metrics_write_hist(w, "espnow_rx_latency_us", "Receive callback to espnow_task dequeue, microseconds",
+                       NULL, &metrics_rx_latency_us);
+    metrics_write_hist(w, "espnow_rx_process_us", "espnow_task handling time per received frame, microseconds",
+                       NULL, &metrics_rx_process_us);
+    metrics_write_hist(w, "espnow_rx_queue_depth", "s_espnow_queue depth when a frame is enqueued",
+                       NULL, &metrics_rx_queue_depth);
+
+    COUNTER(w, METRIC_HTTP_BYTES_SENT, "http_sent_bytes_total", "Bytes written to HTTP and WebSocket sockets");
+}
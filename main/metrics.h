@@ -0,0 +1,110 @@
+#ifndef ESP32_RECEIVER_METRICS_H
+#define ESP32_RECEIVER_METRICS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Lock-free counters and log2 histograms for the receive pipeline. Every
+// update is a single relaxed 32-bit atomic add, so any task or callback can
+// record without taking a lock. Counters and histogram sums are 32-bit and
+// wrap; Prometheus treats the wrap as a counter reset.
+
+typedef enum {
+    METRIC_RX_FRAMES,          // frames handed to espnow_recv_cb
+    METRIC_RX_DROP_OVERSIZE,   // longer than espnow_data_t
+    METRIC_RX_DROP_POOL,       // packet pool exhausted
+    METRIC_RX_DROP_QUEUE,      // s_espnow_queue full
+    METRIC_RX_SHORT,           // shorter than the frame header
+    METRIC_RX_BAD_LEN,         // len field past data[] or the received bytes
+    METRIC_RX_CRC_FAIL,        // rejected by espnow_frame_check
+    METRIC_RX_CRC_LEGACY,      // accepted with a whole-frame CRC
+    METRIC_RX_DUPLICATE,       // sequence number already seen from that peer
+    METRIC_RX_STALE,           // sequence number from an older run of that peer
+    METRIC_TX_FRAMES,          // frames accepted by esp_now_send
+    METRIC_TX_BYTES,
+    METRIC_TX_AIRTIME_US,      // estimated, see metrics_airtime_us()
+    METRIC_TX_AIRTIME_FIXED_US, // the same frames sent at full struct size
+    METRIC_TX_CB_OK,
+    METRIC_TX_CB_FAIL,         // send callback reported failure
+    METRIC_TX_QUEUE_DROP,      // send callback could not queue its event
+    METRIC_HTTP_BYTES_SENT,    // bytes written to HTTP/WS sockets
+    METRIC_COUNTER_MAX,
+} metric_counter_t;
+
+#define METRICS_MSG_TYPES 9    // espnow_msg_type_t values; the last slot counts unknown types
+
+// Bucket i counts values in [2^(i-1), 2^i); bucket 0 counts zero. The
+// rendered "le" bounds are therefore 0, 1, 3, 7, ... 2^i - 1.
+#define METRICS_HIST_BUCKETS 18
+
+typedef struct {
+    atomic_uint buckets[METRICS_HIST_BUCKETS];  // last bucket is +Inf
+    atomic_uint count;
+    atomic_uint sum;
+} metrics_hist_t;
+
+extern atomic_uint metrics_counters[METRIC_COUNTER_MAX];
+extern atomic_uint metrics_msg_types[METRICS_MSG_TYPES];
+
+extern metrics_hist_t metrics_rx_latency_us;   // recv callback -> espnow_task dequeue
+extern metrics_hist_t metrics_rx_process_us;   // espnow_task time per received frame
+extern metrics_hist_t metrics_rx_queue_depth;  // s_espnow_queue depth seen at enqueue
+
+static inline void metrics_add(metric_counter_t c, uint32_t n) {
+    atomic_fetch_add_explicit(&metrics_counters[c], n, memory_order_relaxed);
+}
+
+static inline void metrics_inc(metric_counter_t c) {
+    metrics_add(c, 1);
+}
+
+// Estimated air time of one ESP-NOW frame at the default 1 Mbps rate: the
+// 192 µs long preamble and PLCP header, then 8 µs per byte of 802.11 header,
+// action/vendor element framing and FCS (43 bytes) plus the payload.
+static inline uint32_t metrics_airtime_us(size_t len) {
+    return 192 + (uint32_t)(43 + len) * 8;
+}
+
+// fixed_len: what the frame used to cost, so the counters show the saving.
+static inline void metrics_tx_frame(size_t len, size_t fixed_len) {
+    metrics_inc(METRIC_TX_FRAMES);
+    metrics_add(METRIC_TX_BYTES, (uint32_t)len);
+    metrics_add(METRIC_TX_AIRTIME_US, metrics_airtime_us(len));
+    metrics_add(METRIC_TX_AIRTIME_FIXED_US, metrics_airtime_us(fixed_len));
+}
+
+static inline void metrics_count_type(int type) {
+    if (type < 0 || type >= METRICS_MSG_TYPES - 1) type = METRICS_MSG_TYPES - 1;
+    atomic_fetch_add_explicit(&metrics_msg_types[type], 1, memory_order_relaxed);
+}
+
+static inline void metrics_observe(metrics_hist_t *h, uint32_t v) {
+    int b = v ? 32 - __builtin_clz(v) : 0;
+    if (b >= METRICS_HIST_BUCKETS) b = METRICS_HIST_BUCKETS - 1;
+    atomic_fetch_add_explicit(&h->buckets[b], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, v, memory_order_relaxed);
+}
+
+// Buffered text writer for the /metrics body. Flushes to the request as
+// chunks whenever the buffer fills.
+typedef struct {
+    httpd_req_t *req;
+    char *buf;
+    size_t len;
+    size_t pos;
+} metrics_writer_t;
+
+void metrics_printf(metrics_writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void metrics_write_counter(metrics_writer_t *w, const char *name, const char *help, uint32_t value);
+void metrics_write_gauge(metrics_writer_t *w, const char *name, const char *help, int64_t value);
+// labels may be NULL or e.g. "uri=\"/timing\""; HELP/TYPE are written only when help != NULL.
+void metrics_write_hist(metrics_writer_t *w, const char *name, const char *help,
+                        const char *labels, const metrics_hist_t *h);
+// Writes the pipeline counters and histograms declared above.
+void metrics_write_pipeline(metrics_writer_t *w);
+esp_err_t metrics_flush(metrics_writer_t *w);
+
+#endif //ESP32_RECEIVER_METRICS_H
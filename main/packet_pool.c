@@ -0,0 +1,71 @@
+#include "packet_pool.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Single-producer / single-consumer pool of receive slots. The free list is a
+// ring of slot indices: espnow_task pushes at head, the receive callback pops
+// at tail. Each index is only written by one side, so no lock is needed.
+
+#define FREE_RING_SIZE 32   // power of two, >= PACKET_POOL_SIZE
+#define FREE_RING_MASK (FREE_RING_SIZE - 1)
+
+_Static_assert((FREE_RING_SIZE & FREE_RING_MASK) == 0, "FREE_RING_SIZE must be a power of two");
+_Static_assert(FREE_RING_SIZE >= PACKET_POOL_SIZE, "FREE_RING_SIZE too small");
+
+static espnow_data_t slots[PACKET_POOL_SIZE];
+static uint8_t free_ring[FREE_RING_SIZE];
+static atomic_uint free_head;   // written by consumer
+static atomic_uint free_tail;   // written by producer
+
+// Slot the producer took but could not enqueue; reused on its next take.
+static espnow_data_t *spare;
+
+static atomic_uint stat_taken;
+static atomic_uint stat_returned;
+static atomic_uint stat_exhausted;
+
+void packet_pool_init(void) {
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) free_ring[i] = (uint8_t)i;
+    atomic_store(&free_tail, 0);
+    atomic_store(&free_head, PACKET_POOL_SIZE);
+    spare = NULL;
+}
+
+espnow_data_t *packet_pool_take(void) {
+    if (spare != NULL) {
+        espnow_data_t *pkt = spare;
+        spare = NULL;
+        return pkt;
+    }
+
+    unsigned tail = atomic_load_explicit(&free_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&free_head, memory_order_acquire);
+    if (tail == head) {
+        atomic_fetch_add_explicit(&stat_exhausted, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    uint8_t idx = free_ring[tail & FREE_RING_MASK];
+    atomic_store_explicit(&free_tail, tail + 1, memory_order_release);
+    atomic_fetch_add_explicit(&stat_taken, 1, memory_order_relaxed);
+    return &slots[idx];
+}
+
+void packet_pool_unget(espnow_data_t *pkt) {
+    spare = pkt;
+}
+
+void packet_pool_give(espnow_data_t *pkt) {
+    if (pkt == NULL) return;
+
+    unsigned head = atomic_load_explicit(&free_head, memory_order_relaxed);
+    free_ring[head & FREE_RING_MASK] = (uint8_t)(pkt - slots);
+    atomic_store_explicit(&free_head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&stat_returned, 1, memory_order_relaxed);
+}
+
+void packet_pool_get_stats(packet_pool_stats_t *out) {
+    out->taken     = atomic_load_explicit(&stat_taken, memory_order_relaxed);
+    out->returned  = atomic_load_explicit(&stat_returned, memory_order_relaxed);
+    out->exhausted = atomic_load_explicit(&stat_exhausted, memory_order_relaxed);
+}
@@ -0,0 +1,28 @@
+#ifndef ESP32_RECEIVER_PACKET_POOL_H
+#define ESP32_RECEIVER_PACKET_POOL_H
+
+#include <stdint.h>
+#include "protocol.h"
+
+// Must exceed the ESP-NOW event queue depth so a full queue, not an empty
+// pool, is what throttles the receive callback.
+#define PACKET_POOL_SIZE 32
+
+typedef struct {
+    uint32_t taken;     // slots handed out to the receive callback
+    uint32_t returned;  // slots given back by espnow_task
+    uint32_t exhausted; // frames dropped because every slot was in flight
+} packet_pool_stats_t;
+
+void packet_pool_init(void);
+
+// Producer side — only called from espnow_recv_cb (Wi-Fi task).
+espnow_data_t *packet_pool_take(void);
+void packet_pool_unget(espnow_data_t *pkt);
+
+// Consumer side — only called from espnow_task.
+void packet_pool_give(espnow_data_t *pkt);
+
+void packet_pool_get_stats(packet_pool_stats_t *out);
+
+#endif //ESP32_RECEIVER_PACKET_POOL_H
@@ -0,0 +1,212 @@
+#include "peers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "peers";
+
+#define PEER_INDEX_MASK (PEER_INDEX_SIZE - 1)
+
+_Static_assert((PEER_INDEX_SIZE & PEER_INDEX_MASK) == 0, "PEER_INDEX_SIZE must be a power of two");
+_Static_assert(PEER_INDEX_SIZE >= 2 * PEER_MAX, "PEER_INDEX_SIZE too small");
+_Static_assert(PEER_MAX < UINT8_MAX, "index slots hold record number + 1 in a byte");
+
+static peer_t peers[PEER_MAX];
+static _Atomic uint8_t index_slots[PEER_INDEX_SIZE];   // 0 = empty, else record + 1
+static atomic_int count;
+static SemaphoreHandle_t insert_lock;
+
+#define PEERS_NVS_NAMESPACE "peers"
+#define PEERS_NVS_KEY_DEPTH "gate_depth"
+
+static gate_sample_t *history_arena;
+static uint32_t history_depth;
+static uint32_t history_depth_configured;
+
+static inline uint64_t mac_key(const uint8_t *mac) {
+    return ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) | ((uint64_t)mac[2] << 24) |
+           ((uint64_t)mac[3] << 16) | ((uint64_t)mac[4] << 8) | mac[5];
+}
+
+_Static_assert(PEER_INDEX_SIZE == 64, "mac_slot shift assumes 64 slots");
+
+// Fibonacci hashing: the top bits of key * 2^64/phi spread sequential MACs
+// from one vendor across the table.
+static inline unsigned mac_slot(uint64_t key) {
+    return (unsigned)((key * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
+static uint32_t clamp_depth(uint32_t depth) {
+    if (depth < PEER_GATE_HISTORY_MIN) return PEER_GATE_HISTORY_MIN;
+    if (depth > PEER_GATE_HISTORY_MAX) return PEER_GATE_HISTORY_MAX;
+    return depth;
+}
+
+static uint32_t load_history_depth(void) {
+    uint16_t depth = PEER_GATE_HISTORY_DEFAULT;
+    nvs_handle_t nvs;
+    if (nvs_open(PEERS_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        nvs_get_u16(nvs, PEERS_NVS_KEY_DEPTH, &depth);
+        nvs_close(nvs);
+    }
+    return clamp_depth(depth);
+}
+
+// Deepest ring every peer can have within the arena budget.
+static uint32_t budget_depth(void) {
+    size_t free_bytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t budget = free_bytes > PEER_GATE_HISTORY_HEAP_RESERVE ? free_bytes - PEER_GATE_HISTORY_HEAP_RESERVE : 0;
+    if (budget > PEER_GATE_HISTORY_ARENA_MAX) budget = PEER_GATE_HISTORY_ARENA_MAX;
+    return clamp_depth((uint32_t)(budget / (PEER_MAX * sizeof(gate_sample_t))));
+}
+
+void peers_init(void) {
+    insert_lock = xSemaphoreCreateMutex();
+
+    history_depth_configured = load_history_depth();
+    history_depth = history_depth_configured;
+    uint32_t fit = budget_depth();
+    if (history_depth > fit) history_depth = fit;
+
+    // One allocation for every ring; shrink further if the heap is fragmented.
+    for (; history_depth >= PEER_GATE_HISTORY_MIN; history_depth /= 2) {
+        history_arena = calloc((size_t)PEER_MAX * history_depth, sizeof(gate_sample_t));
+        if (history_arena != NULL) break;
+    }
+    if (history_arena == NULL) {
+        ESP_LOGE(TAG, "No memory for gate history");
+        history_depth = 0;
+    } else if (history_depth != history_depth_configured) {
+        ESP_LOGW(TAG, "Gate history depth %lu exceeds the heap budget, using %lu",
+                 (unsigned long)history_depth_configured, (unsigned long)history_depth);
+    }
+
+    for (int i = 0; i < PEER_MAX; i++) {
+        peers[i].timing.ring = history_arena ? &history_arena[(size_t)i * history_depth] : NULL;
+        peers[i].timing.capacity = history_depth;
+    }
+    ESP_LOGI(TAG, "Gate history: %lu triggers per peer (%u bytes)", (unsigned long)history_depth,
+             (unsigned)(PEER_MAX * history_depth * sizeof(gate_sample_t)));
+}
+
+uint32_t peers_history_depth(void) {
+    return history_depth;
+}
+
+uint32_t peers_history_depth_configured(void) {
+    return history_depth_configured;
+}
+
+esp_err_t peers_set_history_depth(uint32_t depth) {
+    depth = clamp_depth(depth);
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(PEERS_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    err = nvs_set_u16(nvs, PEERS_NVS_KEY_DEPTH, (uint16_t)depth);
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    if (err == ESP_OK) history_depth_configured = depth;
+    return err;
+}
+
+void gate_iter_begin(gate_iter_t *it, gate_timing_t *t) {
+    unsigned seq;
+    do {
+        seq = seqlock_read_begin(&t->lock);
+        it->end = t->head;
+        it->next = t->head - (uint32_t)t->count;
+    } while (seqlock_read_retry(&t->lock, seq));
+    it->t = t;
+}
+
+bool gate_iter_next(gate_iter_t *it, gate_sample_t *out, uint32_t *index) {
+    gate_timing_t *t = it->t;
+    while (it->next != it->end) {
+        uint32_t k = it->next++;
+        bool live;
+        unsigned seq;
+        do {
+            seq = seqlock_read_begin(&t->lock);
+            live = t->head - k <= t->capacity;
+            if (live) *out = t->ring[k % t->capacity];
+        } while (seqlock_read_retry(&t->lock, seq));
+        if (live) {
+            if (index) *index = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+static peer_t *lookup(uint64_t key, unsigned *empty_slot) {
+    for (unsigned i = mac_slot(key), n = 0; n < PEER_INDEX_SIZE; i = (i + 1) & PEER_INDEX_MASK, n++) {
+        uint8_t r = atomic_load_explicit(&index_slots[i], memory_order_acquire);
+        if (r == 0) {
+            if (empty_slot) *empty_slot = i;
+            return NULL;
+        }
+        if (mac_key(peers[r - 1].mac) == key) return &peers[r - 1];
+    }
+    return NULL;
+}
+
+peer_t *peer_find(const uint8_t *mac) {
+    return lookup(mac_key(mac), NULL);
+}
+
+peer_t *peer_get_or_add(const uint8_t *mac) {
+    uint64_t key = mac_key(mac);
+    peer_t *p = lookup(key, NULL);
+    if (p != NULL) return p;
+
+    xSemaphoreTake(insert_lock, portMAX_DELAY);
+    unsigned slot = 0;
+    p = lookup(key, &slot);   // another task may have added it meanwhile
+    if (p == NULL) {
+        int n = atomic_load_explicit(&count, memory_order_relaxed);
+        if (n >= PEER_MAX) {
+            xSemaphoreGive(insert_lock);
+            ESP_LOGW(TAG, "Peer table full, ignoring " MACSTR, MAC2STR(mac));
+            return NULL;
+        }
+
+        p = &peers[n];
+        memcpy(p->mac, mac, ESP_NOW_ETH_ALEN);
+        snprintf(p->mac_str, sizeof(p->mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        p->config.mode = GATE_MODE_DELTA;
+        p->config.order = n;
+        atomic_store_explicit(&index_slots[slot], (uint8_t)(n + 1), memory_order_release);
+        atomic_store_explicit(&count, n + 1, memory_order_release);
+        ESP_LOGI(TAG, "New peer %s (total: %d)", p->mac_str, n + 1);
+    }
+    xSemaphoreGive(insert_lock);
+    return p;
+}
+
+int peer_count(void) {
+    return atomic_load_explicit(&count, memory_order_acquire);
+}
+
+peer_t *peer_at(int i) {
+    return &peers[i];
+}
+
+int peer_index(const peer_t *p) {
+    return (int)(p - peers);
+}
+
+bool peer_parse_mac(const char *str, uint8_t *mac) {
+    unsigned int b[6];
+    if (sscanf(str, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) mac[i] = (uint8_t)b[i];
+    return true;
+}
@@ -0,0 +1,287 @@
+#ifndef ESP32_RECEIVER_PEERS_H
+#define ESP32_RECEIVER_PEERS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_now.h"
+#include "protocol.h"
+#include "seqlock.h"
+
+// Every ESP-NOW device the receiver has heard from, keyed by its 6-byte MAC.
+// Records live in a dense array in first-seen order and are never removed;
+// an open-addressed index maps the MAC (as a 48-bit integer) to its record.
+//
+// Lookups are lock-free. Inserts take a mutex because both espnow_task and
+// the httpd task (POST /gate-config) can add peers. A record is fully
+// initialised before its index slot and the published count are stored.
+
+#define PEER_MAX 32
+#define PEER_INDEX_SIZE 64        // power of two, >= 2 * PEER_MAX
+
+// Gate trigger history per peer. The depth is read from NVS at boot (set via
+// POST /timing/depth) and every peer's ring is carved from one arena of
+// PEER_MAX * depth samples, so a changed depth applies after a restart.
+#define PEER_GATE_HISTORY_DEFAULT 50
+#define PEER_GATE_HISTORY_MIN 8
+#define PEER_GATE_HISTORY_MAX 2048
+// The arena is taken before telemetry, history and httpd allocate, so it is
+// limited to ARENA_MAX bytes and never leaves less than HEAP_RESERVE free;
+// the depth in use is clamped to fit.
+#define PEER_GATE_HISTORY_ARENA_MAX (128 * 1024)
+#define PEER_GATE_HISTORY_HEAP_RESERVE (128 * 1024)
+
+// peer_t.flags
+#define PEER_F_LISTED  (1u << 0)  // answered an ACK/ping; included in ping rounds and /gates
+#define PEER_F_CONFIG  (1u << 1)  // has a gate config from /gate-config
+
+typedef enum {
+    GATE_MODE_DELTA,   // standalone delta timer
+    GATE_MODE_SERIES,  // part of a sequential track/series
+} gate_mode_t;
+
+typedef struct {
+    gate_mode_t mode;
+    char group[32];      // group/series name (empty = ungrouped)
+    int order;           // sort order within group
+} gate_config_t;
+
+typedef struct {
+    int64_t timestamp_us;     // absolute µs (esp_timer_get_time)
+    int64_t diff_us;          // delta from previous trigger for this gate
+} gate_sample_t;
+
+// Written only by espnow_task; readers go through the seqlock.
+typedef struct {
+    seqlock_t lock;
+    gate_sample_t *ring;      // capacity samples from the peers arena
+    uint32_t capacity;
+    uint32_t head;            // triggers recorded so far; trigger k is ring[k % capacity]
+    int count;                // triggers still held, min(head, capacity)
+    bool stuck;
+    uint32_t version;         // state_version of the last change
+} gate_timing_t;
+
+// In-order walk over a gate's history that reads each sample in place.
+// Samples overwritten by the writer during the walk are skipped.
+typedef struct {
+    gate_timing_t *t;
+    uint32_t next;            // absolute trigger index
+    uint32_t end;
+} gate_iter_t;
+
+// Frame integrity per sender. Counters only grow; readers on other tasks
+// may see them one frame apart from each other.
+#define PEER_RX_WINDOW 256
+
+typedef struct {
+    uint32_t frames;              // every frame received from the peer
+    uint32_t crc_errors;          // rejected by espnow_frame_check
+    uint32_t legacy_crc;          // accepted with a whole-frame CRC
+    uint32_t len_errors;          // len field disagreed with the frame size
+    uint16_t window_frames;
+    uint16_t window_errors;
+    uint16_t recent_error_permille; // CRC errors over the last full window
+} peer_rx_stats_t;
+
+static inline void peer_rx_count(peer_rx_stats_t *rx, espnow_frame_status_t status) {
+    rx->frames++;
+    rx->window_frames++;
+    if (status == ESPNOW_FRAME_BAD_CRC) {
+        rx->crc_errors++;
+        rx->window_errors++;
+    } else if (status == ESPNOW_FRAME_OK_LEGACY) {
+        rx->legacy_crc++;
+    } else if (status == ESPNOW_FRAME_BAD_LEN) {
+        rx->len_errors++;
+    }
+    if (rx->window_frames == PEER_RX_WINDOW) {
+        rx->recent_error_permille = (uint16_t)(rx->window_errors * 1000u / PEER_RX_WINDOW);
+        rx->window_frames = rx->window_errors = 0;
+    }
+}
+
+// Sequence tracking per sender and message class, with a sliding window
+// of the last PEER_SEQ_WINDOW numbers below the highest seen (the IPsec
+// anti-replay scheme). A number in the window that was already seen is a
+// duplicate, e.g. a gate request retransmitted because our OK was lost,
+// and is not applied twice. One that fills an earlier gap counts as
+// reordered instead of lost.
+//
+// The wire format has no boot counter, so a sender restarting its counter
+// is inferred. After PEER_SEQ_IDLE_MS without a frame, a number at or below
+// the highest, or PEER_SEQ_MAX_JUMP or more ahead, is a restart: a gate
+// power-cycled after a handful of triggers counts from 0 again inside the
+// old window, and a retransmit never comes that long after the original.
+// Without the idle gap, a number older than the window or that far ahead
+// is stale and dropped; it becomes a restart only when the next frame
+// follows on from it, so one frame from an old run cannot re-anchor the
+// tracker. Nothing is counted as lost across a restart. Frames from before
+// a restart that arrive late are applied, but they were never counted as
+// lost, so they do not count as reordered either.
+#define PEER_SEQ_WINDOW 64
+#define PEER_SEQ_MAX_JUMP 1024
+#define PEER_SEQ_IDLE_MS 2000
+
+typedef enum {
+    PEER_SEQ_NEW,         // ahead of everything seen; apply
+    PEER_SEQ_LATE,        // inside the window, not seen before; apply
+    PEER_SEQ_DUPLICATE,   // already seen; drop
+    PEER_SEQ_STALE,       // far outside the window, no restart yet; drop
+    PEER_SEQ_RESTART,     // tracker reset on this frame; apply
+} peer_seq_result_t;
+
+typedef struct {
+    uint64_t window;              // bit i: highest - i was seen
+    uint16_t highest;
+    uint16_t tracked;             // numbers below highest seen since the restart, up to the window
+    uint16_t stale_seq;           // last stale number, valid while stale_pending
+    bool stale_pending;
+    bool started;
+    uint32_t last_ms;             // arrival of the previous frame
+    uint32_t accepted;
+    uint32_t duplicates;
+    uint32_t stale;
+    uint32_t reordered;
+    uint32_t lost;                // gaps not filled by a late frame
+    uint32_t restarts;
+    uint16_t window_expected;     // numbers spanned since the last loss sample
+    uint16_t window_lost;
+    uint16_t recent_loss_permille; // loss over the last PEER_RX_WINDOW numbers
+} peer_seq_t;
+
+static inline void peer_seq_window_close(peer_seq_t *s) {
+    if (s->window_expected < PEER_RX_WINDOW) return;
+    uint32_t lost = s->window_lost < s->window_expected ? s->window_lost : s->window_expected;
+    s->recent_loss_permille = (uint16_t)(lost * 1000u / s->window_expected);
+    s->window_expected = s->window_lost = 0;
+}
+
+static inline peer_seq_result_t peer_seq_restart(peer_seq_t *s, uint16_t seq) {
+    if (s->started) s->restarts++;
+    s->started = true;
+    s->stale_pending = false;
+    s->highest = seq;
+    s->window = 1;
+    s->tracked = 0;
+    s->accepted++;
+    return PEER_SEQ_RESTART;
+}
+
+// now_ms is the frame's arrival time; only differences are used, so it may wrap.
+static inline peer_seq_result_t peer_seq_check(peer_seq_t *s, uint16_t seq, uint32_t now_ms) {
+    int16_t diff = (int16_t)(seq - s->highest);
+    bool idle = now_ms - s->last_ms >= PEER_SEQ_IDLE_MS;
+    bool far = diff >= PEER_SEQ_MAX_JUMP || diff <= -PEER_SEQ_WINDOW;
+    s->last_ms = now_ms;
+
+    if (!s->started || (idle && (diff <= 0 || far))) return peer_seq_restart(s, seq);
+    if (far) {
+        if (s->stale_pending && (uint16_t)(seq - s->stale_seq - 1) < PEER_SEQ_WINDOW) {
+            return peer_seq_restart(s, seq);
+        }
+        s->stale_seq = seq;
+        s->stale_pending = true;
+        s->stale++;
+        return PEER_SEQ_STALE;
+    }
+    s->stale_pending = false;
+
+    if (diff > 0) {
+        s->window = diff < PEER_SEQ_WINDOW ? (s->window << diff) | 1 : 1;
+        s->highest = seq;
+        s->tracked = s->tracked + diff < PEER_SEQ_WINDOW ? s->tracked + diff : PEER_SEQ_WINDOW;
+        s->lost += diff - 1;
+        s->window_lost += diff - 1;
+        s->window_expected += diff;
+        s->accepted++;
+        peer_seq_window_close(s);
+        return PEER_SEQ_NEW;
+    }
+
+    uint64_t bit = (uint64_t)1 << -diff;   // diff == 0 gives bit 0, the highest itself
+    if (s->window & bit) {
+        s->duplicates++;
+        return PEER_SEQ_DUPLICATE;
+    }
+    s->window |= bit;
+    s->accepted++;
+    if (-diff > s->tracked) return PEER_SEQ_LATE;   // from before the restart
+    s->reordered++;
+    if (s->lost) s->lost--;
+    if (s->window_lost) s->window_lost--;
+    return PEER_SEQ_LATE;
+}
+
+// Frames the caller should not apply.
+static inline bool peer_seq_drop(peer_seq_result_t r) {
+    return r == PEER_SEQ_DUPLICATE || r == PEER_SEQ_STALE;
+}
+
+// Permille of sequence numbers never received since the tracker started.
+static inline uint32_t peer_seq_loss_permille(const peer_seq_t *s) {
+    uint32_t expected = s->accepted + s->lost;
+    return expected ? (uint32_t)((uint64_t)s->lost * 1000 / expected) : 0;
+}
+
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    char mac_str[18];             // "aa:bb:cc:dd:ee:ff", fixed at insert
+    atomic_uint flags;
+    int64_t last_ping_us;         // espnow_task
+    peer_rx_stats_t rx;           // espnow_task
+    peer_seq_t gate_seq;          // espnow_task: gate requests
+    peer_seq_t telemetry_seq;     // espnow_task
+    gate_timing_t timing;         // espnow_task
+    gate_config_t config;         // httpd task
+} peer_t;
+
+void peers_init(void);
+
+// Gate history depth in use since boot (after the heap clamp), and the one
+// stored for the next boot.
+uint32_t peers_history_depth(void);
+uint32_t peers_history_depth_configured(void);
+esp_err_t peers_set_history_depth(uint32_t depth);
+
+peer_t *peer_find(const uint8_t *mac);
+peer_t *peer_get_or_add(const uint8_t *mac);   // NULL when the table is full
+
+// Records [0, peer_count()) are safe to read from any task.
+int peer_count(void);
+peer_t *peer_at(int i);
+int peer_index(const peer_t *p);      // inverse of peer_at
+
+static inline bool peer_has(const peer_t *p, unsigned flag) {
+    return (atomic_load_explicit(&p->flags, memory_order_acquire) & flag) != 0;
+}
+
+// Returns true if the flag was newly set.
+static inline bool peer_set(peer_t *p, unsigned flag) {
+    return (atomic_fetch_or_explicit(&p->flags, flag, memory_order_release) & flag) == 0;
+}
+
+// espnow_task only, inside seqlock_write_begin/end.
+static inline void gate_timing_push(gate_timing_t *t, int64_t timestamp_us, int64_t diff_us) {
+    if (t->capacity == 0) return;
+    gate_sample_t *s = &t->ring[t->head % t->capacity];
+    s->timestamp_us = timestamp_us;
+    s->diff_us = diff_us;
+    t->head++;
+    if ((uint32_t)t->count < t->capacity) t->count++;
+}
+
+// Most recent sample; the caller holds the seqlock or is the writer.
+static inline gate_sample_t gate_timing_latest(const gate_timing_t *t) {
+    if (t->count == 0) return (gate_sample_t){ 0, 0 };
+    return t->ring[(t->head - 1) % t->capacity];
+}
+
+void gate_iter_begin(gate_iter_t *it, gate_timing_t *t);
+// Returns false at the end; *index is the trigger's number since boot.
+bool gate_iter_next(gate_iter_t *it, gate_sample_t *out, uint32_t *index);
+
+// Accepts "aa:bb:cc:dd:ee:ff" in either case.
+bool peer_parse_mac(const char *str, uint8_t *mac);
+
+#endif //ESP32_RECEIVER_PEERS_H
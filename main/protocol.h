@@ -0,0 +1,101 @@
+#ifndef ESP32_RECEIVER_PROTOCOL_H
+#define ESP32_RECEIVER_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ESP-NOW wire format shared with the gates and the car. Plain C only, so
+// the decode modules (telemetry, history, packet_pool) do not depend on
+// ESP-IDF headers.
+
+typedef enum {
+    ESPNOW_DATA_ACK,
+    ESPNOW_DATA_REQUEST,
+    ESPNOW_DATA_PING,
+    ESPNOW_GATE_IDENT,
+    ESPNOW_DATA_OK,
+    ESPNOW_TELEMETRY,
+    ESPNOW_SET_LOGGER_NAME,
+    ESPNOW_GATE_STUCK,
+} espnow_msg_type_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  type;
+    uint16_t seq_num;
+    uint16_t crc;
+    uint8_t  len;
+    uint8_t  data[200];
+} espnow_data_t;
+
+#define ESPNOW_HEADER_LEN offsetof(espnow_data_t, data)
+
+// Frames go on air as the header plus len payload bytes; receivers take
+// anything from that up to sizeof(espnow_data_t).
+static inline size_t espnow_frame_len(const espnow_data_t *f) {
+    return ESPNOW_HEADER_LEN + f->len;
+}
+
+// Frame CRC: CRC-16 with the reflected 0x1021 polynomial, inverted on entry
+// and exit (the same result as esp_crc16_le), seeded with UINT16_MAX and
+// computed over the header with crc taken as 0 followed by data[0, len).
+//
+// Older senders transmit and CRC the whole espnow_data_t, whatever len is;
+// espnow_frame_check() accepts those as ESPNOW_FRAME_OK_LEGACY.
+typedef enum {
+    ESPNOW_FRAME_OK,
+    ESPNOW_FRAME_OK_LEGACY,   // CRC covers every received byte
+    ESPNOW_FRAME_SHORT,       // shorter than the header
+    ESPNOW_FRAME_BAD_LEN,     // len runs past data[] or the received bytes
+    ESPNOW_FRAME_BAD_CRC,
+} espnow_frame_status_t;
+
+// Table-driven, one lookup per byte; chainable like esp_crc16_le.
+uint16_t protocol_crc16_le(uint16_t crc, const uint8_t *buf, size_t len);
+
+// CRC of the first `span` bytes of f with the crc field taken as 0.
+uint16_t espnow_frame_crc(const espnow_data_t *f, size_t span);
+
+// Sets f->crc over the header and f->len payload bytes.
+void espnow_frame_seal(espnow_data_t *f);
+
+espnow_frame_status_t espnow_frame_check(const espnow_data_t *f, size_t received);
+
+// Telemetry payload layout: segment s occupies data[offset, offset + len)
+// and is made of telemetry_fields[first_field, first_field + field_count).
+// Both tables are generated from tools/telemetry_schema.json into
+// telemetry_schema.c.
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    uint8_t offset;
+    const char* name;
+    uint8_t first_field;
+    uint8_t field_count;
+} segment_t;
+extern const segment_t segments[];
+extern const int NUM_SEGMENTS;
+
+typedef enum {
+    TELEMETRY_U8,
+    TELEMETRY_U16,
+    TELEMETRY_I16,
+} telemetry_type_t;
+
+// One value inside a segment. Displayed as raw * scale_num / scale_den,
+// rounded to `decimals` places, or as labels[min(raw, label_count - 1)]
+// when label_count is non-zero.
+typedef struct {
+    const char* name;
+    const char* unit;            // "" when unitless
+    const char* series;          // history channel key, NULL if not recorded
+    const char* const* labels;
+    uint8_t label_count;
+    uint8_t offset;              // absolute payload offset
+    uint8_t type;                // telemetry_type_t
+    uint8_t big_endian;
+    uint8_t decimals;
+    int32_t scale_num;
+    int32_t scale_den;
+} telemetry_field_t;
+
+#endif //ESP32_RECEIVER_PROTOCOL_H
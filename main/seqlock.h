@@ -0,0 +1,49 @@
+#ifndef ESP32_RECEIVER_SEQLOCK_H
+#define ESP32_RECEIVER_SEQLOCK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Single-writer sequence lock. The writer never waits; readers copy the
+// protected data and retry if the sequence moved underneath them. An odd
+// sequence means a write is in progress.
+
+typedef struct {
+    atomic_uint seq;
+} seqlock_t;
+
+#define SEQLOCK_SPINS_BEFORE_YIELD 64
+
+static inline void seqlock_write_begin(seqlock_t *l) {
+    unsigned s = atomic_load_explicit(&l->seq, memory_order_relaxed);
+    atomic_store_explicit(&l->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_end(seqlock_t *l) {
+    unsigned s = atomic_load_explicit(&l->seq, memory_order_relaxed);
+    atomic_store_explicit(&l->seq, s + 1, memory_order_release);
+}
+
+static inline unsigned seqlock_read_begin(seqlock_t *l) {
+    int spins = 0;
+    unsigned s;
+    while ((s = atomic_load_explicit(&l->seq, memory_order_acquire)) & 1) {
+        // The writer may be a lower-priority task on this core; give it
+        // the CPU rather than spinning it out.
+        if (++spins >= SEQLOCK_SPINS_BEFORE_YIELD) {
+            vTaskDelay(1);
+            spins = 0;
+        }
+    }
+    return s;
+}
+
+static inline bool seqlock_read_retry(seqlock_t *l, unsigned start) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&l->seq, memory_order_relaxed) != start;
+}
+
+#endif //ESP32_RECEIVER_SEQLOCK_H
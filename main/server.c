@@ -6,7 +6,26 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "hash.h"
+#include "seqlock.h"
+#include "stream.h"
+#include "telemetry.h"
+#include "history.h"
+#include "flash_log.h"
+#include "metrics.h"
+#include "json_writer.h"
+#include "state_version.h"
+#include "gate_wait.h"
+#include "laps.h"
+#include "gate_store.h"
+#include "packet_pool.h"
+#include "tx.h"
+#include "esp_system.h"
 #include "ESP32_Receiver.h"
 #include "esp_crc.h"
 #include "rom/ets_sys.h"
@@ -20,118 +39,84 @@ extern const uint8_t index_css_end[] asm("_binary_index_css_end");
 extern const uint8_t index_js_start[] asm("_binary_index_js_start");
 extern const uint8_t index_js_end[] asm("_binary_index_js_end");
 
-static const char *TAG = "server";
+// gzip copies written next to each file by the frontend build (vite.config.ts)
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
 
-static struct HashTable table;
-static struct HashTable gates;
+extern const uint8_t index_css_gz_start[] asm("_binary_index_css_gz_start");
+extern const uint8_t index_css_gz_end[] asm("_binary_index_css_gz_end");
 
-#define MAX_GATE_CONFIGS 10
+extern const uint8_t index_js_gz_start[] asm("_binary_index_js_gz_start");
+extern const uint8_t index_js_gz_end[] asm("_binary_index_js_gz_end");
 
-typedef enum {
-    GATE_MODE_DELTA,   // standalone delta timer
-    GATE_MODE_SERIES,  // part of a sequential track/series
-} gate_mode_t;
+static const char *TAG = "server";
 
-typedef struct {
-    char mac[18];
-    gate_mode_t mode;
-    char group[32];      // group/series name (empty = ungrouped)
-    int order;           // sort order within group
-} gate_config_t;
+static struct HashTable table;
+static uint32_t table_version;   // state version of the last addString
+// Held for every hashtable call and for as long as a reader uses the
+// pointers it returned: addString rewrites values in place, and httpd and
+// the stream task both render the table.
+static SemaphoreHandle_t table_lock;
+
+// httpd runs every handler on one task, so handlers share this buffer
+static char render_buf[SERVER_RENDER_BUF_SIZE];
 
-#define MAX_GATE_HISTORY 50
+atomic_uint state_version;
 
 typedef struct {
-    char mac_str[18];
-    int64_t timestamps_us[MAX_GATE_HISTORY]; // absolute µs (esp_timer_get_time)
-    int64_t diffs_us[MAX_GATE_HISTORY];      // delta from previous trigger for this gate
+    int64_t timestamp_us;
+    int64_t diff_us;
     int count;
     bool stuck;
-} gate_history_t;
-
-static gate_history_t gate_history[MAX_GATE_CONFIGS];
-static int gate_history_count = 0;
-
-static gate_config_t gate_configs[MAX_GATE_CONFIGS];
-static int gate_config_count = 0;
-
-static gate_config_t* find_gate_config(const char* mac) {
-    for (int i = 0; i < gate_config_count; i++) {
-        if (strcmp(gate_configs[i].mac, mac) == 0)
-            return &gate_configs[i];
-    }
-    return NULL;
-}
-
-static gate_config_t* get_or_create_gate_config(const char* mac) {
-    gate_config_t* cfg = find_gate_config(mac);
-    if (cfg) return cfg;
-    if (gate_config_count >= MAX_GATE_CONFIGS) return NULL;
-    cfg = &gate_configs[gate_config_count++];
-    strncpy(cfg->mac, mac, sizeof(cfg->mac) - 1);
-    cfg->mac[sizeof(cfg->mac) - 1] = '\0';
-    cfg->mode = GATE_MODE_DELTA;
-    cfg->group[0] = '\0';
-    cfg->order = gate_config_count - 1;
-    return cfg;
+    uint32_t version;
+} gate_latest_t;
+
+static void gate_read_latest(gate_timing_t *t, gate_latest_t *out) {
+    unsigned seq;
+    do {
+        seq = seqlock_read_begin(&t->lock);
+        gate_sample_t last = gate_timing_latest(t);
+        out->count = t->count;
+        out->stuck = t->stuck;
+        out->timestamp_us = last.timestamp_us;
+        out->diff_us      = last.diff_us;
+        out->version = t->version;
+    } while (seqlock_read_retry(&t->lock, seq));
 }
 
-void addGateTime(const char* mac_addr, const char* data) {
-    hashtable_insert(&gates, mac_addr, data);
-
+// Called from espnow_task only.
+void addGateTime(peer_t* peer, const char* data) {
     // Parse timestamp_us and diff_us from data string "timestamp_us,diff_us"
     int64_t timestamp_us = 0, diff_us = 0;
     sscanf(data, "%lld,%lld", &timestamp_us, &diff_us);
 
-    gate_history_t *hist = NULL;
-    for (int i = 0; i < gate_history_count; i++) {
-        if (strcmp(gate_history[i].mac_str, mac_addr) == 0) {
-            hist = &gate_history[i];
-            break;
-        }
-    }
-
-    if (hist == NULL) {
-        if (gate_history_count >= MAX_GATE_CONFIGS) {
-            ESP_LOGW(TAG, "Gate history table full, dropping entry for %s", mac_addr);
-            return;
-        }
-        hist = &gate_history[gate_history_count++];
-        strncpy(hist->mac_str, mac_addr, sizeof(hist->mac_str) - 1);
-        hist->mac_str[sizeof(hist->mac_str) - 1] = '\0';
-        hist->count = 0;
-    }
-
-    if (hist->count < MAX_GATE_HISTORY) {
-        hist->timestamps_us[hist->count] = timestamp_us;
-        hist->diffs_us[hist->count]      = diff_us;
-        hist->count++;
-    } else {
-        // Ring-buffer: shift entries left and append
-        memmove(&hist->timestamps_us[0], &hist->timestamps_us[1],
-                (MAX_GATE_HISTORY - 1) * sizeof(int64_t));
-        memmove(&hist->diffs_us[0], &hist->diffs_us[1],
-                (MAX_GATE_HISTORY - 1) * sizeof(int64_t));
-        hist->timestamps_us[MAX_GATE_HISTORY - 1] = timestamp_us;
-        hist->diffs_us[MAX_GATE_HISTORY - 1]      = diff_us;
-    }
+    gate_timing_t *t = &peer->timing;
+    uint32_t version = state_version_next();
+    seqlock_write_begin(&t->lock);
+    t->version = version;
+    gate_timing_push(t, timestamp_us, diff_us);
+    seqlock_write_end(&t->lock);
+    state_version_publish(version);
+
+    gate_wait_push(peer, timestamp_us, diff_us, t->stuck, version);
+    laps_on_trigger(peer, timestamp_us);
+    stream_notify(STREAM_EVENT_TIMING);
 }
 
-void setGateStuck(const char* mac_addr, bool stuck) {
-    for (int i = 0; i < gate_history_count; i++) {
-        if (strcmp(gate_history[i].mac_str, mac_addr) == 0) {
-            gate_history[i].stuck = stuck;
-            return;
-        }
-    }
-    // Gate not yet seen — create a history entry so the stuck state is stored
-    if (gate_history_count < MAX_GATE_CONFIGS) {
-        gate_history_t *hist = &gate_history[gate_history_count++];
-        strncpy(hist->mac_str, mac_addr, sizeof(hist->mac_str) - 1);
-        hist->mac_str[sizeof(hist->mac_str) - 1] = '\0';
-        hist->count = 0;
-        hist->stuck = stuck;
-    }
+// Called from espnow_task only.
+void setGateStuck(peer_t* peer, bool stuck) {
+    gate_timing_t *t = &peer->timing;
+    if (t->stuck == stuck) return;
+    uint32_t version = state_version_next();
+    seqlock_write_begin(&t->lock);
+    t->stuck = stuck;
+    t->version = version;
+    seqlock_write_end(&t->lock);
+    state_version_publish(version);
+
+    gate_sample_t last = gate_timing_latest(t);
+    gate_wait_push(peer, last.timestamp_us, last.diff_us, stuck, version);
+    stream_notify(STREAM_EVENT_TIMING);
 }
 
 void set_cors(httpd_req_t *req) {
@@ -139,6 +124,7 @@ void set_cors(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "*");
     httpd_resp_set_hdr(req, "Access-Control-Max-Age", "86400");
+    httpd_resp_set_hdr(req, "Access-Control-Expose-Headers", "X-State-Version");
 }
 
 static esp_err_t status_get_handler(httpd_req_t *req) {
@@ -175,62 +161,209 @@ static const httpd_uri_t status = {
     .user_ctx  = NULL
 };
 
+// Stamps state_version, so espnow_task only, like every other
+// state_version writer. No caller sets keys at the moment.
 void addString(const char* key, const char* value) {
-    hashtable_insert(&table, key, value);
+    uint32_t version = state_version_next();
+    xSemaphoreTake(table_lock, portMAX_DELAY);
+    bool ok = hashtable_insert(&table, key, value);
+    xSemaphoreGive(table_lock);
+    if (!ok) {
+        ESP_LOGE(TAG, "No memory for key %s", key);
+        return;
+    }
+    table_version = version;
+    state_version_publish(version);
 }
 
-static esp_err_t root_get_handler(httpd_req_t *req) {
-    set_cors(req);
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, (const char *)index_html_start, index_html_end - index_html_start);
-    return ESP_OK;
+// Milliseconds since the last telemetry frame, computed when asked for
+// rather than rewritten into the table on every packet.
+static void format_telemetry_ping(const telemetry_snapshot_t* snap, char* out, size_t out_len) {
+    uint32_t time_ms = esp_timer_get_time() / (int64_t)1000;
+    snprintf(out, out_len, "%lu", time_ms - snap->rx_ms);
 }
-static esp_err_t index_css_get_handler(httpd_req_t *req) {
-    set_cors(req);
-    httpd_resp_set_type(req, "text/css");
-    httpd_resp_send(req, (const char *)index_css_start, index_css_end - index_css_start);
-    return ESP_OK;
+
+// Embedded dashboard files. index.html is always revalidated; the build
+// links css/js from it as "/assets/index.js?v=<content hash>", so requests
+// carrying v= can be cached forever and a new build changes the URL.
+typedef struct {
+    const char *type;
+    const uint8_t *start, *end;        // identity
+    const uint8_t *gz_start, *gz_end;  // gzip
+    char etag[12];                     // "crc32" of the identity bytes, quoted
+    char etag_gz[15];                  // same with a -gz suffix
+} static_asset_t;
+
+static static_asset_t asset_html = {
+    "text/html", index_html_start, index_html_end, index_html_gz_start, index_html_gz_end
+};
+static static_asset_t asset_css = {
+    "text/css", index_css_start, index_css_end, index_css_gz_start, index_css_gz_end
+};
+static static_asset_t asset_js = {
+    "application/javascript", index_js_start, index_js_end, index_js_gz_start, index_js_gz_end
+};
+
+static void static_asset_init(static_asset_t *a) {
+    uint32_t crc = esp_crc32_le(0, a->start, a->end - a->start);
+    snprintf(a->etag, sizeof(a->etag), "\"%08lx\"", (unsigned long)crc);
+    snprintf(a->etag_gz, sizeof(a->etag_gz), "\"%08lx-gz\"", (unsigned long)crc);
 }
 
-static esp_err_t index_js_get_handler(httpd_req_t *req) {
+// True if the comma-separated header value lists token (case-sensitive, as
+// browsers send it) with a non-zero q.
+static bool header_has_token(const char *value, const char *token) {
+    size_t n = strlen(token);
+    for (const char *p = value; (p = strstr(p, token)) != NULL; p += n) {
+        bool starts = (p == value || p[-1] == ' ' || p[-1] == ',');
+        bool ends = (p[n] == '\0' || p[n] == ',' || p[n] == ';' || p[n] == ' ');
+        if (!starts || !ends) continue;
+        if (strncmp(p + n, ";q=", 3) == 0) return strtod(p + n + 3, NULL) > 0;
+        return true;
+    }
+    return false;
+}
+
+static esp_err_t static_asset_handler(httpd_req_t *req) {
+    const static_asset_t *a = req->user_ctx;
     set_cors(req);
-    httpd_resp_set_type(req, "application/javascript");
-    httpd_resp_send(req, (const char *)index_js_start, index_js_end - index_js_start);
+
+    char hdr[128];
+    bool gzip = httpd_req_get_hdr_value_str(req, "Accept-Encoding", hdr, sizeof(hdr)) == ESP_OK &&
+                header_has_token(hdr, "gzip");
+    const char *etag = gzip ? a->etag_gz : a->etag;
+
+    char query[48], v[16];
+    bool versioned = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                     httpd_query_key_value(query, "v", v, sizeof(v)) == ESP_OK;
+
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    httpd_resp_set_hdr(req, "Cache-Control", versioned ? "public, max-age=31536000, immutable" : "no-cache");
+
+    // If-None-Match may hold several tags, possibly weak (W/"..."); a substring match covers both.
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", hdr, sizeof(hdr)) == ESP_OK &&
+        strstr(hdr, etag) != NULL) {
+        httpd_resp_set_status(req, HTTPD_304);
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, a->type);
+    if (gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        httpd_resp_send(req, (const char *)a->gz_start, a->gz_end - a->gz_start);
+    } else {
+        httpd_resp_send(req, (const char *)a->start, a->end - a->start);
+    }
     return ESP_OK;
 }
 
 static const httpd_uri_t root = {
     .uri       = "/",
     .method    = HTTP_GET,
-    .handler   = root_get_handler,
-    .user_ctx  = NULL
+    .handler   = static_asset_handler,
+    .user_ctx  = &asset_html
 };
 
 static const httpd_uri_t index_css = {
     .uri       = "/assets/index.css",
     .method    = HTTP_GET,
-    .handler   = index_css_get_handler,
-    .user_ctx  = NULL
+    .handler   = static_asset_handler,
+    .user_ctx  = &asset_css
 };
 
 static const httpd_uri_t index_js = {
     .uri       = "/assets/index.js",
     .method    = HTTP_GET,
-    .handler   = index_js_get_handler,
-    .user_ctx  = NULL
+    .handler   = static_asset_handler,
+    .user_ctx  = &asset_js
 };
 
+// ?src= picks a telemetry source by MAC (':' may arrive as %3A) or by
+// index; without it the default source is used. -1 for a source that has
+// not been heard.
+static int query_source(httpd_req_t *req) {
+    char query[96], param[32];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "src", param, sizeof(param)) != ESP_OK) {
+        return TELEMETRY_SOURCE_DEFAULT;
+    }
+
+    char mac_str[18];
+    size_t n = 0;
+    for (const char* p = param; *p && n < sizeof(mac_str) - 1; p++) {
+        if (p[0] == '%' && p[1] == '3' && (p[2] == 'A' || p[2] == 'a')) {
+            mac_str[n++] = ':';
+            p += 2;
+        } else {
+            mac_str[n++] = *p;
+        }
+    }
+    mac_str[n] = '\0';
+
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    if (peer_parse_mac(mac_str, mac)) return telemetry_find_source(mac);
+
+    char* end;
+    long index = strtol(mac_str, &end, 10);
+    if (end == mac_str || *end != '\0' || index < 0 || index >= telemetry_source_count()) return -1;
+    return (int)index;
+}
+
+static void send_unknown_source(httpd_req_t *req) {
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown telemetry source");
+}
+
 static esp_err_t telemetry_get_handler(httpd_req_t *req) {
     set_cors(req);
 
-    const char* uri = req->uri;
-
-    // Extract the key from the URI (everything after /telemetry/)
-    const char* key = uri + strlen("/telemetry/");
+    // The key is everything after /telemetry/ up to the query string
+    const char* path = req->uri + strlen("/telemetry/");
+    char key[32];
+    size_t key_len = strcspn(path, "?");
+    if (key_len >= sizeof(key)) key_len = sizeof(key) - 1;
+    memcpy(key, path, key_len);
+    key[key_len] = '\0';
 
     ESP_LOGI(TAG, "Telemetry request for key: %s", key);
 
-    const char* response = hashtable_get(&table, (char*)key);
+    int src = query_source(req);
+    if (src < 0) {
+        send_unknown_source(req);
+        return ESP_OK;
+    }
+
+    // Segments come as hex, as in /telemetry; ?decoded=1 gives the
+    // comma-separated field values instead.
+    char query[96], param[4];
+    bool decoded = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                   httpd_query_key_value(query, "decoded", param, sizeof(param)) == ESP_OK &&
+                   strcmp(param, "1") == 0;
+
+    telemetry_snapshot_t snap;
+    telemetry_snapshot(src, &snap);
+
+    char value[TELEMETRY_VALUE_MAX];
+    const char* response = NULL;
+    int seg = telemetry_find_segment(key);
+    if (seg >= 0) {
+        int n = decoded ? telemetry_format_decoded(&snap, seg, value, sizeof(value))
+                        : telemetry_format_segment(&snap, seg, value, sizeof(value));
+        if (n >= 0) response = value;
+    } else if (strcmp(key, "telemetryPing") == 0) {
+        format_telemetry_ping(&snap, value, sizeof(value));
+        response = value;
+    } else {
+        // Copied out so the lock is not held across the send.
+        xSemaphoreTake(table_lock, portMAX_DELAY);
+        const char* entry = hashtable_get(&table, key);
+        if (entry) {
+            snprintf(render_buf, sizeof(render_buf), "%s", entry);
+            response = render_buf;
+        }
+        xSemaphoreGive(table_lock);
+    }
 
     if (response == NULL) {
         httpd_resp_set_type(req, "text/plain");
@@ -244,65 +377,242 @@ static esp_err_t telemetry_get_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
-static esp_err_t telemetry_all_get_handler(httpd_req_t *req) {
-    set_cors(req);
-    httpd_resp_set_type(req, "application/json");
+static void render_key_value(json_writer_t* w, const char* key, const char* value) {
+    json_begin_object(w);
+    json_key(w, "key");
+    json_string(w, key);
+    json_key(w, "value");
+    json_string(w, value);
+    json_end_object(w);
+}
 
-    char** keys = hashtable_list_keys(&table);
-    httpd_resp_sendstr_chunk(req, "[");
+// Elements that do not fit are rolled back, so the array stays well-formed.
+static size_t render_telemetry_src(char* buf, size_t len, int src, uint32_t since, int* rows) {
+    telemetry_snapshot_t snap;
+    telemetry_snapshot(src, &snap);
+
+    json_writer_t w;
+    json_init_buffer(&w, buf, len, 1);
+    json_begin_array(&w);
+
+    int n = 0;
+    char value[TELEMETRY_VALUE_MAX];
+    json_mark_t mark = json_mark(&w);
+    // The ping row changes with every frame; it tells a delta client the car is still sending.
+    if (snap.rx_version > since) {
+        format_telemetry_ping(&snap, value, sizeof(value));
+        render_key_value(&w, "telemetryPing", value);
+        n++;
+    }
 
-    bool first = true;
-    char chunk[128];
-    for (int i = 0; keys && i < table.size; i++) {
-        if (keys[i] == NULL) continue;
-        const char* value = hashtable_get(&table, keys[i]);
-        if (value == NULL) continue;
-        if (!first) httpd_resp_sendstr_chunk(req, ",");
-        snprintf(chunk, sizeof(chunk), "{\"key\":\"%s\",\"value\":\"%s\"}", keys[i], value);
-        httpd_resp_sendstr_chunk(req, chunk);
-        first = false;
+    for (int s = 0; s < NUM_SEGMENTS && s < TELEMETRY_MAX_SEGMENTS && !w.overflow; s++) {
+        if (snap.seg_version[s] <= since) continue;
+        if (telemetry_format_segment(&snap, s, value, sizeof(value)) < 0) continue;
+        mark = json_mark(&w);
+        render_key_value(&w, segments[s].name, value);
+        n++;
     }
 
-    httpd_resp_sendstr_chunk(req, "]");
-    httpd_resp_sendstr_chunk(req, NULL);
+    uint32_t pos = 0;
+    const char* entry_key;
+    const char* entry;
+    xSemaphoreTake(table_lock, portMAX_DELAY);
+    while (table_version > since && !w.overflow && hashtable_next(&table, &pos, &entry_key, &entry)) {
+        mark = json_mark(&w);
+        render_key_value(&w, entry_key, entry);
+        n++;
+    }
+    xSemaphoreGive(table_lock);
+
+    if (w.overflow) {
+        json_rollback(&w, mark);
+        n--;
+    }
+    json_end_array(&w);
+    if (rows) *rows = n;
+    return json_finish_buffer(&w);
+}
+
+// SSE pushes, from the stream task.
+size_t server_render_telemetry(char* buf, size_t len) {
+    return render_telemetry_src(buf, len, TELEMETRY_SOURCE_DEFAULT, 0, NULL);
+}
+
+// Gate timing is not per source; src is ignored.
+static size_t render_timing_since(char* buf, size_t len, int src, uint32_t since, int* rows) {
+    json_writer_t w;
+    json_init_buffer(&w, buf, len, 1);
+    json_begin_array(&w);
+
+    int n = 0;
+    json_mark_t mark = json_mark(&w);
+    int count = peer_count();
+    for (int i = 0; i < count && !w.overflow; i++) {
+        peer_t *peer = peer_at(i);
+        gate_latest_t latest;
+        gate_read_latest(&peer->timing, &latest);
+        if (latest.count == 0 || latest.version <= since) continue;
+
+        mark = json_mark(&w);
+        n++;
+        json_begin_object(&w);
+        json_key(&w, "mac");          json_string(&w, peer->mac_str);
+        json_key(&w, "timestamp_us"); json_int(&w, latest.timestamp_us);
+        json_key(&w, "diff_us");      json_int(&w, latest.diff_us);
+        json_key(&w, "stuck");        json_bool(&w, latest.stuck);
+        json_end_object(&w);
+    }
+
+    if (w.overflow) {
+        json_rollback(&w, mark);
+        n--;
+    }
+    json_end_array(&w);
+    if (rows) *rows = n;
+    return json_finish_buffer(&w);
+}
+
+size_t server_render_timing(char* buf, size_t len) {
+    return render_timing_since(buf, len, TELEMETRY_SOURCE_DEFAULT, 0, NULL);
+}
+
+typedef size_t (*render_since_fn)(char* buf, size_t len, int src, uint32_t since, int* rows);
+
+// Full state of source src, or with ?since=<version> only what changed
+// after that version (304 when nothing did). X-State-Version is the cursor
+// for the next poll.
+static esp_err_t send_versioned(httpd_req_t *req, render_since_fn render, int src) {
+    set_cors(req);
+
+    uint32_t current = state_version_current();
+    char version[12];
+    snprintf(version, sizeof(version), "%lu", (unsigned long)current);
+    httpd_resp_set_hdr(req, "X-State-Version", version);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    char query[64], param[12];
+    bool delta = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                 httpd_query_key_value(query, "since", param, sizeof(param)) == ESP_OK;
+    uint32_t since = delta ? (uint32_t)strtoul(param, NULL, 10) : 0;
+    if (since > current) since = 0;   // cursor from before a reboot
+
+    int rows = 0;
+    size_t n = render(render_buf, sizeof(render_buf), src, since, &rows);
+    if (delta && since > 0 && rows == 0) {
+        httpd_resp_set_status(req, HTTPD_304);
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, render_buf, n);
     return ESP_OK;
 }
 
-// Takes a mac address string such as FF:FF:FF:FF:FF:FF and returns an uint8_t*
-uint8_t* string_to_mac(const char* str) {
-    if (!str) return NULL;
+static esp_err_t telemetry_all_get_handler(httpd_req_t *req) {
+    int src = query_source(req);
+    if (src < 0) {
+        set_cors(req);
+        send_unknown_source(req);
+        return ESP_OK;
+    }
+    return send_versioned(req, render_telemetry_src, src);
+}
 
-    uint8_t *mac = malloc(6 * sizeof(uint8_t));
-    if (!mac) return NULL;
+static uint32_t query_u32(const char* query, const char* key, uint32_t def) {
+    char param[16];
+    if (httpd_query_key_value(query, key, param, sizeof(param)) != ESP_OK) return def;
+    return (uint32_t)strtoul(param, NULL, 10);
+}
 
-    unsigned int bytes[6];
+// GET /telemetry/history?key=rpm&from=<ms>&to=<ms>&points=<n>&src=<mac>
+// Times are receiver uptime in ms, matching rx_ms. Points are
+// [t_ms, min, max, mean] scaled to the field's unit, which is sent as
+// "unit", with the field's decimals. Without a key, lists the channels
+// that have history.
+static esp_err_t telemetry_history_get_handler(httpd_req_t *req) {
+    set_cors(req);
 
-    if (sscanf(str, "%02X:%02X:%02X:%02X:%02X:%02X",
-        &bytes[0], &bytes[1], &bytes[2],
-        &bytes[3], &bytes[4], &bytes[5]) != 6) {
-            free(mac);
-            return NULL;
+    char query[96] = "";
+    char key[24] = "";
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    httpd_query_key_value(query, "key", key, sizeof(key));
+
+    if (key[0] == '\0') {
+        httpd_resp_set_type(req, "application/json");
+        json_writer_t w;
+        json_init_stream(&w, req, render_buf, sizeof(render_buf));
+        json_begin_array(&w);
+        for (int c = 0; c < history_channel_count(); c++) {
+            json_string(&w, history_channel_name(c));
         }
+        json_end_array(&w);
+        return json_finish_stream(&w);
+    }
 
-    for (int i = 0; i < 6; i++)
-        mac[i] = (uint8_t)bytes[i];
+    int src = query_source(req);
+    if (src < 0) {
+        send_unknown_source(req);
+        return ESP_OK;
+    }
+    if (!history_available(src)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No history kept for this source");
+        return ESP_OK;
+    }
 
-    return mac;
-}
+    int ch = history_find_channel(key);
+    if (ch < 0) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown history key");
+        return ESP_OK;
+    }
 
-esp_err_t send_ident_command(const uint8_t* dest_mac) {
-    espnow_data_t *buf = malloc(sizeof(espnow_data_t));
-    if (buf == NULL) {
-        ESP_LOGE(TAG, "Malloc send buffer fail");
-        return ESP_ERR_NO_MEM;
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t to_ms = query_u32(query, "to", now_ms);
+    if (to_ms > now_ms) to_ms = now_ms;   // nothing recorded past now
+    uint32_t from_ms = query_u32(query, "from", to_ms > 60000 ? to_ms - 60000 : 0);
+    if (from_ms > to_ms) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "from is after to");
+        return ESP_OK;
+    }
+    int points = (int)query_u32(query, "points", HISTORY_DEFAULT_POINTS);
+
+    // httpd runs handlers on a single task, so one result buffer is enough
+    static history_result_t result;
+    if (!history_query(src, ch, from_ms, to_ms, points, &result)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "History busy", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
     }
 
-    buf->type = ESPNOW_GATE_IDENT;
-    buf->seq_num = s_espnow_seq[ESPNOW_DATA_UNICAST]++;
-    buf->crc = 0;
-    buf->crc = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, sizeof(espnow_data_t));
+    const telemetry_field_t *f = history_channel_field(ch);
+    httpd_resp_set_type(req, "application/json");
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_object(&w);
+    json_key(&w, "key");   json_string(&w, key);
+    json_key(&w, "src");   json_int(&w, src);
+    json_key(&w, "level"); json_int(&w, result.level);
+    json_key(&w, "from");  json_uint(&w, from_ms);
+    json_key(&w, "to");    json_uint(&w, to_ms);
+    json_key(&w, "unit");  json_string(&w, f->unit);
+    json_key(&w, "points");
+    json_begin_array(&w);
+    for (int i = 0; i < result.count; i++) {
+        const history_point_t *p = &result.points[i];
+        json_begin_array(&w);
+        json_uint(&w, p->t_ms);
+        json_fixed(&w, telemetry_field_scaled(f, p->min), f->decimals);
+        json_fixed(&w, telemetry_field_scaled(f, p->max), f->decimals);
+        json_fixed(&w, telemetry_field_scaled(f, p->mean), f->decimals);
+        json_end_array(&w);
+    }
+    json_end_array(&w);
+    json_end_object(&w);
+    return json_finish_stream(&w);
+}
 
-    const esp_err_t ret = esp_now_send(dest_mac, (uint8_t *)buf, sizeof(espnow_data_t));
+esp_err_t send_ident_command(const uint8_t* dest_mac) {
+    const esp_err_t ret = tx_ident(dest_mac);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Send ident error: %s", esp_err_to_name(ret));
         return ret;
@@ -331,15 +641,14 @@ static esp_err_t identify_gate_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "Received POST data: %s", content);
     ESP_LOGI(TAG, "Requested to identify timing gate: %s", content);
 
-    uint8_t* dest_mac = string_to_mac(content);
-    if (!dest_mac) {
+    uint8_t dest_mac[ESP_NOW_ETH_ALEN];
+    if (!peer_parse_mac(content, dest_mac)) {
         httpd_resp_set_type(req, "text/plain");
         httpd_resp_send(req, "Invalid MAC address format", HTTPD_RESP_USE_STRLEN);
         return ESP_FAIL;
     }
 
     esp_err_t result = send_ident_command(dest_mac);
-    free(dest_mac);
 
     if (result == ESP_OK) {
         httpd_resp_set_type(req, "text/plain");
@@ -356,76 +665,114 @@ static esp_err_t get_gates_handler(httpd_req_t *req) {
     set_cors(req);
     httpd_resp_set_type(req, "application/json");
 
-    mac_address_list_t *mac_list = get_mac_list();
-    char chunk[32];
-    httpd_resp_sendstr_chunk(req, "[");
-    for (int i = 0; i < mac_list->count; i++) {
-        if (i > 0) httpd_resp_sendstr_chunk(req, ",");
-        snprintf(chunk, sizeof(chunk), "\""MACSTR"\"", MAC2STR(mac_list->mac_list[i].addr));
-        httpd_resp_sendstr_chunk(req, chunk);
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_array(&w);
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *peer = peer_at(i);
+        if (peer_has(peer, PEER_F_LISTED)) json_string(&w, peer->mac_str);
     }
-    httpd_resp_sendstr_chunk(req, "]");
-    httpd_resp_sendstr_chunk(req, NULL);
-    return ESP_OK;
+    json_end_array(&w);
+    return json_finish_stream(&w);
 }
 
 static esp_err_t get_gate_data_handler(httpd_req_t *req) {
+    return send_versioned(req, render_timing_since, TELEMETRY_SOURCE_DEFAULT);
+}
+
+// GET /peers -> every device heard from, with its frame integrity counters
+// Counters are written by espnow_task; a torn read only skews one response.
+static void render_seq(json_writer_t *w, const char *key, const peer_seq_t *s) {
+    json_key(w, key);
+    json_begin_object(w);
+    json_key(w, "accepted");             json_uint(w, s->accepted);
+    json_key(w, "lost");                 json_uint(w, s->lost);
+    json_key(w, "duplicates");           json_uint(w, s->duplicates);
+    json_key(w, "stale");                json_uint(w, s->stale);
+    json_key(w, "reordered");            json_uint(w, s->reordered);
+    json_key(w, "restarts");             json_uint(w, s->restarts);
+    json_key(w, "loss_permille");        json_uint(w, peer_seq_loss_permille(s));
+    json_key(w, "recent_loss_permille"); json_uint(w, s->recent_loss_permille);
+    json_end_object(w);
+}
+
+static esp_err_t peers_get_handler(httpd_req_t *req) {
     set_cors(req);
     httpd_resp_set_type(req, "application/json");
 
-    char** keys = hashtable_list_keys(&gates);
-    httpd_resp_sendstr_chunk(req, "[");
-
-    bool first = true;
-    char chunk[128];
-    for (int i = 0; keys && i < gates.size; i++) {
-        if (keys[i] == NULL) continue;
-        const char* value = hashtable_get(&gates, keys[i]);
-        if (value == NULL) continue;
-        int64_t timestamp_us, diff_us;
-        sscanf(value, "%lld,%lld", &timestamp_us, &diff_us);
-
-        bool stuck = false;
-        for (int j = 0; j < gate_history_count; j++) {
-            if (strcmp(gate_history[j].mac_str, keys[i]) == 0) {
-                stuck = gate_history[j].stuck;
-                break;
-            }
-        }
-
-        if (!first) httpd_resp_sendstr_chunk(req, ",");
-        snprintf(chunk, sizeof(chunk),
-            "{\"mac\":\"%s\",\"timestamp_us\":%lld,\"diff_us\":%lld,\"stuck\":%s}",
-            keys[i], timestamp_us, diff_us, stuck ? "true" : "false");
-        httpd_resp_sendstr_chunk(req, chunk);
-        first = false;
+    int64_t now_us = esp_timer_get_time();
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_array(&w);
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *peer = peer_at(i);
+        peer_rx_stats_t rx = peer->rx;
+        json_begin_object(&w);
+        json_key(&w, "mac");        json_string(&w, peer->mac_str);
+        json_key(&w, "listed");     json_bool(&w, peer_has(peer, PEER_F_LISTED));
+        json_key(&w, "configured"); json_bool(&w, peer_has(peer, PEER_F_CONFIG));
+        json_key(&w, "last_ping_ms");
+        if (peer->last_ping_us) json_int(&w, (now_us - peer->last_ping_us) / 1000);
+        else json_null(&w);
+        json_key(&w, "rx_frames");  json_uint(&w, rx.frames);
+        json_key(&w, "crc_errors"); json_uint(&w, rx.crc_errors);
+        json_key(&w, "legacy_crc"); json_uint(&w, rx.legacy_crc);
+        json_key(&w, "len_errors"); json_uint(&w, rx.len_errors);
+        json_key(&w, "crc_error_permille");
+        json_uint(&w, rx.frames ? (uint64_t)rx.crc_errors * 1000 / rx.frames : 0);
+        json_key(&w, "recent_crc_error_permille"); json_uint(&w, rx.recent_error_permille);
+        peer_seq_t gate_seq = peer->gate_seq;
+        peer_seq_t telemetry_seq = peer->telemetry_seq;
+        render_seq(&w, "gate_seq", &gate_seq);
+        render_seq(&w, "telemetry_seq", &telemetry_seq);
+        json_end_object(&w);
     }
-
-    httpd_resp_sendstr_chunk(req, "]");
-    httpd_resp_sendstr_chunk(req, NULL);
-    return ESP_OK;
+    json_end_array(&w);
+    return json_finish_stream(&w);
 }
 
-esp_err_t send_set_name_command(const uint8_t* dest_mac, const char* name) {
-    espnow_data_t *buf = malloc(sizeof(espnow_data_t));
-    if (buf == NULL) {
-        ESP_LOGE(TAG, "Malloc send buffer fail");
-        return ESP_ERR_NO_MEM;
-    }
-
-    buf->type = ESPNOW_GATE_IDENT;
-    buf->seq_num = s_espnow_seq[ESPNOW_DATA_UNICAST]++;
-
-    size_t name_len = strnlen(name, sizeof(buf->data) - 1);
-    memcpy(buf->data, name, name_len);
-    buf->data[name_len] = '\0';
-    buf->len = (uint8_t)(name_len + 1);
+// GET /sources: telemetry transmitters in binding order; the index or MAC
+// is what ?src= takes on the /telemetry endpoints.
+static esp_err_t sources_get_handler(httpd_req_t *req) {
+    set_cors(req);
+    httpd_resp_set_type(req, "application/json");
 
-    buf->crc = 0;
-    buf->crc = esp_crc16_le(UINT16_MAX, (uint8_t const *)buf, sizeof(espnow_data_t));
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_object(&w);
+    json_key(&w, "max");            json_int(&w, TELEMETRY_MAX_SOURCES);
+    json_key(&w, "unbound_frames"); json_uint(&w, telemetry_unbound_frames());
+    json_key(&w, "sources");
+    json_begin_array(&w);
+    int count = telemetry_source_count();
+    for (int i = 0; i < count; i++) {
+        telemetry_source_info_t info;
+        if (!telemetry_source_info(i, &info)) continue;
+        char mac_str[18];
+        snprintf(mac_str, sizeof(mac_str), MACSTR, MAC2STR(info.mac));
+        bool live = now_ms - info.last_ms < 2 * TELEMETRY_RATE_WINDOW_MS;
+
+        json_begin_object(&w);
+        json_key(&w, "index");        json_int(&w, i);
+        json_key(&w, "src");          json_string(&w, mac_str);
+        json_key(&w, "default");      json_bool(&w, i == TELEMETRY_SOURCE_DEFAULT);
+        json_key(&w, "history");      json_bool(&w, history_available(i));
+        json_key(&w, "frames");       json_uint(&w, info.frames);
+        json_key(&w, "short_frames"); json_uint(&w, info.short_frames);
+        json_key(&w, "rate_hz");      json_uint(&w, live ? info.rate_hz : 0);
+        json_key(&w, "last_ms");      json_uint(&w, now_ms - info.last_ms);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    json_end_object(&w);
+    return json_finish_stream(&w);
+}
 
-    const esp_err_t ret = esp_now_send(dest_mac, (uint8_t *)buf, sizeof(espnow_data_t));
-    free(buf);
+esp_err_t send_set_name_command(const uint8_t* dest_mac, const char* name) {
+    const esp_err_t ret = tx_set_logger_name(dest_mac, name);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Send set-name error: %s", esp_err_to_name(ret));
         return ret;
@@ -474,6 +821,13 @@ static const httpd_uri_t telemetry = {
     .user_ctx  = NULL
 };
 
+static const httpd_uri_t telemetry_history = {
+    .uri       = "/telemetry/history",
+    .method    = HTTP_GET,
+    .handler   = telemetry_history_get_handler,
+    .user_ctx  = NULL
+};
+
 static const httpd_uri_t telemetry_all = {
     .uri       = "/telemetry",
     .method    = HTTP_GET,
@@ -502,6 +856,20 @@ static const httpd_uri_t get_gates_data = {
     .user_ctx  = NULL
 };
 
+static const httpd_uri_t get_peers = {
+    .uri       = "/peers",
+    .method    = HTTP_GET,
+    .handler   = peers_get_handler,
+    .user_ctx  = NULL
+};
+
+static const httpd_uri_t get_sources = {
+    .uri       = "/sources",
+    .method    = HTTP_GET,
+    .handler   = sources_get_handler,
+    .user_ctx  = NULL
+};
+
 static const httpd_uri_t set_logger_name = {
     .uri       = "/loggername",
     .method    = HTTP_POST,
@@ -514,21 +882,22 @@ static esp_err_t gate_config_get_handler(httpd_req_t *req) {
     set_cors(req);
     httpd_resp_set_type(req, "application/json");
 
-    httpd_resp_sendstr_chunk(req, "[");
-    char chunk[96];
-    for (int i = 0; i < gate_config_count; i++) {
-        if (i > 0) httpd_resp_sendstr_chunk(req, ",");
-        snprintf(chunk, sizeof(chunk),
-            "{\"mac\":\"%s\",\"mode\":\"%s\",\"group\":\"%s\",\"order\":%d}",
-            gate_configs[i].mac,
-            gate_configs[i].mode == GATE_MODE_SERIES ? "series" : "delta",
-            gate_configs[i].group,
-            gate_configs[i].order);
-        httpd_resp_sendstr_chunk(req, chunk);
-    }
-    httpd_resp_sendstr_chunk(req, "]");
-    httpd_resp_sendstr_chunk(req, NULL);
-    return ESP_OK;
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_array(&w);
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *peer = peer_at(i);
+        if (!peer_has(peer, PEER_F_CONFIG)) continue;
+        json_begin_object(&w);
+        json_key(&w, "mac");   json_string(&w, peer->mac_str);
+        json_key(&w, "mode");  json_string(&w, peer->config.mode == GATE_MODE_SERIES ? "series" : "delta");
+        json_key(&w, "group"); json_string(&w, peer->config.group);
+        json_key(&w, "order"); json_int(&w, peer->config.order);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    return json_finish_stream(&w);
 }
 
 // POST /gate-config  body: {"mac":"AA:BB:CC:DD:EE:FF","mode":"delta|series","group":"name","order":N}
@@ -571,12 +940,20 @@ static esp_err_t gate_config_post_handler(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
-    gate_config_t* cfg = get_or_create_gate_config(mac);
-    if (!cfg) {
+    uint8_t mac_bytes[ESP_NOW_ETH_ALEN];
+    if (!peer_parse_mac(mac, mac_bytes)) {
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_send(req, "Invalid MAC address format", HTTPD_RESP_USE_STRLEN);
+        return ESP_FAIL;
+    }
+
+    peer_t* peer = peer_get_or_add(mac_bytes);
+    if (!peer) {
         httpd_resp_set_type(req, "text/plain");
         httpd_resp_send(req, "Too many gates", HTTPD_RESP_USE_STRLEN);
         return ESP_FAIL;
     }
+    gate_config_t* cfg = &peer->config;
 
     if (mode[0] != '\0') {
         cfg->mode = (strcmp(mode, "series") == 0) ? GATE_MODE_SERIES : GATE_MODE_DELTA;
@@ -587,9 +964,12 @@ static esp_err_t gate_config_post_handler(httpd_req_t *req) {
     cfg->group[sizeof(cfg->group) - 1] = '\0';
 
     if (order >= 0) cfg->order = order;
+    peer_set(peer, PEER_F_CONFIG);
+    laps_reconfigure();
+    gate_store_schedule_save();
 
     ESP_LOGI(TAG, "Gate config saved: mac=%s mode=%d group='%s' order=%d",
-             cfg->mac, cfg->mode, cfg->group, cfg->order);
+             peer->mac_str, cfg->mode, cfg->group, cfg->order);
 
     httpd_resp_set_type(req, "text/plain");
     httpd_resp_send(req, "OK", HTTPD_RESP_USE_STRLEN);
@@ -617,21 +997,76 @@ static esp_err_t gate_history_csv_handler(httpd_req_t *req) {
 
     httpd_resp_sendstr_chunk(req, "mac,trigger_index,timestamp_us,diff_us\r\n");
 
-    char row[80];
-    for (int i = 0; i < gate_history_count; i++) {
-        for (int j = 0; j < gate_history[i].count; j++) {
-            snprintf(row, sizeof(row), "%s,%d,%lld,%lld\r\n",
-                     gate_history[i].mac_str, j,
-                     gate_history[i].timestamps_us[j],
-                     gate_history[i].diffs_us[j]);
-            httpd_resp_sendstr_chunk(req, row);
+    // Rows are batched into render_buf and sent a chunk at a time.
+    size_t used = 0;
+    int count = peer_count();
+    for (int i = 0; i < count; i++) {
+        peer_t *peer = peer_at(i);
+        gate_iter_t it;
+        gate_sample_t sample;
+        uint32_t index;
+        gate_iter_begin(&it, &peer->timing);
+        while (gate_iter_next(&it, &sample, &index)) {
+            if (sizeof(render_buf) - used < 80) {
+                if (httpd_resp_send_chunk(req, render_buf, used) != ESP_OK) return ESP_FAIL;
+                used = 0;
+            }
+            used += snprintf(render_buf + used, sizeof(render_buf) - used, "%s,%lu,%lld,%lld\r\n",
+                             peer->mac_str, (unsigned long)index,
+                             sample.timestamp_us, sample.diff_us);
         }
     }
 
+    if (used > 0 && httpd_resp_send_chunk(req, render_buf, used) != ESP_OK) return ESP_FAIL;
     httpd_resp_sendstr_chunk(req, NULL);
     return ESP_OK;
 }
 
+// GET /timing/depth -> {"depth":50,"configured":50,"min":8,"max":2048}
+static esp_err_t gate_depth_get_handler(httpd_req_t *req) {
+    set_cors(req);
+    httpd_resp_set_type(req, "application/json");
+
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_object(&w);
+    json_key(&w, "depth");      json_uint(&w, peers_history_depth());
+    json_key(&w, "configured"); json_uint(&w, peers_history_depth_configured());
+    json_key(&w, "min");        json_uint(&w, PEER_GATE_HISTORY_MIN);
+    json_key(&w, "max");        json_uint(&w, PEER_GATE_HISTORY_MAX);
+    json_end_object(&w);
+    return json_finish_stream(&w);
+}
+
+// POST /timing/depth with the new depth as the body; applies after a restart.
+static esp_err_t gate_depth_post_handler(httpd_req_t *req) {
+    set_cors(req);
+
+    char content[12];
+    size_t recv_size = (req->content_len < sizeof(content) - 1) ? req->content_len : sizeof(content) - 1;
+    int ret = httpd_req_recv(req, content, recv_size);
+    if (ret <= 0) {
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            httpd_resp_send_408(req);
+        }
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+
+    char *end;
+    unsigned long depth = strtoul(content, &end, 10);
+    if (end == content) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected a number");
+        return ESP_OK;
+    }
+    if (peers_set_history_depth(depth) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to store depth");
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Gate history depth set to %lu (after restart)", (unsigned long)peers_history_depth_configured());
+    return gate_depth_get_handler(req);
+}
+
 static const httpd_uri_t gate_history_csv = {
     .uri     = "/timing/export.csv",
     .method  = HTTP_GET,
@@ -639,48 +1074,172 @@ static const httpd_uri_t gate_history_csv = {
     .user_ctx = NULL
 };
 
-httpd_handle_t start(void) {
-    table = hashtable_create();
-    gates = hashtable_create();
+static const httpd_uri_t gate_depth_get = {
+    .uri     = "/timing/depth",
+    .method  = HTTP_GET,
+    .handler = gate_depth_get_handler,
+    .user_ctx = NULL
+};
 
-    // struct GateData gate1_data = {"1000", "1.5"};
-    // struct GateData gate2_data = {"2000", "2.3"};
-    // struct GateData gate3_data = {"3000", "1.8"};
-    //
-    // hashtable_insert(&table, "gate1", &gate1_data);
-    // hashtable_insert(&table, "gate2", &gate2_data);
-    // hashtable_insert(&table, "gate3", &gate3_data);
+static const httpd_uri_t gate_depth_post = {
+    .uri     = "/timing/depth",
+    .method  = HTTP_POST,
+    .handler = gate_depth_post_handler,
+    .user_ctx = NULL
+};
 
-    hashtable_insert(&table, "test", "value");
+// Handlers are registered through a wrapper that times each call; the
+// original uri is passed in user_ctx and restored before the real handler runs.
+#define MAX_TIMED_URIS 32
+
+typedef struct {
+    httpd_uri_t uri;
+    const httpd_uri_t *orig;
+    metrics_hist_t duration_us;
+} timed_uri_t;
+
+static timed_uri_t timed_uris[MAX_TIMED_URIS];
+static int timed_uri_count;
+
+static esp_err_t timed_handler(httpd_req_t *req) {
+    timed_uri_t *t = req->user_ctx;
+    req->user_ctx = t->orig->user_ctx;
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = t->orig->handler(req);
+    metrics_observe(&t->duration_us, (uint32_t)(esp_timer_get_time() - start_us));
+    return ret;
+}
+
+static void register_timed(httpd_handle_t server, const httpd_uri_t *uri) {
+    if (timed_uri_count >= MAX_TIMED_URIS) {
+        ESP_LOGW(TAG, "No timing slot for %s, registering untimed", uri->uri);
+        httpd_register_uri_handler(server, uri);
+        return;
+    }
+    timed_uri_t *t = &timed_uris[timed_uri_count++];
+    t->uri = *uri;
+    t->uri.handler = timed_handler;
+    t->uri.user_ctx = t;
+    t->orig = uri;
+    httpd_register_uri_handler(server, &t->uri);
+}
+
+// Same as the server's default send, plus a byte count. Installed on every
+// session, so it also sees SSE and WebSocket traffic from the stream task.
+static int counting_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags) {
+    if (buf == NULL) return HTTPD_SOCK_ERR_INVALID;
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    metrics_add(METRIC_HTTP_BYTES_SENT, ret);
+    return ret;
+}
+
+static esp_err_t session_open(httpd_handle_t hd, int sockfd) {
+    httpd_sess_set_send_override(hd, sockfd, counting_send);
+    return ESP_OK;
+}
+
+static esp_err_t metrics_get_handler(httpd_req_t *req) {
+    set_cors(req);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    metrics_writer_t w = { .req = req, .buf = render_buf, .len = sizeof(render_buf) };
+    metrics_write_pipeline(&w);
+
+    packet_pool_stats_t pool;
+    packet_pool_get_stats(&pool);
+    metrics_write_gauge(&w, "espnow_rx_queue_depth_current", "Events waiting in s_espnow_queue", espnow_queue_depth());
+    metrics_write_gauge(&w, "packet_pool_in_flight", "Receive slots not yet returned", pool.taken - pool.returned);
+    metrics_write_gauge(&w, "heap_free_bytes", "Free heap", esp_get_free_heap_size());
+    metrics_write_gauge(&w, "heap_min_free_bytes", "Lowest free heap since boot", esp_get_minimum_free_heap_size());
+    metrics_write_gauge(&w, "peers", "Peers in the registry", peer_count());
+
+    flash_log_stats_t flog;
+    flash_log_get_stats(&flog);
+    metrics_write_counter(&w, "flash_log_blocks_written_total", "Blocks written to the tlog partition", flog.blocks_written);
+    metrics_write_counter(&w, "flash_log_records_dropped_total", "Records dropped because the writer fell behind", flog.records_dropped);
+    metrics_write_counter(&w, "flash_log_write_errors_total", "Failed block erases or writes", flog.write_errors);
+
+    char labels[64];
+    for (int i = 0; i < timed_uri_count; i++) {
+        snprintf(labels, sizeof(labels), "uri=\"%s\",method=\"%s\"",
+                 timed_uris[i].uri.uri, http_method_str(timed_uris[i].uri.method));
+        metrics_write_hist(&w, "http_handler_duration_us",
+                           i == 0 ? "HTTP handler run time, microseconds" : NULL,
+                           labels, &timed_uris[i].duration_us);
+    }
+
+    metrics_flush(&w);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+static const httpd_uri_t metrics_uri = {
+    .uri     = "/metrics",
+    .method  = HTTP_GET,
+    .handler = metrics_get_handler,
+    .user_ctx = NULL
+};
+
+_Static_assert(GATE_WAIT_MAX_CLIENTS + STREAM_MAX_CLIENTS < SERVER_MAX_OPEN_SOCKETS,
+               "long-lived clients would leave no socket for plain requests");
+
+httpd_handle_t start(void) {
+    table_lock = xSemaphoreCreateMutex();
+    table = hashtable_create();
+    stream_init();
+    gate_wait_init();
+    static_asset_init(&asset_html);
+    static_asset_init(&asset_css);
+    static_asset_init(&asset_js);
 
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 3000;
-    config.max_uri_handlers = 14;
-    config.lru_purge_enable = true;
+    config.max_uri_handlers = 32;
+    config.max_open_sockets = SERVER_MAX_OPEN_SOCKETS;
+    config.lru_purge_enable = false;
     config.stack_size = 8192;
     config.recv_wait_timeout = 3;
     config.send_wait_timeout = 3;
+    config.open_fn = session_open;
+    config.uri_match_fn = httpd_uri_match_wildcard;   // for /telemetry/* and the OPTIONS /* catch-all
 
     ESP_LOGI(TAG, "Starting server on port: '%d'", config.server_port);
     if (httpd_start(&server, &config) == ESP_OK) {
-        httpd_register_uri_handler(server, &cors_options);
-        httpd_register_uri_handler(server, &status);
-        httpd_register_uri_handler(server, &telemetry_all);
-        httpd_register_uri_handler(server, &telemetry);
-
-        httpd_register_uri_handler(server, &root);
-        httpd_register_uri_handler(server, &index_css);
-        httpd_register_uri_handler(server, &index_js);
-
-        httpd_register_uri_handler(server, &identify_gate);
-        httpd_register_uri_handler(server, &get_gates);
-        httpd_register_uri_handler(server, &get_gates_data);
-        httpd_register_uri_handler(server, &gate_config_get);
-        httpd_register_uri_handler(server, &gate_config_post);
-        httpd_register_uri_handler(server, &gate_history_csv);
-
-        httpd_register_uri_handler(server, &set_logger_name);
+        register_timed(server, &cors_options);
+        register_timed(server, &status);
+        register_timed(server, &telemetry_all);
+        register_timed(server, &telemetry_history);  // before the /telemetry/* catch-all
+        register_timed(server, &telemetry);
+
+        register_timed(server, &root);
+        register_timed(server, &index_css);
+        register_timed(server, &index_js);
+
+        register_timed(server, &identify_gate);
+        register_timed(server, &get_gates);
+        register_timed(server, &get_gates_data);
+        register_timed(server, &get_peers);
+        register_timed(server, &get_sources);
+        register_timed(server, &gate_wait_uri);
+        register_timed(server, &laps_uri);
+        register_timed(server, &gate_config_get);
+        register_timed(server, &gate_config_post);
+        register_timed(server, &gate_history_csv);
+        register_timed(server, &gate_depth_get);
+        register_timed(server, &gate_depth_post);
+
+        register_timed(server, &set_logger_name);
+
+        register_timed(server, &stream_uri);
+        register_timed(server, &stream_ws_uri);
+
+        register_timed(server, &flash_log_download_uri);
+        register_timed(server, &metrics_uri);
 
         return server;
     }
@@ -694,11 +1253,6 @@ void server_start() {
 
     while (server) {
         sleep(1);
-
-        uint32_t time_ms = esp_timer_get_time() / (int64_t)1000;
-        char time_str[16];
-        snprintf(time_str, sizeof(time_str), "%lu", time_ms - lastTelemetryPing);
-        addString("telemetryPing", time_str);
     }
 }
 
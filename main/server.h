@@ -3,11 +3,27 @@
 
 #include <esp_http_server.h>
 #include <stdbool.h>
+#include "peers.h"
 
 void server_start();
 esp_err_t server_stop(httpd_handle_t server);
 void addString(const char* key, const char* value);
-void addGateTime(const char* mac_addr, const char* data);
-void setGateStuck(const char* mac_addr, bool stuck);
+void addGateTime(peer_t* peer, const char* data);
+void setGateStuck(peer_t* peer, bool stuck);
+void set_cors(httpd_req_t *req);
+
+#define SERVER_RENDER_BUF_SIZE 2048
+
+// Socket budget. httpd can hold LWIP_MAX_SOCKETS (10) - 3 sockets. The
+// long-lived ones, GATE_WAIT_MAX_CLIENTS (2) /timing/wait and
+// STREAM_MAX_CLIENTS (3) /stream or /ws clients, leave 2 for plain
+// requests. LRU purge is off: it would close an idle long-poll or stream
+// socket to make room, and those are idle by design.
+#define SERVER_MAX_OPEN_SOCKETS 7
+
+// Render the /telemetry and /timing JSON bodies into buf (NUL-terminated).
+// Elements that do not fit are dropped; the array stays well-formed.
+size_t server_render_telemetry(char* buf, size_t len);
+size_t server_render_timing(char* buf, size_t len);
 
 #endif //ESP32_RECEIVER_SERVER_H
\ No newline at end of file
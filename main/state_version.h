@@ -0,0 +1,31 @@
+#ifndef ESP32_RECEIVER_STATE_VERSION_H
+#define ESP32_RECEIVER_STATE_VERSION_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Monotonic version shared by everything the dashboard polls (telemetry
+// segments, gate timing, addString keys). Each change is stamped with the
+// next version, and the version is published only after the change is
+// visible, so a reader that loads the current version first and then
+// returns entries newer than a client's cursor never skips one. Versions
+// restart from 0 at boot; a cursor ahead of the current version therefore
+// means the receiver rebooted.
+//
+// Writers: espnow_task only (the single-writer assumption above).
+
+extern atomic_uint state_version;
+
+static inline uint32_t state_version_next(void) {
+    return atomic_load_explicit(&state_version, memory_order_relaxed) + 1;
+}
+
+static inline void state_version_publish(uint32_t v) {
+    atomic_store_explicit(&state_version, v, memory_order_release);
+}
+
+static inline uint32_t state_version_current(void) {
+    return atomic_load_explicit(&state_version, memory_order_acquire);
+}
+
+#endif //ESP32_RECEIVER_STATE_VERSION_H
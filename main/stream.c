@@ -0,0 +1,313 @@
+#include "stream.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "server.h"
+#include "telemetry.h"
+
+static const char *TAG = "stream";
+
+typedef enum {
+    STREAM_CLIENT_FREE,
+    STREAM_CLIENT_SSE,
+    STREAM_CLIENT_WS,
+} stream_client_kind_t;
+
+typedef struct {
+    stream_client_kind_t kind;
+    httpd_req_t *req;         // SSE: async copy of the /stream request
+    httpd_handle_t hd;        // WS: server and socket the client lives on
+    int fd;
+    uint32_t interval_ms;     // minimum spacing between telemetry events
+    int64_t last_telemetry_us;
+    int64_t last_send_us;
+    uint32_t pending;         // events not yet delivered to this client
+} stream_client_t;
+
+typedef struct {
+    char buf[SERVER_RENDER_BUF_SIZE + 32]; // "event: <name>\ndata: " + JSON + "\n\n"
+    size_t len;
+    size_t body_off;                       // JSON body alone, for WS text frames
+    size_t body_len;
+} rendered_event_t;
+
+static stream_client_t clients[STREAM_MAX_CLIENTS];
+static SemaphoreHandle_t clients_lock;
+static TaskHandle_t stream_task_handle;
+
+static rendered_event_t telemetry_event;
+static rendered_event_t timing_event;
+static uint8_t telemetry_frame[STREAM_WS_HEADER_LEN + TELEMETRY_PAYLOAD_MAX];
+
+void stream_notify(uint32_t events) {
+    if (stream_task_handle != NULL) {
+        xTaskNotify(stream_task_handle, events, eSetBits);
+    }
+}
+
+static void client_close(stream_client_t *c) {
+    if (c->kind == STREAM_CLIENT_SSE) {
+        httpd_req_async_handler_complete(c->req);
+    }
+    c->kind = STREAM_CLIENT_FREE;
+    c->req = NULL;
+    c->pending = 0;
+}
+
+static bool client_send_ws(stream_client_t *c, httpd_ws_type_t type, const void *data, size_t len) {
+    // The socket may have been closed and reused since the client attached.
+    if (httpd_ws_get_fd_info(c->hd, c->fd) != HTTPD_WS_CLIENT_WEBSOCKET) return false;
+
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = type,
+        .payload = (uint8_t *)data,
+        .len = len,
+    };
+    return httpd_ws_send_frame_async(c->hd, c->fd, &frame) == ESP_OK;
+}
+
+static bool client_done(stream_client_t *c, bool ok, int64_t now) {
+    if (!ok) {
+        ESP_LOGI(TAG, "Stream client disconnected");
+        client_close(c);
+        return false;
+    }
+    c->last_send_us = now;
+    return true;
+}
+
+static bool client_send_timing(stream_client_t *c, int64_t now) {
+    const rendered_event_t *e = &timing_event;
+    bool ok = (c->kind == STREAM_CLIENT_SSE)
+        ? httpd_resp_send_chunk(c->req, e->buf, e->len) == ESP_OK
+        : client_send_ws(c, HTTPD_WS_TYPE_TEXT, e->buf + e->body_off, e->body_len);
+    return client_done(c, ok, now);
+}
+
+static bool client_send_telemetry(stream_client_t *c, size_t frame_len, int64_t now) {
+    const rendered_event_t *e = &telemetry_event;
+    bool ok = (c->kind == STREAM_CLIENT_SSE)
+        ? httpd_resp_send_chunk(c->req, e->buf, e->len) == ESP_OK
+        : client_send_ws(c, HTTPD_WS_TYPE_BINARY, telemetry_frame, frame_len);
+    return client_done(c, ok, now);
+}
+
+static bool client_send_keepalive(stream_client_t *c, int64_t now) {
+    static const char keepalive[] = ": keepalive\n\n";
+    bool ok = (c->kind == STREAM_CLIENT_SSE)
+        ? httpd_resp_send_chunk(c->req, keepalive, sizeof(keepalive) - 1) == ESP_OK
+        : client_send_ws(c, HTTPD_WS_TYPE_PING, NULL, 0);
+    return client_done(c, ok, now);
+}
+
+static void render_event(rendered_event_t *e, const char *name, size_t (*render)(char *, size_t)) {
+    int head = snprintf(e->buf, sizeof(e->buf), "event: %s\ndata: ", name);
+    e->body_off = head;
+    e->body_len = render(e->buf + head, sizeof(e->buf) - head - 2);
+    e->len = head + e->body_len;
+    e->buf[e->len++] = '\n';
+    e->buf[e->len++] = '\n';
+}
+
+// Live pushes carry the default source; others are polled with ?src=.
+static size_t render_telemetry_frame(void) {
+    telemetry_snapshot_t snap;
+    telemetry_snapshot(TELEMETRY_SOURCE_DEFAULT, &snap);
+
+    size_t len = telemetry_frame_len();
+    uint8_t *f = telemetry_frame;
+    f[0] = STREAM_WS_FRAME_TELEMETRY;
+    f[1] = (uint8_t)len;
+    f[2] = (uint8_t)(snap.valid & 0xFF);
+    f[3] = (uint8_t)(snap.valid >> 8);
+    f[4] = (uint8_t)(snap.rx_ms & 0xFF);
+    f[5] = (uint8_t)(snap.rx_ms >> 8);
+    f[6] = (uint8_t)(snap.rx_ms >> 16);
+    f[7] = (uint8_t)(snap.rx_ms >> 24);
+    memcpy(&f[STREAM_WS_HEADER_LEN], snap.raw, len);
+    return STREAM_WS_HEADER_LEN + len;
+}
+
+// Delivers whatever each client is owed and returns how long the task may
+// sleep before a rate-limited client becomes due again.
+static TickType_t stream_flush(uint32_t events) {
+    int64_t now = esp_timer_get_time();
+    int64_t next_due_us = now + (int64_t)STREAM_KEEPALIVE_MS * 1000;
+    bool timing_rendered = false, telemetry_rendered = false;
+    size_t frame_len = 0;
+
+    xSemaphoreTake(clients_lock, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        stream_client_t *c = &clients[i];
+        if (c->kind == STREAM_CLIENT_FREE) continue;
+        c->pending |= events;
+
+        // Gate events are rare and latency-sensitive: never rate limited.
+        if (c->pending & STREAM_EVENT_TIMING) {
+            if (!timing_rendered) {
+                render_event(&timing_event, "timing", server_render_timing);
+                timing_rendered = true;
+            }
+            if (!client_send_timing(c, now)) continue;
+            c->pending &= ~STREAM_EVENT_TIMING;
+        }
+
+        if (c->pending & STREAM_EVENT_TELEMETRY) {
+            int64_t due = c->last_telemetry_us + (int64_t)c->interval_ms * 1000;
+            if (now >= due) {
+                if (c->kind == STREAM_CLIENT_SSE && !telemetry_rendered) {
+                    render_event(&telemetry_event, "telemetry", server_render_telemetry);
+                    telemetry_rendered = true;
+                } else if (c->kind == STREAM_CLIENT_WS && frame_len == 0) {
+                    frame_len = render_telemetry_frame();
+                }
+                if (!client_send_telemetry(c, frame_len, now)) continue;
+                c->last_telemetry_us = now;
+                c->pending &= ~STREAM_EVENT_TELEMETRY;
+            } else if (due < next_due_us) {
+                next_due_us = due;
+            }
+        }
+
+        int64_t keepalive_due = c->last_send_us + (int64_t)STREAM_KEEPALIVE_MS * 1000;
+        if (now >= keepalive_due) {
+            client_send_keepalive(c, now);
+        } else if (keepalive_due < next_due_us) {
+            next_due_us = keepalive_due;
+        }
+    }
+    xSemaphoreGive(clients_lock);
+
+    int64_t wait_ms = (next_due_us - now) / 1000;
+    return pdMS_TO_TICKS(wait_ms > 0 ? wait_ms : 1);
+}
+
+static void stream_task(void *pvParameter) {
+    TickType_t wait = portMAX_DELAY;
+    for (;;) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+        wait = stream_flush(events);
+    }
+}
+
+static uint32_t parse_interval(httpd_req_t *req) {
+    uint32_t interval_ms = STREAM_DEFAULT_INTERVAL_MS;
+    char query[32], param[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "interval_ms", param, sizeof(param)) == ESP_OK) {
+        long v = strtol(param, NULL, 10);
+        if (v < STREAM_MIN_INTERVAL_MS) v = STREAM_MIN_INTERVAL_MS;
+        if (v > STREAM_MAX_INTERVAL_MS) v = STREAM_MAX_INTERVAL_MS;
+        interval_ms = (uint32_t)v;
+    }
+    return interval_ms;
+}
+
+// httpd runs handlers on a single task, so a slot found free here stays free
+// until the handler fills it in.
+static stream_client_t* find_free_client(void) {
+    stream_client_t *slot = NULL;
+    xSemaphoreTake(clients_lock, portMAX_DELAY);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].kind == STREAM_CLIENT_FREE) {
+            slot = &clients[i];
+            break;
+        }
+    }
+    xSemaphoreGive(clients_lock);
+    return slot;
+}
+
+static void attach_client(stream_client_t *slot, stream_client_kind_t kind, uint32_t interval_ms) {
+    xSemaphoreTake(clients_lock, portMAX_DELAY);
+    slot->kind = kind;
+    slot->interval_ms = interval_ms;
+    slot->last_telemetry_us = 0;
+    slot->last_send_us = esp_timer_get_time();
+    slot->pending = STREAM_EVENT_TELEMETRY | STREAM_EVENT_TIMING;  // send current state first
+    xSemaphoreGive(clients_lock);
+
+    ESP_LOGI(TAG, "%s client attached (interval %lu ms)", kind == STREAM_CLIENT_WS ? "WebSocket" : "SSE", interval_ms);
+    stream_notify(0);
+}
+
+static esp_err_t stream_get_handler(httpd_req_t *req) {
+    set_cors(req);
+
+    stream_client_t *slot = find_free_client();
+    if (slot == NULL) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_send(req, "Too many stream clients", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "text/event-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    // Flush the headers from the handler itself; the stream task only ever
+    // appends chunks to the detached request.
+    static const char hello[] = "retry: 2000\n\n";
+    if (httpd_resp_send_chunk(req, hello, sizeof(hello) - 1) != ESP_OK) return ESP_FAIL;
+
+    httpd_req_t *async_req = NULL;
+    if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to detach stream request");
+        return ESP_FAIL;
+    }
+
+    slot->req = async_req;
+    attach_client(slot, STREAM_CLIENT_SSE, parse_interval(req));
+    return ESP_OK;
+}
+
+static esp_err_t stream_ws_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        // Handshake complete
+        stream_client_t *slot = find_free_client();
+        if (slot == NULL) {
+            ESP_LOGW(TAG, "Too many stream clients, refusing WebSocket");
+            return ESP_FAIL;
+        }
+        slot->hd = req->handle;
+        slot->fd = httpd_req_to_sockfd(req);
+        attach_client(slot, STREAM_CLIENT_WS, parse_interval(req));
+        return ESP_OK;
+    }
+
+    // Clients have nothing to tell us; drain and ignore whatever they send.
+    uint8_t buf[32];
+    httpd_ws_frame_t frame = { .payload = buf };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) return ret;
+    if (frame.len > sizeof(buf)) return ESP_FAIL;
+    return frame.len ? httpd_ws_recv_frame(req, &frame, frame.len) : ESP_OK;
+}
+
+const httpd_uri_t stream_uri = {
+    .uri       = "/stream",
+    .method    = HTTP_GET,
+    .handler   = stream_get_handler,
+    .user_ctx  = NULL
+};
+
+const httpd_uri_t stream_ws_uri = {
+    .uri          = "/ws",
+    .method       = HTTP_GET,
+    .handler      = stream_ws_handler,
+    .user_ctx     = NULL,
+    .is_websocket = true
+};
+
+void stream_init(void) {
+    clients_lock = xSemaphoreCreateMutex();
+    xTaskCreate(stream_task, "stream", 4096, NULL, 3, &stream_task_handle);
+}
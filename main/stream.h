@@ -0,0 +1,38 @@
+#ifndef ESP32_RECEIVER_STREAM_H
+#define ESP32_RECEIVER_STREAM_H
+
+#include <esp_http_server.h>
+#include <stdint.h>
+
+// Push of telemetry frames and gate events to connected dashboards, over
+// Server-Sent Events (/stream) or a WebSocket (/ws). espnow_task (and the gate
+// state setters) call stream_notify(); a dedicated task renders the current
+// state once and fans it out to every client.
+//
+// WebSocket clients get telemetry as a binary frame:
+//   u8  type        STREAM_WS_FRAME_TELEMETRY
+//   u8  len         payload bytes that follow the header
+//   u16 valid       bit s set once segments[s] has been received (LE)
+//   u32 rx_ms       receiver uptime when the frame arrived (LE)
+//   u8  payload[len] raw telemetry bytes, laid out by segments[]
+// and gate events as a text frame holding the /timing JSON.
+
+#define STREAM_MAX_CLIENTS 3            // each holds a socket; see SERVER_MAX_OPEN_SOCKETS
+#define STREAM_DEFAULT_INTERVAL_MS 100   // per-client telemetry rate limit
+#define STREAM_MIN_INTERVAL_MS 20
+#define STREAM_MAX_INTERVAL_MS 5000
+#define STREAM_KEEPALIVE_MS 15000
+
+#define STREAM_EVENT_TELEMETRY (1u << 0)
+#define STREAM_EVENT_TIMING    (1u << 1)
+
+#define STREAM_WS_FRAME_TELEMETRY 0x01
+#define STREAM_WS_HEADER_LEN 8
+
+void stream_init(void);
+void stream_notify(uint32_t events);
+
+extern const httpd_uri_t stream_uri;
+extern const httpd_uri_t stream_ws_uri;
+
+#endif //ESP32_RECEIVER_STREAM_H
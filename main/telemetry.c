@@ -0,0 +1,234 @@
+#include "telemetry.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "fmt.h"
+#include "peers.h"
+#include "protocol.h"
+#include "seqlock.h"
+#include "state_version.h"
+#include "telemetry_schema.h"
+
+static const char *TAG = "telemetry";
+
+typedef struct {
+    telemetry_snapshot_t state;
+    telemetry_source_info_t info;       // under the same seqlock as state
+    uint32_t window_start_ms;
+    uint32_t window_frames;
+    seqlock_t lock;
+} source_t;
+
+static source_t *sources;               // TELEMETRY_MAX_SOURCES, from telemetry_init()
+static atomic_int source_count;         // slots [0, count) have their mac set
+static int8_t peer_source[PEER_MAX];    // espnow_task only: source per peer index, -1 unbound
+static atomic_uint unbound_frames;
+
+esp_err_t telemetry_init(void) {
+    sources = calloc(TELEMETRY_MAX_SOURCES, sizeof(source_t));
+    if (sources == NULL) {
+        ESP_LOGE(TAG, "Not enough heap for %d telemetry sources", TELEMETRY_MAX_SOURCES);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(peer_source, -1, sizeof(peer_source));
+    ESP_LOGI(TAG, "Telemetry: %d sources, %u bytes", TELEMETRY_MAX_SOURCES,
+             (unsigned)(TELEMETRY_MAX_SOURCES * sizeof(source_t)));
+    return ESP_OK;
+}
+
+static int bind_source(int peer_idx, const uint8_t *mac, uint32_t now_ms) {
+    int n = atomic_load_explicit(&source_count, memory_order_relaxed);
+    if (n == TELEMETRY_MAX_SOURCES) {
+        ESP_LOGW(TAG, "Telemetry source table full, dropping frames from " MACSTR, MAC2STR(mac));
+        return -1;
+    }
+    source_t *src = &sources[n];
+    memcpy(src->info.mac, mac, sizeof(src->info.mac));
+    src->info.first_ms = now_ms;
+    src->window_start_ms = now_ms;
+    atomic_store_explicit(&source_count, n + 1, memory_order_release);
+    peer_source[peer_idx] = (int8_t)n;
+    ESP_LOGI(TAG, "Telemetry source %d: " MACSTR, n, MAC2STR(mac));
+    return n;
+}
+
+int telemetry_update(int peer_idx, const uint8_t *mac, const uint8_t *payload, size_t len, uint32_t now_ms) {
+    if (sources == NULL || peer_idx < 0 || peer_idx >= PEER_MAX) {
+        atomic_fetch_add_explicit(&unbound_frames, 1, memory_order_relaxed);
+        return -1;
+    }
+    int slot = peer_source[peer_idx];
+    if (slot == -1) {
+        slot = bind_source(peer_idx, mac, now_ms);
+        if (slot < 0) peer_source[peer_idx] = -2;   // warn once per sender
+    }
+    if (slot < 0) {
+        atomic_fetch_add_explicit(&unbound_frames, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    source_t *src = &sources[slot];
+    telemetry_snapshot_t *state = &src->state;
+    uint32_t version = state_version_next();
+    bool is_short = len < telemetry_frame_len();
+
+    seqlock_write_begin(&src->lock);
+    for (int s = 0; s < NUM_SEGMENTS && s < TELEMETRY_MAX_SEGMENTS; s++) {
+        size_t end = (size_t)segments[s].offset + segments[s].len;
+        if (end > len || end > sizeof(state->raw)) continue;
+
+        uint8_t *dst = &state->raw[segments[s].offset];
+        const uint8_t *from = &payload[segments[s].offset];
+        if (!(state->valid & (1u << s)) || memcmp(dst, from, segments[s].len) != 0) {
+            memcpy(dst, from, segments[s].len);
+            state->seg_version[s] = version;
+        }
+        state->valid |= 1u << s;
+    }
+    state->rx_ms = now_ms;
+    state->rx_version = version;
+
+    src->info.frames++;
+    if (is_short) src->info.short_frames++;
+    src->info.last_ms = now_ms;
+    src->window_frames++;
+    uint32_t elapsed = now_ms - src->window_start_ms;
+    if (elapsed >= TELEMETRY_RATE_WINDOW_MS) {
+        src->info.rate_hz = src->window_frames * 1000 / elapsed;
+        src->window_start_ms = now_ms;
+        src->window_frames = 0;
+    }
+    seqlock_write_end(&src->lock);
+    state_version_publish(version);
+
+    // Shorter frames only update a prefix of the segments.
+    if (is_short) {
+        ESP_LOGW(TAG, "Packet too short for segment %s (pkt_len=%zu), kept previous values",
+                 segments[NUM_SEGMENTS - 1].name, len);
+    }
+    return slot;
+}
+
+void telemetry_snapshot(int src, telemetry_snapshot_t *out) {
+    if (src < 0 || src >= telemetry_source_count()) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    source_t *s = &sources[src];
+    unsigned seq;
+    do {
+        seq = seqlock_read_begin(&s->lock);
+        memcpy(out, &s->state, sizeof(*out));
+    } while (seqlock_read_retry(&s->lock, seq));
+}
+
+int telemetry_source_count(void) {
+    return atomic_load_explicit(&source_count, memory_order_acquire);
+}
+
+int telemetry_find_source(const uint8_t *mac) {
+    int n = telemetry_source_count();
+    for (int i = 0; i < n; i++) {
+        if (memcmp(sources[i].info.mac, mac, sizeof(sources[i].info.mac)) == 0) return i;
+    }
+    return -1;
+}
+
+bool telemetry_source_info(int src, telemetry_source_info_t *out) {
+    if (src < 0 || src >= telemetry_source_count()) return false;
+    source_t *s = &sources[src];
+    unsigned seq;
+    do {
+        seq = seqlock_read_begin(&s->lock);
+        *out = s->info;
+    } while (seqlock_read_retry(&s->lock, seq));
+    return true;
+}
+
+uint32_t telemetry_unbound_frames(void) {
+    return atomic_load_explicit(&unbound_frames, memory_order_relaxed);
+}
+
+size_t telemetry_frame_len(void) {
+    const segment_t *last = &segments[NUM_SEGMENTS - 1];
+    return (size_t)last->offset + last->len;
+}
+
+bool telemetry_segment_valid(const telemetry_snapshot_t *snap, int seg) {
+    return seg >= 0 && seg < NUM_SEGMENTS && (snap->valid & (1u << seg));
+}
+
+int telemetry_find_segment(const char *name) {
+    for (int s = 0; s < NUM_SEGMENTS; s++) {
+        if (strcmp(segments[s].name, name) == 0) return s;
+    }
+    return -1;
+}
+
+int telemetry_format_segment(const telemetry_snapshot_t *snap, int seg, char *out, size_t out_len) {
+    static const char hex[] = "0123456789ABCDEF";
+    if (!telemetry_segment_valid(snap, seg) || out_len == 0) return -1;
+
+    const uint8_t *d = &snap->raw[segments[seg].offset];
+    size_t pos = 0;
+    for (int b = 0; b < segments[seg].len && pos + 3 < out_len; b++) {
+        if (b) out[pos++] = ' ';
+        out[pos++] = hex[d[b] >> 4];
+        out[pos++] = hex[d[b] & 0xF];
+    }
+    out[pos] = '\0';
+    return (int)pos;
+}
+
+int32_t telemetry_field_raw(const telemetry_field_t *f, const uint8_t *payload) {
+    const uint8_t *d = &payload[f->offset];
+    if (f->type == TELEMETRY_U8) return d[0];
+
+    uint16_t v = f->big_endian ? (uint16_t)((d[0] << 8) | d[1]) : (uint16_t)(d[0] | (d[1] << 8));
+    return f->type == TELEMETRY_I16 ? (int16_t)v : v;
+}
+
+int32_t telemetry_field_scaled(const telemetry_field_t *f, int32_t raw) {
+    static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+    int64_t n = (int64_t)raw * f->scale_num * pow10[f->decimals];
+    int64_t den = f->scale_den;
+    return (int32_t)((2 * n + (n < 0 ? -den : den)) / (2 * den));
+}
+
+int telemetry_format_field(const telemetry_field_t *f, int32_t raw, char *out, size_t out_len) {
+    if (f->label_count) {
+        int i = raw < 0 ? 0 : raw >= f->label_count ? f->label_count - 1 : raw;
+        size_t n = strlen(f->labels[i]);
+        if (n >= out_len) return -1;
+        memcpy(out, f->labels[i], n + 1);
+        return (int)n;
+    }
+
+    if (out_len <= FMT_FIXED_MAX) return -1;
+    size_t n = fmt_fixed(out, telemetry_field_scaled(f, raw), f->decimals);
+    out[n] = '\0';
+    return (int)n;
+}
+
+int telemetry_format_decoded(const telemetry_snapshot_t *snap, int seg, char *out, size_t out_len) {
+    if (!telemetry_segment_valid(snap, seg) || out_len == 0) return -1;
+
+    const telemetry_field_t *f = &telemetry_fields[segments[seg].first_field];
+    size_t pos = 0;
+    out[0] = '\0';
+    for (int i = 0; i < segments[seg].field_count; i++, f++) {
+        if (i) {
+            if (pos + 1 >= out_len) break;
+            out[pos++] = ',';
+            out[pos] = '\0';
+        }
+        int n = telemetry_format_field(f, telemetry_field_raw(f, snap->raw), out + pos, out_len - pos);
+        if (n < 0) break;
+        pos += n;
+    }
+    return (int)pos;
+}
@@ -0,0 +1,81 @@
+#ifndef ESP32_RECEIVER_TELEMETRY_H
+#define ESP32_RECEIVER_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "protocol.h"
+
+// Decoded telemetry is kept as the raw payload bytes of the latest frame,
+// laid out exactly as described by segments[]. Nothing is formatted until a
+// client asks for it.
+//
+// State is kept per source MAC so two transmitters on the channel do not
+// overwrite each other. Sources are bound in the order they first send, up
+// to TELEMETRY_MAX_SOURCES; the table is allocated once by telemetry_init()
+// and frames from further senders are counted and dropped. Finding a
+// sender's source is an array lookup by peer index.
+
+#define TELEMETRY_PAYLOAD_MAX 200
+#define TELEMETRY_VALUE_MAX 64
+#define TELEMETRY_MAX_SEGMENTS 32       // width of the valid mask
+#define TELEMETRY_MAX_SOURCES 4
+#define TELEMETRY_SOURCE_DEFAULT 0      // the first source heard; used when a client names none
+#define TELEMETRY_RATE_WINDOW_MS 1000
+
+typedef struct {
+    uint8_t raw[TELEMETRY_PAYLOAD_MAX]; // latest bytes, indexed by segments[].offset
+    uint32_t valid;                     // bit s set once segments[s] has been received
+    uint32_t rx_ms;                     // arrival time of the latest frame
+    uint32_t rx_version;                // state version of the latest frame
+    uint32_t seg_version[TELEMETRY_MAX_SEGMENTS]; // state version of the last change to segments[s]
+} telemetry_snapshot_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint32_t frames;
+    uint32_t short_frames;              // did not cover every segment
+    uint32_t first_ms;
+    uint32_t last_ms;
+    uint32_t rate_hz;                   // frames per second over the last complete window
+} telemetry_source_info_t;
+
+esp_err_t telemetry_init(void);
+
+// Writer side — espnow_task only. peer_idx is peer_index() of the sender.
+// Returns the source index, or -1 when the source table is full.
+int telemetry_update(int peer_idx, const uint8_t *mac, const uint8_t *payload, size_t len, uint32_t now_ms);
+
+// Reader side — any task. Copies a consistent frame without blocking the
+// writer. A source that has not sent yet reads as an empty snapshot.
+void telemetry_snapshot(int src, telemetry_snapshot_t *out);
+
+int telemetry_source_count(void);
+int telemetry_find_source(const uint8_t *mac);   // -1 if never heard
+bool telemetry_source_info(int src, telemetry_source_info_t *out);
+// Frames dropped because every source slot was taken.
+uint32_t telemetry_unbound_frames(void);
+
+// Bytes covered by segments[]; frames carry at least this much payload.
+size_t telemetry_frame_len(void);
+
+bool telemetry_segment_valid(const telemetry_snapshot_t *snap, int seg);
+int telemetry_find_segment(const char *name);
+// Space-separated hex bytes of a segment, the form /telemetry rows carry
+// and the dashboard decodes with the same schema.
+int telemetry_format_segment(const telemetry_snapshot_t *snap, int seg, char *out, size_t out_len);
+// The segment's fields decoded through telemetry_fields[], comma-separated
+// and without units, e.g. "1.23,-0.40,9.81".
+int telemetry_format_decoded(const telemetry_snapshot_t *snap, int seg, char *out, size_t out_len);
+
+// Integer value of f in a payload laid out as segments[].
+int32_t telemetry_field_raw(const telemetry_field_t *f, const uint8_t *payload);
+// raw * scale in units of 10^-f->decimals of f->unit (centi-deg/s for the
+// gyro, for instance), rounded half away from zero in integer arithmetic.
+int32_t telemetry_field_scaled(const telemetry_field_t *f, int32_t raw);
+// The scaled value with the decimal point inserted, or the field's label.
+// Matches formatField() in the dashboard exactly. -1 if out is too small.
+int telemetry_format_field(const telemetry_field_t *f, int32_t raw, char *out, size_t out_len);
+
+#endif //ESP32_RECEIVER_TELEMETRY_H
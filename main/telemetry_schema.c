@@ -0,0 +1,69 @@
+// Generated by tools/gen_telemetry.py from tools/telemetry_schema.json. Do not edit.
+#include "telemetry_schema.h"
+
+static const char *const labels_0[] = { "Closed", "Open" };
+static const char *const labels_27[] = { "No", "Yes" };
+
+const segment_t segments[] = {
+    { .id = 0x01, .len = 1, .offset = 0, .name = "drs", .first_field = 0, .field_count = 1 },
+    { .id = 0x02, .len = 6, .offset = 1, .name = "imu_gyro", .first_field = 1, .field_count = 3 },
+    { .id = 0x03, .len = 6, .offset = 7, .name = "imu_accel", .first_field = 4, .field_count = 3 },
+    { .id = 0x04, .len = 6, .offset = 13, .name = "wheel_fl", .first_field = 7, .field_count = 3 },
+    { .id = 0x05, .len = 6, .offset = 19, .name = "wheel_fr", .first_field = 10, .field_count = 3 },
+    { .id = 0x06, .len = 6, .offset = 25, .name = "wheel_rr", .first_field = 13, .field_count = 3 },
+    { .id = 0x07, .len = 6, .offset = 31, .name = "wheel_rl", .first_field = 16, .field_count = 3 },
+    { .id = 0x08, .len = 2, .offset = 37, .name = "sg_fl", .first_field = 19, .field_count = 1 },
+    { .id = 0x09, .len = 2, .offset = 39, .name = "sg_fr", .first_field = 20, .field_count = 1 },
+    { .id = 0x0A, .len = 2, .offset = 41, .name = "sg_rr", .first_field = 21, .field_count = 1 },
+    { .id = 0x0B, .len = 2, .offset = 43, .name = "sg_rl", .first_field = 22, .field_count = 1 },
+    { .id = 0x0C, .len = 7, .offset = 45, .name = "eng_f0", .first_field = 23, .field_count = 5 },
+    { .id = 0x0D, .len = 7, .offset = 52, .name = "eng_f1", .first_field = 28, .field_count = 5 },
+    { .id = 0x0E, .len = 4, .offset = 59, .name = "eng_f2", .first_field = 33, .field_count = 2 },
+    { .id = 0x0F, .len = 3, .offset = 63, .name = "shifter", .first_field = 35, .field_count = 3 },
+};
+const int NUM_SEGMENTS = sizeof(segments) / sizeof(segments[0]);
+
+const telemetry_field_t telemetry_fields[TELEMETRY_NUM_FIELDS] = {
+    { .name = "State", .unit = "", .series = NULL, .labels = labels_0, .label_count = 2, .offset = 0, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "X", .unit = "°/s", .series = "gyro_x", .labels = NULL, .label_count = 0, .offset = 1, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 7, .scale_den = 400 },
+    { .name = "Y", .unit = "°/s", .series = "gyro_y", .labels = NULL, .label_count = 0, .offset = 3, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 7, .scale_den = 400 },
+    { .name = "Z", .unit = "°/s", .series = "gyro_z", .labels = NULL, .label_count = 0, .offset = 5, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 7, .scale_den = 400 },
+    { .name = "X", .unit = "mg", .series = "accel_x", .labels = NULL, .label_count = 0, .offset = 7, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 61, .scale_den = 500 },
+    { .name = "Y", .unit = "mg", .series = "accel_y", .labels = NULL, .label_count = 0, .offset = 9, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 61, .scale_den = 500 },
+    { .name = "Z", .unit = "mg", .series = "accel_z", .labels = NULL, .label_count = 0, .offset = 11, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 2, .scale_num = 61, .scale_den = 500 },
+    { .name = "Speed", .unit = "rpm", .series = "wheel_fl_speed", .labels = NULL, .label_count = 0, .offset = 13, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Temp", .unit = "°C", .series = NULL, .labels = NULL, .label_count = 0, .offset = 15, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Load", .unit = "N", .series = NULL, .labels = NULL, .label_count = 0, .offset = 17, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Speed", .unit = "rpm", .series = "wheel_fr_speed", .labels = NULL, .label_count = 0, .offset = 19, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Temp", .unit = "°C", .series = NULL, .labels = NULL, .label_count = 0, .offset = 21, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Load", .unit = "N", .series = NULL, .labels = NULL, .label_count = 0, .offset = 23, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Speed", .unit = "rpm", .series = "wheel_rr_speed", .labels = NULL, .label_count = 0, .offset = 25, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Temp", .unit = "°C", .series = NULL, .labels = NULL, .label_count = 0, .offset = 27, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Load", .unit = "N", .series = NULL, .labels = NULL, .label_count = 0, .offset = 29, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Speed", .unit = "rpm", .series = "wheel_rl_speed", .labels = NULL, .label_count = 0, .offset = 31, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Temp", .unit = "°C", .series = NULL, .labels = NULL, .label_count = 0, .offset = 33, .type = TELEMETRY_I16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Load", .unit = "N", .series = NULL, .labels = NULL, .label_count = 0, .offset = 35, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Pos", .unit = "", .series = "sg_fl", .labels = NULL, .label_count = 0, .offset = 37, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Pos", .unit = "", .series = "sg_fr", .labels = NULL, .label_count = 0, .offset = 39, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Pos", .unit = "", .series = "sg_rr", .labels = NULL, .label_count = 0, .offset = 41, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Pos", .unit = "", .series = "sg_rl", .labels = NULL, .label_count = 0, .offset = 43, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "RPM", .unit = "rpm", .series = "rpm", .labels = NULL, .label_count = 0, .offset = 45, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "ECT", .unit = "°C", .series = "ect", .labels = NULL, .label_count = 0, .offset = 47, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Oil Temp", .unit = "°C", .series = "oil_temp", .labels = NULL, .label_count = 0, .offset = 48, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Oil Press", .unit = "kPa", .series = "oil_press", .labels = NULL, .label_count = 0, .offset = 49, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Neutral", .unit = "", .series = NULL, .labels = labels_27, .label_count = 2, .offset = 51, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Lambda", .unit = "", .series = "lambda", .labels = NULL, .label_count = 0, .offset = 52, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "TPS", .unit = "%", .series = "tps", .labels = NULL, .label_count = 0, .offset = 53, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Gear", .unit = "", .series = "gear", .labels = NULL, .label_count = 0, .offset = 54, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "WSPD", .unit = "km/h", .series = "wspd", .labels = NULL, .label_count = 0, .offset = 55, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Oil Press", .unit = "kPa", .series = NULL, .labels = NULL, .label_count = 0, .offset = 57, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "APS", .unit = "", .series = "aps", .labels = NULL, .label_count = 0, .offset = 59, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "Fuel Press", .unit = "kPa", .series = "fuel_press", .labels = NULL, .label_count = 0, .offset = 61, .type = TELEMETRY_U16, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "S0", .unit = "", .series = NULL, .labels = NULL, .label_count = 0, .offset = 63, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "S1", .unit = "", .series = NULL, .labels = NULL, .label_count = 0, .offset = 64, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+    { .name = "S2", .unit = "", .series = NULL, .labels = NULL, .label_count = 0, .offset = 65, .type = TELEMETRY_U8, .big_endian = 1, .decimals = 0, .scale_num = 1, .scale_den = 1 },
+};
+
+const uint8_t telemetry_series[TELEMETRY_NUM_SERIES] = {
+    1, 2, 3, 4, 5, 6, 7, 10, 13, 16, 19, 20, 21, 22, 23, 24, 25, 26, 28, 29, 30, 31, 33, 34,
+};
@@ -0,0 +1,15 @@
+// Generated by tools/gen_telemetry.py from tools/telemetry_schema.json. Do not edit.
+#ifndef ESP32_RECEIVER_TELEMETRY_SCHEMA_H
+#define ESP32_RECEIVER_TELEMETRY_SCHEMA_H
+
+#include "protocol.h"
+
+#define TELEMETRY_NUM_FIELDS 38
+#define TELEMETRY_NUM_SERIES 24
+#define TELEMETRY_FRAME_LEN 66
+
+extern const telemetry_field_t telemetry_fields[TELEMETRY_NUM_FIELDS];
+// Index into telemetry_fields[] of each field recorded in history, in schema order.
+extern const uint8_t telemetry_series[TELEMETRY_NUM_SERIES];
+
+#endif //ESP32_RECEIVER_TELEMETRY_SCHEMA_H
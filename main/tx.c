@@ -0,0 +1,87 @@
+#include "tx.h"
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "metrics.h"
+
+static const char *TAG = "tx";
+
+static atomic_uint tx_seq;   // shared by every outbound message type
+
+esp_err_t tx_ensure_peer(const uint8_t *mac) {
+    if (esp_now_is_peer_exist(mac)) return ESP_OK;
+
+    esp_now_peer_info_t peer = {
+        .channel = 1,
+        .ifidx = ESP_IF_WIFI_STA,
+        .encrypt = false,
+    };
+    memcpy(peer.peer_addr, mac, ESP_NOW_ETH_ALEN);
+    esp_err_t ret = esp_now_add_peer(&peer);
+    // Another task may have added it between the check and the add.
+    if (ret == ESP_ERR_ESPNOW_EXIST) return ESP_OK;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Add peer " MACSTR " failed: %s", MAC2STR(mac), esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t tx_send(const uint8_t *mac, espnow_data_t *frame) {
+    esp_err_t ret = tx_ensure_peer(mac);
+    if (ret != ESP_OK) return ret;
+
+    espnow_frame_seal(frame);
+    size_t len = espnow_frame_len(frame);
+    ret = esp_now_send(mac, (const uint8_t *)frame, len);
+    if (ret == ESP_OK) metrics_tx_frame(len, sizeof(espnow_data_t));
+    return ret;
+}
+
+static void tx_header(espnow_data_t *frame, espnow_msg_type_t type, uint16_t seq) {
+    frame->type = type;
+    frame->seq_num = seq;
+    frame->len = 0;
+}
+
+static uint16_t next_seq(void) {
+    return (uint16_t)atomic_fetch_add_explicit(&tx_seq, 1, memory_order_relaxed);
+}
+
+esp_err_t tx_ack(const uint8_t *mac) {
+    espnow_data_t frame;
+    tx_header(&frame, ESPNOW_DATA_ACK, next_seq());
+    return tx_send(mac, &frame);
+}
+
+esp_err_t tx_ping(const uint8_t *mac) {
+    espnow_data_t frame;
+    tx_header(&frame, ESPNOW_DATA_PING, next_seq());
+    return tx_send(mac, &frame);
+}
+
+esp_err_t tx_ok(const uint8_t *mac, uint16_t acked_seq) {
+    espnow_data_t frame;
+    tx_header(&frame, ESPNOW_DATA_OK, acked_seq);
+    return tx_send(mac, &frame);
+}
+
+esp_err_t tx_ident(const uint8_t *mac) {
+    espnow_data_t frame;
+    tx_header(&frame, ESPNOW_GATE_IDENT, next_seq());
+    return tx_send(mac, &frame);
+}
+
+// Sent as ESPNOW_GATE_IDENT with the NUL-terminated name as payload, which
+// is what the loggers in the field expect.
+esp_err_t tx_set_logger_name(const uint8_t *mac, const char *name) {
+    espnow_data_t frame;
+    tx_header(&frame, ESPNOW_GATE_IDENT, next_seq());
+    size_t name_len = strnlen(name, sizeof(frame.data) - 1);
+    memcpy(frame.data, name, name_len);
+    frame.data[name_len] = '\0';
+    frame.len = (uint8_t)(name_len + 1);
+    return tx_send(mac, &frame);
+}
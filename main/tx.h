@@ -0,0 +1,26 @@
+#ifndef ESP32_RECEIVER_TX_H
+#define ESP32_RECEIVER_TX_H
+
+#include <esp_err.h>
+#include <stdint.h>
+#include "protocol.h"
+
+// Outbound ESP-NOW control messages. Each builder fills a frame on the
+// caller's stack (header plus only the payload it needs), stamps the next
+// sequence number, seals the CRC, makes sure the destination is a
+// registered ESP-NOW peer and sends header + len bytes. esp_now_send copies
+// the frame, so nothing is allocated and any task may call these.
+//
+// Everything below goes through esp_now_is_peer_exist/esp_now_add_peer/
+// esp_now_send only, so the module links against a mocked ESP-NOW on host.
+
+// Registers mac with ESP-NOW (channel 1, STA interface) unless it already is.
+esp_err_t tx_ensure_peer(const uint8_t *mac);
+
+esp_err_t tx_ack(const uint8_t *mac);
+esp_err_t tx_ping(const uint8_t *mac);
+esp_err_t tx_ok(const uint8_t *mac, uint16_t acked_seq);   // echoes the sender's seq
+esp_err_t tx_ident(const uint8_t *mac);
+esp_err_t tx_set_logger_name(const uint8_t *mac, const char *name);
+
+#endif //ESP32_RECEIVER_TX_H
@@ -0,0 +1,40 @@
+#include "alloc_count.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+atomic_ulong host_alloc_calls;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add(&host_alloc_calls, 1);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    atomic_fetch_add(&host_alloc_calls, 1);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    atomic_fetch_add(&host_alloc_calls, 1);
+    return __real_realloc(p, size);
+}
+
+// glibc's strdup allocates internally, out of reach of --wrap=malloc.
+char *__wrap_strdup(const char *s) {
+    size_t n = strlen(s) + 1;
+    char *p = __wrap_malloc(n);
+    if (p) memcpy(p, s, n);
+    return p;
+}
+
+bool host_alloc_count_live(void) {
+    unsigned long before = host_allocs();
+    void *volatile p = malloc(16);
+    free(p);
+    return host_allocs() - before == 1;
+}
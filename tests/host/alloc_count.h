@@ -0,0 +1,21 @@
+#ifndef HOST_ALLOC_COUNT_H
+#define HOST_ALLOC_COUNT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Heap calls made from code linked into the test (malloc, calloc, realloc
+// and strdup), counted through ld --wrap. Tests linked with ALLOC_COUNT
+// only; read before and after the code under test.
+extern atomic_ulong host_alloc_calls;
+
+static inline unsigned long host_allocs(void) {
+    return atomic_load(&host_alloc_calls);
+}
+
+// True when a heap call made through this binary is counted, i.e. the wrap
+// is linked in. The call goes through a volatile pointer so the compiler
+// cannot drop the malloc/free pair at -O1 and above.
+bool host_alloc_count_live(void);
+
+#endif //HOST_ALLOC_COUNT_H
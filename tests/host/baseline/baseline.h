@@ -0,0 +1,44 @@
+#ifndef HOST_BASELINE_H
+#define HOST_BASELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Receiver code as it was before the rewrites the benchmarks measure: the
+// original hash.c (strdup per insert), the decode loop from espnow_task that
+// formatted every segment into that table on each packet, and the HTTP
+// handlers that sent every row and comma as its own chunk. Kept only for
+// comparison; symbols are prefixed baseline_.
+
+struct BaselineHashTable {
+    int size;
+    char **bucket;
+    char **values;
+};
+
+struct BaselineHashTable baseline_hashtable_create(void);
+void baseline_hashtable_insert(struct BaselineHashTable *table, const char *key, const char *value);
+const char *baseline_hashtable_get(struct BaselineHashTable *table, const char *key);
+void baseline_hashtable_free(struct BaselineHashTable *table);
+
+// One ESP_NOW_TELEMETRY payload, decoded as espnow_task used to.
+void baseline_decode_telemetry(struct BaselineHashTable *table, const uint8_t *payload,
+                               size_t payload_len, uint32_t time_ms);
+// Its float formatting of the 6-byte IMU gyro and accel segments.
+void baseline_format_gyro(const uint8_t *segment, char *out, size_t out_len);
+void baseline_format_accel(const uint8_t *segment, char *out, size_t out_len);
+
+typedef struct {
+    char mac[18];
+    int series;         // GATE_MODE_SERIES, else delta
+    char group[16];
+    int order;
+} baseline_gate_config_t;
+
+// The old /gates, /gate-config and /telemetry/all handler bodies.
+void baseline_render_gates(httpd_req_t *req, const char (*macs)[18], int count);
+void baseline_render_gate_config(httpd_req_t *req, const baseline_gate_config_t *configs, int count);
+void baseline_render_telemetry_all(httpd_req_t *req, struct BaselineHashTable *table);
+
+#endif //HOST_BASELINE_H
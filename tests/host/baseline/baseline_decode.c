@@ -0,0 +1,82 @@
+// The ESPNOW_TELEMETRY branch of espnow_task before the binary store.
+
+#include "baseline.h"
+#include <stdio.h>
+
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    uint8_t offset;
+    const char *name;
+} baseline_segment_t;
+
+static const baseline_segment_t segments[] = {
+    { 0x01,  1,  0, "drs"       },
+    { 0x02,  6,  1, "imu_gyro"  },
+    { 0x03,  6,  7, "imu_accel" },
+    { 0x04,  6, 13, "wheel_fl"  },
+    { 0x05,  6, 19, "wheel_fr"  },
+    { 0x06,  6, 25, "wheel_rr"  },
+    { 0x07,  6, 31, "wheel_rl"  },
+    { 0x08,  2, 37, "sg_fl"     },
+    { 0x09,  2, 39, "sg_fr"     },
+    { 0x0A,  2, 41, "sg_rr"     },
+    { 0x0B,  2, 43, "sg_rl"     },
+    { 0x0C,  7, 45, "eng_f0"    },
+    { 0x0D,  7, 52, "eng_f1"    },
+    { 0x0E,  4, 59, "eng_f2"    },
+    { 0x0F,  3, 63, "shifter"   },
+};
+static const int NUM_SEGMENTS = sizeof(segments) / sizeof(segments[0]);
+
+static uint32_t lastTelemetryPing;
+
+void baseline_format_gyro(const uint8_t *d, char *out, size_t out_len) {
+    int16_t gx = (int16_t)((d[0] << 8) | d[1]);
+    int16_t gy = (int16_t)((d[2] << 8) | d[3]);
+    int16_t gz = (int16_t)((d[4] << 8) | d[5]);
+    snprintf(out, out_len, "%.2f,%.2f,%.2f",
+             gx * 17.50f, gy * 17.50f, gz * 17.50f);
+}
+
+void baseline_format_accel(const uint8_t *d, char *out, size_t out_len) {
+    int16_t ax = (int16_t)((d[0] << 8) | d[1]);
+    int16_t ay = (int16_t)((d[2] << 8) | d[3]);
+    int16_t az = (int16_t)((d[4] << 8) | d[5]);
+    snprintf(out, out_len, "%.6f,%.6f,%.6f",
+             ((float)ax * 0.122f) / 1000.0f,
+             ((float)ay * 0.122f) / 1000.0f,
+             ((float)az * 0.122f) / 1000.0f);
+}
+
+void baseline_decode_telemetry(struct BaselineHashTable *table, const uint8_t *payload,
+                               size_t payload_len, uint32_t time_ms) {
+    char time_str[16];
+    snprintf(time_str, sizeof(time_str), "%lu", (unsigned long)(time_ms - lastTelemetryPing));
+    baseline_hashtable_insert(table, "telemetryPing", time_str);
+    lastTelemetryPing = time_ms;
+
+    for (int s = 0; s < NUM_SEGMENTS; s++) {
+        if ((size_t)(segments[s].offset + segments[s].len) > payload_len) continue;
+
+        const uint8_t *d = &payload[segments[s].offset];
+
+        if (segments[s].id == 0x02) { // IMU Gyro
+            char conv[64];
+            baseline_format_gyro(d, conv, sizeof(conv));
+            baseline_hashtable_insert(table, segments[s].name, conv);
+        } else if (segments[s].id == 0x03) { // IMU Accel
+            char conv[64];
+            baseline_format_accel(d, conv, sizeof(conv));
+            baseline_hashtable_insert(table, segments[s].name, conv);
+        } else {
+            char hex[64] = {0};
+            int hpos = 0;
+            for (int b = 0; b < segments[s].len; b++) {
+                hpos += snprintf(hex + hpos, sizeof(hex) - hpos,
+                                 b ? " %02X" : "%02X", d[b]);
+            }
+            baseline_hashtable_insert(table, segments[s].name, hex);
+        }
+    }
+}
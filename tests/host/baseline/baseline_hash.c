@@ -0,0 +1,70 @@
+// main/hash.c before the open-addressing rewrite, symbols renamed.
+
+#include "baseline.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TABLE_SIZE 100
+
+static int key_hash(const char *key) {
+    unsigned int hash = 0;
+    while (*key) hash = (hash * 31) + (*key++);
+    return (int)(hash % TABLE_SIZE);
+}
+
+struct BaselineHashTable baseline_hashtable_create(void) {
+    struct BaselineHashTable table;
+    table.size = TABLE_SIZE;
+    table.bucket = calloc(TABLE_SIZE, sizeof(char*));
+    table.values = calloc(TABLE_SIZE, sizeof(char*));
+    return table;
+}
+
+void baseline_hashtable_insert(struct BaselineHashTable *table, const char *key, const char *value) {
+    if (!table || !key) return;
+
+    const int index = key_hash(key);
+
+    // Linear probe: find existing slot for this key, or first empty slot
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        int slot = (index + i) % TABLE_SIZE;
+
+        if (table->bucket[slot] == NULL) {
+            // Empty slot
+            table->bucket[slot] = strdup(key);
+            table->values[slot] = strdup(value);
+            return;
+        }
+
+        if (strcmp(table->bucket[slot], key) == 0) {
+            // Key already exists
+            free(table->values[slot]);
+            table->values[slot] = strdup(value);
+            return;
+        }
+    }
+}
+
+const char *baseline_hashtable_get(struct BaselineHashTable *table, const char *key) {
+    if (!table || !key) return NULL;
+
+    int index = key_hash(key);
+
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        int slot = (index + i) % TABLE_SIZE;
+        if (table->bucket[slot] == NULL) return NULL;
+        if (strcmp(table->bucket[slot], key) == 0) return table->values[slot];
+    }
+
+    return NULL;
+}
+
+// Not in the original, which never freed its table.
+void baseline_hashtable_free(struct BaselineHashTable *table) {
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        free(table->bucket[i]);
+        free(table->values[i]);
+    }
+    free(table->bucket);
+    free(table->values);
+}
@@ -0,0 +1,56 @@
+// get_gates_handler, gate_config_get_handler and telemetry_all_get_handler
+// from main/server.c before the streaming JSON writer, minus set_cors and
+// the content type.
+
+#include "baseline.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+void baseline_render_gates(httpd_req_t *req, const char (*macs)[18], int count) {
+    char chunk[32];
+    httpd_resp_sendstr_chunk(req, "[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) httpd_resp_sendstr_chunk(req, ",");
+        snprintf(chunk, sizeof(chunk), "\"%s\"", macs[i]);
+        httpd_resp_sendstr_chunk(req, chunk);
+    }
+    httpd_resp_sendstr_chunk(req, "]");
+    httpd_resp_sendstr_chunk(req, NULL);
+}
+
+void baseline_render_gate_config(httpd_req_t *req, const baseline_gate_config_t *configs, int count) {
+    httpd_resp_sendstr_chunk(req, "[");
+    char chunk[96];
+    for (int i = 0; i < count; i++) {
+        if (i > 0) httpd_resp_sendstr_chunk(req, ",");
+        snprintf(chunk, sizeof(chunk),
+            "{\"mac\":\"%s\",\"mode\":\"%s\",\"group\":\"%s\",\"order\":%d}",
+            configs[i].mac,
+            configs[i].series ? "series" : "delta",
+            configs[i].group,
+            configs[i].order);
+        httpd_resp_sendstr_chunk(req, chunk);
+    }
+    httpd_resp_sendstr_chunk(req, "]");
+    httpd_resp_sendstr_chunk(req, NULL);
+}
+
+void baseline_render_telemetry_all(httpd_req_t *req, struct BaselineHashTable *table) {
+    char **keys = table->bucket;
+    httpd_resp_sendstr_chunk(req, "[");
+
+    bool first = true;
+    char chunk[128];
+    for (int i = 0; keys && i < table->size; i++) {
+        if (keys[i] == NULL) continue;
+        const char *value = baseline_hashtable_get(table, keys[i]);
+        if (value == NULL) continue;
+        if (!first) httpd_resp_sendstr_chunk(req, ",");
+        snprintf(chunk, sizeof(chunk), "{\"key\":\"%s\",\"value\":\"%s\"}", keys[i], value);
+        httpd_resp_sendstr_chunk(req, chunk);
+        first = false;
+    }
+
+    httpd_resp_sendstr_chunk(req, "]");
+    httpd_resp_sendstr_chunk(req, NULL);
+}
@@ -0,0 +1,89 @@
+// Frame CRC cost: the bitwise CRC-16 (what esp_crc16_le computes) against
+// protocol_crc16_le's table, each over the whole espnow_data_t as the old
+// senders and parser did and over header + len as espnow_frame_check does.
+// Frames are a receiver-like mix of telemetry, gate requests and pings.
+//
+//   bench_crc [ITERATIONS]
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "esp_crc.h"
+#include "frame_gen.h"
+#include "host_test.h"
+#include "protocol.h"
+
+#define FRAMES 256
+
+static espnow_data_t frames[FRAMES];
+static size_t lens[FRAMES];
+static volatile uint16_t sink;
+
+static double measure(uint16_t (*crc)(uint16_t, const uint8_t *, size_t), bool whole, int iterations,
+                      size_t *bytes) {
+    *bytes = 0;
+    for (int i = 0; i < FRAMES; i++) *bytes += whole ? sizeof(espnow_data_t) : lens[i];
+
+    uint64_t t0 = host_now_ns();
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < FRAMES; i++) {
+            sink ^= crc(UINT16_MAX, (const uint8_t *)&frames[i], whole ? sizeof(espnow_data_t) : lens[i]);
+        }
+    }
+    return (double)(host_now_ns() - t0) / ((double)iterations * FRAMES);
+}
+
+static uint16_t bitwise(uint16_t crc, const uint8_t *buf, size_t len) {
+    return esp_crc16_le(crc, buf, (uint32_t)len);
+}
+
+static void report(const char *name, double ns, size_t bytes) {
+    printf("  %-26s %4zu bytes/frame  %7.1f ns/frame  %6.2f ns/byte\n", name, bytes / FRAMES, ns,
+           ns * FRAMES / bytes);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    if (iterations < 1) iterations = 1;
+
+    frame_gen_t g;
+    frame_gen_init(&g, (const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 1 }, 11);
+    for (int i = 0; i < FRAMES; i++) {
+        uint32_t kind = frame_gen_rand(&g) % 8;
+        if (kind < 6) lens[i] = frame_gen_telemetry(&g, &frames[i]);
+        else if (kind == 6) lens[i] = frame_gen_gate_request(&g, &frames[i], 1000000 + i, 4200);
+        else lens[i] = frame_gen_ping(&g, &frames[i]);
+    }
+
+    // Every frame passes and a flipped bit is caught.
+    int ok = 0, caught = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        ok += espnow_frame_check(&frames[i], lens[i]) == ESPNOW_FRAME_OK;
+        espnow_data_t c = frames[i];
+        frame_gen_corrupt(&g, &c, lens[i]);
+        caught += espnow_frame_check(&c, lens[i]) != ESPNOW_FRAME_OK;
+    }
+    CHECK_EQ(ok, FRAMES);
+    CHECK_EQ(caught, FRAMES);
+
+    size_t bytes;
+    printf("CRC-16 per frame (%d x %d frames)\n", iterations, FRAMES);
+    double bit_whole = measure(bitwise, true, iterations, &bytes);
+    report("bitwise, whole frame", bit_whole, bytes);
+    double bit_span = measure(bitwise, false, iterations, &bytes);
+    report("bitwise, header + len", bit_span, bytes);
+    double table_whole = measure(protocol_crc16_le, true, iterations, &bytes);
+    report("table, whole frame", table_whole, bytes);
+    double table_span = measure(protocol_crc16_le, false, iterations, &bytes);
+    report("table, header + len", table_span, bytes);
+
+    uint64_t t0 = host_now_ns();
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < FRAMES; i++) ok += espnow_frame_check(&frames[i], lens[i]);
+    }
+    double check_ns = (double)(host_now_ns() - t0) / ((double)iterations * FRAMES);
+    printf("  %-26s %28.1f ns/frame\n", "espnow_frame_check", check_ns);
+
+    CHECK(table_whole < bit_whole);
+    CHECK(table_span < table_whole);
+    return host_test_result("bench_crc");
+}
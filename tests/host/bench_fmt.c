@@ -0,0 +1,174 @@
+// fmt.h and the fixed-point field decoders against printf: outputs first
+// (fmt_u64/fmt_i64 match "%llu"/"%lld", fmt_fixed and
+// telemetry_format_field match an exact decimal reference for every IMU
+// raw value), then time per value and per frame. Per frame, the old path
+// float-formatted both IMU segments on every packet; now a packet only
+// holds scaled integers and text is made when a client asks.
+//
+//   bench_fmt [ITERATIONS]
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "baseline/baseline.h"
+#include "fmt.h"
+#include "frame_gen.h"
+#include "host_test.h"
+#include "state_version.h"
+#include "telemetry.h"
+#include "telemetry_schema.h"
+
+#define FRAMES 256
+
+atomic_uint state_version;
+
+static espnow_data_t frames[FRAMES];
+static volatile size_t sink;
+
+static uint64_t rng = 0x853C49E6748FEA9Bull;
+
+static uint64_t rnd(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static void check_integers(void) {
+    static const int64_t edges[] = { 0, 1, -1, 9, 10, -10, 99, 100, INT32_MAX, INT32_MIN,
+                                     INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1 };
+    char got[FMT_FIXED_MAX + 1], want[32];
+    int mismatched = 0;
+    for (int i = 0; i < 100000; i++) {
+        int64_t v = i < (int)(sizeof(edges) / sizeof(edges[0])) ? edges[i]
+                                                                 : (int64_t)(rnd() >> (rnd() % 64));
+        if (i & 1) v = -v;
+        got[fmt_i64(got, v)] = '\0';
+        snprintf(want, sizeof(want), "%" PRId64, v);
+        mismatched += strcmp(got, want) != 0;
+        got[fmt_u64(got, (uint64_t)v)] = '\0';
+        snprintf(want, sizeof(want), "%" PRIu64, (uint64_t)v);
+        mismatched += strcmp(got, want) != 0;
+
+        // fmt_fixed against the integer and fraction printed separately.
+        unsigned d = i % 7;
+        uint64_t p = 1;
+        for (unsigned k = 0; k < d; k++) p *= 10;
+        uint64_t a = v < 0 ? -(uint64_t)v : (uint64_t)v;
+        if (d) snprintf(want, sizeof(want), "%s%" PRIu64 ".%0*" PRIu64, v < 0 ? "-" : "", a / p, (int)d, a % p);
+        else snprintf(want, sizeof(want), "%" PRId64, v);
+        got[fmt_fixed(got, v, d)] = '\0';
+        mismatched += strcmp(got, want) != 0;
+    }
+    CHECK_EQ(mismatched, 0);
+}
+
+// Every raw value of every scaled field against round-half-away-from-zero
+// of the exact product, printed by printf.
+static void check_fields(void) {
+    char got[TELEMETRY_VALUE_MAX], want[32];
+    int fields = 0, mismatched = 0;
+    for (int i = 0; i < TELEMETRY_NUM_FIELDS; i++) {
+        const telemetry_field_t *f = &telemetry_fields[i];
+        if (f->label_count || f->type != TELEMETRY_I16 || f->scale_num == f->scale_den) continue;
+        fields++;
+        double p = pow(10, f->decimals);
+        for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++) {
+            double q = round((double)raw * f->scale_num * p / f->scale_den);
+            snprintf(want, sizeof(want), "%.*f", f->decimals, q / p);
+            if (q == 0) snprintf(want, sizeof(want), "%.*f", f->decimals, 0.0);   // no "-0.00"
+            CHECK(telemetry_format_field(f, raw, got, sizeof(got)) > 0);
+            mismatched += strcmp(got, want) != 0;
+        }
+    }
+    CHECK(fields >= 6);
+    CHECK_EQ(mismatched, 0);
+}
+
+typedef struct {
+    const char *name;
+    double ns;
+} timing_t;
+
+#define TIME(t, label, iterations, per, body) do {                            \
+        uint64_t t0_ = host_now_ns();                                         \
+        for (int it_ = 0; it_ < (iterations); it_++) { body; }                \
+        (t).name = (label);                                                   \
+        (t).ns = (double)(host_now_ns() - t0_) / ((double)(iterations) * (per)); \
+    } while (0)
+
+static void report(timing_t old, timing_t now) {
+    printf("  %-30s %7.1f ns   %-30s %6.1f ns  (x%.1f)\n", old.name, old.ns, now.name, now.ns, old.ns / now.ns);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    if (iterations < 1) iterations = 1;
+
+    check_integers();
+    check_fields();
+
+    CHECK_EQ(telemetry_init(), ESP_OK);
+    const uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0, 0, 1 };
+    frame_gen_t g;
+    frame_gen_init(&g, mac, 23);
+    for (int i = 0; i < FRAMES; i++) frame_gen_telemetry(&g, &frames[i]);
+
+    int gyro = telemetry_find_segment("imu_gyro"), accel = telemetry_find_segment("imu_accel");
+    CHECK(gyro >= 0 && accel >= 0);
+    if (gyro < 0 || accel < 0) return host_test_result("bench_fmt");
+    const telemetry_field_t *imu = &telemetry_fields[segments[gyro].first_field];
+    int imu_fields = segments[gyro].field_count + segments[accel].field_count;
+    CHECK(segments[accel].first_field == segments[gyro].first_field + segments[gyro].field_count);
+
+    char buf[64];
+    timing_t old, now;
+    printf("per value (%d x %d)\n", iterations, FRAMES);
+    TIME(old, "snprintf %lld", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        sink += snprintf(buf, sizeof(buf), "%lld", (long long)frames[i].seq_num * 1000003 - 500000000);
+    });
+    TIME(now, "fmt_i64", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        sink += fmt_i64(buf, (int64_t)frames[i].seq_num * 1000003 - 500000000);
+    });
+    report(old, now);
+    TIME(old, "snprintf %.2f (float)", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        int16_t raw = (int16_t)telemetry_field_raw(imu, frames[i].data);
+        sink += snprintf(buf, sizeof(buf), "%.2f", raw * 0.0175f);
+    });
+    TIME(now, "telemetry_format_field", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        sink += telemetry_format_field(imu, telemetry_field_raw(imu, frames[i].data), buf, sizeof(buf));
+    });
+    report(old, now);
+
+    printf("per frame, both IMU segments (%d fields)\n", imu_fields);
+    TIME(old, "old float snprintf decode", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        const uint8_t *d = frames[i].data;
+        baseline_format_gyro(&d[segments[gyro].offset], buf, sizeof(buf));
+        baseline_format_accel(&d[segments[accel].offset], buf, sizeof(buf));
+        sink += buf[0];
+    });
+    int32_t scaled[16];
+    TIME(now, "scaled integers", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        for (int k = 0; k < imu_fields; k++) {
+            scaled[k] = telemetry_field_scaled(&imu[k], telemetry_field_raw(&imu[k], frames[i].data));
+        }
+        sink += (size_t)scaled[0];
+    });
+    report(old, now);
+    timing_t scaled_only = now;
+
+    // What a /telemetry/imu_* request now pays, from the stored raw bytes.
+    telemetry_snapshot_t snap;
+    telemetry_update(0, mac, frames[0].data, frames[0].len, 0);
+    telemetry_snapshot(0, &snap);
+    TIME(now, "formatted on request", iterations, FRAMES, for (int i = 0; i < FRAMES; i++) {
+        sink += (size_t)telemetry_format_decoded(&snap, gyro, buf, sizeof(buf));
+        sink += (size_t)telemetry_format_decoded(&snap, accel, buf, sizeof(buf));
+    });
+    report(old, now);
+
+    CHECK(scaled_only.ns < old.ns);
+    CHECK(now.ns < old.ns);
+    return host_test_result("bench_fmt");
+}
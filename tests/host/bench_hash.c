@@ -0,0 +1,126 @@
+// hash.c against the original 100-slot strdup table: building a table,
+// overwriting every value (the per-packet pattern the old decode loop had),
+// lookups that hit and miss, and for the new table remove + re-insert.
+// Keys are telemetry-style names; values are short formatted readings.
+// The old table cannot hold more than 100 keys, so both get KEYS.
+//
+//   bench_hash [ITERATIONS]
+
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_count.h"
+#include "baseline/baseline.h"
+#include "hash.h"
+#include "host_test.h"
+
+#define KEYS 64
+
+static char keys[KEYS][32];
+static char misses[KEYS][32];
+static char values[8][KEYS][16];
+static volatile uintptr_t sink;
+
+typedef struct {
+    double ns;
+    double allocs;
+} cost_t;
+
+#define MEASURE(cost, ops, body) do {                                         \
+        unsigned long a_ = host_allocs();                                     \
+        uint64_t t_ = host_now_ns();                                          \
+        body;                                                                 \
+        (cost).ns = (double)(host_now_ns() - t_) / (ops);                     \
+        (cost).allocs = (double)(host_allocs() - a_) / (ops);                 \
+    } while (0)
+
+static void report(const char *name, cost_t old, cost_t now) {
+    printf("  %-16s %7.1f -> %6.1f ns/op   heap calls %5.2f -> %4.2f per op\n", name, old.ns, now.ns,
+           old.allocs, now.allocs);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    if (iterations < 1) iterations = 1;
+    double ops = (double)iterations * KEYS;
+
+    static const char *groups[] = { "imu", "gps", "engine", "battery", "wheel", "brake", "steer", "lap" };
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "%s_%s_%d", groups[i % 8], i & 8 ? "raw" : "filtered", i / 8);
+        snprintf(misses[i], sizeof(misses[i]), "%s_unknown_%d", groups[i % 8], i);
+        for (int v = 0; v < 8; v++) snprintf(values[v][i], sizeof(values[v][i]), "%.2f", (i * 37 + v * 11) * 0.731);
+    }
+
+    cost_t old_build, new_build;
+    MEASURE(old_build, ops, for (int it = 0; it < iterations; it++) {
+        struct BaselineHashTable t = baseline_hashtable_create();
+        for (int i = 0; i < KEYS; i++) baseline_hashtable_insert(&t, keys[i], values[0][i]);
+        baseline_hashtable_free(&t);
+    });
+    MEASURE(new_build, ops, for (int it = 0; it < iterations; it++) {
+        struct HashTable t = hashtable_create();
+        for (int i = 0; i < KEYS; i++) hashtable_insert(&t, keys[i], values[0][i]);
+        hashtable_destroy(&t);
+    });
+
+    struct BaselineHashTable old_table = baseline_hashtable_create();
+    struct HashTable table = hashtable_create();
+    for (int i = 0; i < KEYS; i++) {
+        baseline_hashtable_insert(&old_table, keys[i], values[0][i]);
+        CHECK(hashtable_insert(&table, keys[i], values[0][i]));
+    }
+
+    cost_t old_overwrite, new_overwrite;
+    MEASURE(old_overwrite, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) baseline_hashtable_insert(&old_table, keys[i], values[it & 7][i]);
+    });
+    MEASURE(new_overwrite, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) hashtable_insert(&table, keys[i], values[it & 7][i]);
+    });
+
+    cost_t old_hit, new_hit, old_miss, new_miss;
+    MEASURE(old_hit, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) sink += (uintptr_t)baseline_hashtable_get(&old_table, keys[i]);
+    });
+    MEASURE(new_hit, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) sink += (uintptr_t)hashtable_get(&table, keys[i]);
+    });
+    MEASURE(old_miss, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) sink += (uintptr_t)baseline_hashtable_get(&old_table, misses[i]);
+    });
+    MEASURE(new_miss, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) sink += (uintptr_t)hashtable_get(&table, misses[i]);
+    });
+
+    cost_t churn;
+    MEASURE(churn, ops, for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < KEYS; i++) {
+            hashtable_remove(&table, keys[i]);
+            hashtable_insert(&table, keys[i], values[it & 7][i]);
+        }
+    });
+
+    // Both tables end up holding the same thing.
+    int mismatched = 0;
+    for (int i = 0; i < KEYS; i++) {
+        const char *a = baseline_hashtable_get(&old_table, keys[i]);
+        const char *b = hashtable_get(&table, keys[i]);
+        if (a == NULL || b == NULL || strcmp(a, b) != 0) mismatched++;
+        if (hashtable_get(&table, misses[i]) != NULL) mismatched++;
+    }
+    CHECK_EQ(mismatched, 0);
+
+    printf("%d keys, %d iterations, old table -> hash.c\n", KEYS, iterations);
+    report("build", old_build, new_build);
+    report("overwrite", old_overwrite, new_overwrite);
+    report("get (hit)", old_hit, new_hit);
+    report("get (miss)", old_miss, new_miss);
+    printf("  %-16s %16.1f ns/op   heap calls %4.2f per op\n", "remove + insert", churn.ns, churn.allocs);
+
+    CHECK(new_overwrite.allocs == 0);
+    CHECK(churn.allocs == 0);
+    CHECK(new_build.allocs < old_build.allocs);
+
+    baseline_hashtable_free(&old_table);
+    hashtable_destroy(&table);
+    return host_test_result("bench_hash");
+}
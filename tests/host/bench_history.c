@@ -0,0 +1,78 @@
+// history_append cost and history_query latency over windows that land on
+// each level of the pyramid.
+//
+//   bench_history [FRAMES] [QUERIES]
+
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_count.h"
+#include "frame_gen.h"
+#include "history.h"
+#include "host_test.h"
+#include "state_version.h"
+
+#define PERIOD_MS 10            // 100 Hz telemetry
+
+atomic_uint state_version;
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_query(const char *name, uint32_t from, uint32_t to, int points, int queries, uint64_t *ns) {
+    static history_result_t r;
+    int ch = 0, level = 0, count = 0;
+    unsigned long allocs = host_allocs();
+    for (int q = 0; q < queries; q++) {
+        uint64_t t0 = host_now_ns();
+        CHECK(history_query(0, ch, from, to, points, &r));
+        ns[q] = host_now_ns() - t0;
+        level = r.level;
+        count = r.count;
+        ch = (ch + 1) % history_channel_count();
+    }
+    CHECK_EQ(host_allocs() - allocs, 0);
+    qsort(ns, queries, sizeof(ns[0]), cmp_u64);
+    printf("  %-12s L%d  %3d points  p50 %7.1f us  p99 %7.1f us  max %7.1f us\n", name, level, count,
+           ns[queries / 2] / 1e3, ns[queries * 99 / 100] / 1e3, ns[queries - 1] / 1e3);
+    CHECK(count > 0);
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 100000;
+    int queries = argc > 2 ? atoi(argv[2]) : 2000;
+    if (frames < 1000) frames = 1000;
+    if (queries < 1) queries = 1;
+    CHECK_EQ(history_init(), ESP_OK);
+
+    espnow_data_t *gen = malloc((size_t)frames * sizeof(*gen));
+    frame_gen_t g;
+    frame_gen_init(&g, (const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 1 }, 3);
+    for (int i = 0; i < frames; i++) frame_gen_telemetry(&g, &gen[i]);
+
+    telemetry_snapshot_t snap = { 0 };
+    unsigned long allocs = host_allocs();
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < frames; i++) {
+        memcpy(snap.raw, gen[i].data, gen[i].len);
+        snap.rx_ms = (uint32_t)i * PERIOD_MS;
+        history_append(0, &snap);
+    }
+    uint64_t insert_ns = host_now_ns() - t0;
+    CHECK_EQ(host_allocs() - allocs, 0);
+    free(gen);
+
+    uint32_t now = (uint32_t)(frames - 1) * PERIOD_MS;
+    printf("%d frames, %d channels: history_append %.1f ns/frame\n", frames, history_channel_count(),
+           (double)insert_ns / frames);
+
+    uint64_t *ns = malloc((size_t)queries * sizeof(*ns));
+    bench_query("last 2 s", now - 2000, now, HISTORY_DEFAULT_POINTS, queries, ns);
+    bench_query("last 30 s", now - 30000, now, HISTORY_DEFAULT_POINTS, queries, ns);
+    bench_query("last 5 min", now > 300000 ? now - 300000 : 0, now, HISTORY_DEFAULT_POINTS, queries, ns);
+    bench_query("all retained", 0, now, HISTORY_MAX_POINTS, queries, ns);
+    free(ns);
+
+    return host_test_result("bench_history");
+}
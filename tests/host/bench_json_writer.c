@@ -0,0 +1,150 @@
+// Writes and bytes per response for /gates, /gate-config and /telemetry:
+// the old handlers, which sent every row and comma as its own chunk,
+// against json_writer. Each send call is one lwIP write on the device.
+// /gates and /gate-config bodies must match byte for byte; /telemetry rows
+// differ (the old one decoded the IMU segments to floats), so only the
+// write counts compare there.
+//
+//   bench_json_writer [ITERATIONS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "baseline/baseline.h"
+#include "frame_gen.h"
+#include "host_test.h"
+#include "json_writer.h"
+#include "server.h"
+#include "state_version.h"
+#include "telemetry.h"
+
+#define MAX_ROWS 64
+#define BODY_CAP 16384
+
+atomic_uint state_version;
+
+static char macs[MAX_ROWS][18];
+static baseline_gate_config_t configs[MAX_ROWS];
+static char render_buf[SERVER_RENDER_BUF_SIZE];
+static char old_body[BODY_CAP], new_body[BODY_CAP];
+
+typedef struct {
+    unsigned calls;
+    size_t bytes;
+    double ns;
+} cost_t;
+
+static void render_gates(httpd_req_t *req, int rows) {
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_array(&w);
+    for (int i = 0; i < rows; i++) json_string(&w, macs[i]);
+    json_end_array(&w);
+    json_finish_stream(&w);
+}
+
+static void render_gate_config(httpd_req_t *req, int rows) {
+    json_writer_t w;
+    json_init_stream(&w, req, render_buf, sizeof(render_buf));
+    json_begin_array(&w);
+    for (int i = 0; i < rows; i++) {
+        json_begin_object(&w);
+        json_key(&w, "mac");   json_string(&w, configs[i].mac);
+        json_key(&w, "mode");  json_string(&w, configs[i].series ? "series" : "delta");
+        json_key(&w, "group"); json_string(&w, configs[i].group);
+        json_key(&w, "order"); json_int(&w, configs[i].order);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    json_finish_stream(&w);
+}
+
+// As render_telemetry_src + send_versioned: rendered into the buffer, sent once.
+static void render_telemetry(httpd_req_t *req, int rows) {
+    telemetry_snapshot_t snap;
+    telemetry_snapshot(0, &snap);
+    json_writer_t w;
+    json_init_buffer(&w, render_buf, sizeof(render_buf), 1);
+    json_begin_array(&w);
+    char value[TELEMETRY_VALUE_MAX];
+    for (int s = 0; s < NUM_SEGMENTS; s++) {
+        if (telemetry_format_segment(&snap, s, value, sizeof(value)) < 0) continue;
+        json_begin_object(&w);
+        json_key(&w, "key");   json_string(&w, segments[s].name);
+        json_key(&w, "value"); json_string(&w, value);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    size_t n = json_finish_buffer(&w);
+    httpd_resp_send(req, render_buf, n);
+}
+
+static struct BaselineHashTable old_table;
+
+static void old_gates(httpd_req_t *req, int rows)       { baseline_render_gates(req, macs, rows); }
+static void old_gate_config(httpd_req_t *req, int rows) { baseline_render_gate_config(req, configs, rows); }
+static void old_telemetry(httpd_req_t *req, int rows)   { baseline_render_telemetry_all(req, &old_table); }
+
+static cost_t measure(void (*render)(httpd_req_t *, int), int rows, int iterations, char *body) {
+    httpd_req_t req;
+    host_httpd_req_init(&req, "/", NULL, body, BODY_CAP);
+    render(&req, rows);
+    cost_t c = { req.send_calls, req.bytes_sent, 0 };
+
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        host_httpd_req_init(&req, "/", NULL, NULL, 0);
+        render(&req, rows);
+    }
+    c.ns = (double)(host_now_ns() - t0) / iterations;
+    return c;
+}
+
+static void compare(const char *name, void (*old)(httpd_req_t *, int), void (*now)(httpd_req_t *, int),
+                    int rows, int iterations, bool same_order) {
+    cost_t a = measure(old, rows, iterations, old_body);
+    cost_t b = measure(now, rows, iterations, new_body);
+    printf("  %-12s %3d rows  %5zu bytes   writes %4u -> %2u   %7.0f -> %6.0f ns\n",
+           name, rows, b.bytes, a.calls, b.calls, a.ns, b.ns);
+
+    if (same_order) CHECK(strcmp(old_body, new_body) == 0);
+    CHECK(b.calls <= (b.bytes + JSON_FLUSH_BYTES - 1) / JSON_FLUSH_BYTES);
+    CHECK(b.calls < a.calls);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    if (iterations < 1) iterations = 1;
+
+    for (int i = 0; i < MAX_ROWS; i++) {
+        snprintf(macs[i], sizeof(macs[i]), "24:6F:28:%02X:%02X:%02X", i * 7 & 0xFF, i, 0x40 + i);
+        memcpy(configs[i].mac, macs[i], sizeof(macs[i]));
+        configs[i].series = i % 3 == 0;
+        snprintf(configs[i].group, sizeof(configs[i].group), "sector %d", i / 4);
+        configs[i].order = i % 4;
+    }
+
+    // The same frame in the old string table and in the telemetry store.
+    CHECK_EQ(telemetry_init(), ESP_OK);
+    frame_gen_t g;
+    const uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0, 0, 1 };
+    frame_gen_init(&g, mac, 5);
+    espnow_data_t frame;
+    frame_gen_telemetry(&g, &frame);
+    telemetry_update(0, mac, frame.data, frame.len, 0);
+    old_table = baseline_hashtable_create();
+    baseline_decode_telemetry(&old_table, frame.data, frame.len, 0);
+
+    printf("per response, old handlers -> json_writer (%d iterations)\n", iterations);
+    int sizes[] = { 4, 16, MAX_ROWS };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        compare("/gates", old_gates, render_gates, sizes[i], iterations, true);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        compare("/gate-config", old_gate_config, render_gate_config, sizes[i], iterations, true);
+    }
+    compare("/telemetry", old_telemetry, render_telemetry, NUM_SEGMENTS, iterations, false);
+
+    baseline_hashtable_free(&old_table);
+    return host_test_result("bench_json_writer");
+}
@@ -0,0 +1,102 @@
+// Heap calls and time per telemetry packet: the old decode path (snprintf
+// every segment, strdup into the string table) against telemetry_update,
+// which copies raw bytes in place. Formatting now happens on HTTP reads, so
+// those are measured separately.
+//
+//   bench_telemetry_store [PACKETS]
+
+#include <stdlib.h>
+#include "alloc_count.h"
+#include "baseline/baseline.h"
+#include "frame_gen.h"
+#include "host_test.h"
+#include "state_version.h"
+#include "telemetry.h"
+
+atomic_uint state_version;
+
+typedef struct {
+    double allocs_per_packet;
+    double ns_per_packet;
+} result_t;
+
+static espnow_data_t *frames;
+
+static void make_frames(int n) {
+    frames = malloc((size_t)n * sizeof(*frames));
+    frame_gen_t g;
+    frame_gen_init(&g, (const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 1 }, 1);
+    for (int i = 0; i < n; i++) frame_gen_telemetry(&g, &frames[i]);
+}
+
+static result_t bench_baseline(int n) {
+    struct BaselineHashTable table = baseline_hashtable_create();
+    // First packet inserts the keys; measure steady state only.
+    baseline_decode_telemetry(&table, frames[0].data, frames[0].len, 0);
+
+    unsigned long allocs = host_allocs();
+    uint64_t t0 = host_now_ns();
+    for (int i = 1; i < n; i++) baseline_decode_telemetry(&table, frames[i].data, frames[i].len, (uint32_t)i);
+    uint64_t ns = host_now_ns() - t0;
+    allocs = host_allocs() - allocs;
+
+    baseline_hashtable_free(&table);
+    return (result_t){ (double)allocs / (n - 1), (double)ns / (n - 1) };
+}
+
+static result_t bench_store(int n) {
+    const uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0, 0, 1 };
+    CHECK_EQ(telemetry_update(0, mac, frames[0].data, frames[0].len, 0), 0);
+
+    unsigned long allocs = host_allocs();
+    uint64_t t0 = host_now_ns();
+    for (int i = 1; i < n; i++) telemetry_update(0, mac, frames[i].data, frames[i].len, (uint32_t)i);
+    uint64_t ns = host_now_ns() - t0;
+    allocs = host_allocs() - allocs;
+    return (result_t){ (double)allocs / (n - 1), (double)ns / (n - 1) };
+}
+
+// One /telemetry poll's worth of work: snapshot and format every segment.
+static result_t bench_read(int n) {
+    char buf[TELEMETRY_VALUE_MAX * 4];
+    telemetry_snapshot_t snap;
+    size_t bytes = 0;
+
+    unsigned long allocs = host_allocs();
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < n; i++) {
+        telemetry_snapshot(0, &snap);
+        for (int s = 0; s < NUM_SEGMENTS; s++) {
+            int len = telemetry_format_segment(&snap, s, buf, sizeof(buf));
+            if (len > 0) bytes += (size_t)len;
+        }
+    }
+    uint64_t ns = host_now_ns() - t0;
+    allocs = host_allocs() - allocs;
+    CHECK(bytes > 0);
+    return (result_t){ (double)allocs / n, (double)ns / n };
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    if (n < 2) n = 2;
+    CHECK_EQ(telemetry_init(), ESP_OK);
+    make_frames(n);
+
+    result_t old = bench_baseline(n);
+    result_t store = bench_store(n);
+    result_t read = bench_read(n);
+
+    printf("%d packets, %d segments\n", n, NUM_SEGMENTS);
+    printf("  %-28s %6.2f heap calls/packet  %8.1f ns/packet\n", "baseline decode + strdup", old.allocs_per_packet, old.ns_per_packet);
+    printf("  %-28s %6.2f heap calls/packet  %8.1f ns/packet\n", "telemetry_update", store.allocs_per_packet, store.ns_per_packet);
+    printf("  %-28s %6.2f heap calls/read    %8.1f ns/read\n", "snapshot + format on read", read.allocs_per_packet, read.ns_per_packet);
+
+    // One strdup per segment plus telemetryPing before, none now.
+    CHECK(old.allocs_per_packet >= NUM_SEGMENTS);
+    CHECK(store.allocs_per_packet == 0);
+    CHECK(read.allocs_per_packet == 0);
+
+    free(frames);
+    return host_test_result("bench_telemetry_store");
+}
@@ -0,0 +1,76 @@
+#include "frame_gen.h"
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_schema.h"
+
+void frame_gen_init(frame_gen_t *g, const uint8_t mac[6], uint64_t seed) {
+    memset(g, 0, sizeof(*g));
+    memcpy(g->mac, mac, 6);
+    g->rng = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+// xorshift64*
+uint32_t frame_gen_rand(frame_gen_t *g) {
+    g->rng ^= g->rng >> 12;
+    g->rng ^= g->rng << 25;
+    g->rng ^= g->rng >> 27;
+    return (uint32_t)((g->rng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static void header(frame_gen_t *g, espnow_data_t *f, espnow_msg_type_t type) {
+    memset(f, 0, sizeof(*f));
+    f->type = type;
+    f->seq_num = g->seq++;
+}
+
+static void put_field(const telemetry_field_t *f, uint8_t *payload, int32_t v) {
+    uint8_t *p = payload + f->offset;
+    if (f->type == TELEMETRY_U8) {
+        p[0] = (uint8_t)v;
+    } else if (f->big_endian) {
+        p[0] = (uint8_t)(v >> 8);
+        p[1] = (uint8_t)v;
+    } else {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+    }
+}
+
+// A triangle wave per field, phase-shifted by field index, with a little noise.
+static int32_t field_value(frame_gen_t *g, int i, const telemetry_field_t *f) {
+    if (f->label_count) return (int32_t)((g->frame / 50 + i) % f->label_count);
+    int32_t span = f->type == TELEMETRY_U8 ? 200 : 20000;
+    int32_t t = (int32_t)((g->frame * 7 + (uint32_t)i * 997) % (uint32_t)(2 * span));
+    int32_t v = (t < span ? t : 2 * span - t) + (int32_t)(frame_gen_rand(g) % 16);
+    return f->type == TELEMETRY_I16 ? v - span / 2 : v;
+}
+
+size_t frame_gen_telemetry(frame_gen_t *g, espnow_data_t *out) {
+    header(g, out, ESPNOW_TELEMETRY);
+    for (int i = 0; i < TELEMETRY_NUM_FIELDS; i++) {
+        put_field(&telemetry_fields[i], out->data, field_value(g, i, &telemetry_fields[i]));
+    }
+    out->len = TELEMETRY_FRAME_LEN;
+    g->frame++;
+    espnow_frame_seal(out);
+    return espnow_frame_len(out);
+}
+
+size_t frame_gen_gate_request(frame_gen_t *g, espnow_data_t *out, int64_t timestamp_us, int64_t diff_us) {
+    header(g, out, ESPNOW_DATA_REQUEST);
+    int n = snprintf((char *)out->data, sizeof(out->data), "%lld,%lld", (long long)timestamp_us, (long long)diff_us);
+    out->len = (uint8_t)n;
+    espnow_frame_seal(out);
+    return espnow_frame_len(out);
+}
+
+size_t frame_gen_ping(frame_gen_t *g, espnow_data_t *out) {
+    header(g, out, ESPNOW_DATA_PING);
+    espnow_frame_seal(out);
+    return espnow_frame_len(out);
+}
+
+void frame_gen_corrupt(frame_gen_t *g, espnow_data_t *f, size_t len) {
+    uint32_t bit = frame_gen_rand(g) % (uint32_t)(len * 8);
+    ((uint8_t *)f)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+}
@@ -0,0 +1,32 @@
+#ifndef HOST_FRAME_GEN_H
+#define HOST_FRAME_GEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol.h"
+
+// Builds the ESP-NOW frames the gates and the car send, sealed with the
+// frame CRC, for the simulator and the tests. Telemetry payloads follow
+// segments[] and move smoothly from frame to frame so history and the
+// decoders see plausible data. Deterministic for a given seed.
+
+typedef struct {
+    uint8_t mac[6];
+    uint16_t seq;
+    uint32_t frame;      // telemetry frames built so far
+    uint64_t rng;
+} frame_gen_t;
+
+void frame_gen_init(frame_gen_t *g, const uint8_t mac[6], uint64_t seed);
+uint32_t frame_gen_rand(frame_gen_t *g);
+
+// Each returns the on-air length: header plus len payload bytes.
+size_t frame_gen_telemetry(frame_gen_t *g, espnow_data_t *out);
+// Payload "timestamp_us,diff_us", what a gate sends on a trigger.
+size_t frame_gen_gate_request(frame_gen_t *g, espnow_data_t *out, int64_t timestamp_us, int64_t diff_us);
+size_t frame_gen_ping(frame_gen_t *g, espnow_data_t *out);
+
+// Flips one random bit in the first len bytes; the CRC no longer matches.
+void frame_gen_corrupt(frame_gen_t *g, espnow_data_t *f, size_t len);
+
+#endif //HOST_FRAME_GEN_H
@@ -0,0 +1,41 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Minimal check macros for the host tests: a failed CHECK prints and is
+// counted, and main returns host_test_result().
+
+static int host_test_failures;
+
+#define CHECK(cond) do {                                                      \
+        if (!(cond)) {                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                             \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_EQ(a, b) do {                                                   \
+        long long a_ = (long long)(a), b_ = (long long)(b);                   \
+        if (a_ != b_) {                                                       \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                    __FILE__, __LINE__, #a, #b, a_, b_);                      \
+            host_test_failures++;                                             \
+        }                                                                     \
+    } while (0)
+
+static inline int host_test_result(const char *name) {
+    if (host_test_failures) fprintf(stderr, "%s: %d check(s) failed\n", name, host_test_failures);
+    else printf("%s: ok\n", name);
+    return host_test_failures ? 1 : 0;
+}
+
+static inline uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#endif //HOST_TEST_H
@@ -0,0 +1,354 @@
+// flash_log on a simulated NOR partition. Each boot of the receiver is a
+// forked child sharing the flash memory with this process, so a child can
+// lose power partway through a flash operation and the next one boots from
+// whatever it left behind.
+//
+// The throughput run logs telemetry at --rate for --seconds with the given
+// erase and program times and reports what the writer kept up with. The
+// crash run then cuts power --cuts times at chosen points (inside each part
+// of a block write, then at random) and after every cut reboots, downloads
+// the log and checks it: every block intact, sequence numbers contiguous,
+// records in order, resuming right after the newest block, and nothing
+// committed before the cut lost except the sector being overwritten.
+//
+//   sim_flash_log [--rate HZ] [--seconds S] [--sectors N] [--erase-ms MS]
+//                 [--page-us US] [--cuts N] [--seed N] [--expect-no-drops]
+
+#include <getopt.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_crc.h"
+#include "esp_http_server.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "flash_log.h"
+
+#define MAX_SECTORS 256
+#define PAYLOAD_LEN 66          // a telemetry frame; carries the record index
+#define RECORD_LEN (sizeof(flash_log_record_t) + PAYLOAD_LEN)
+#define RECORDS_PER_BLOCK ((FLASH_LOG_BLOCK_SIZE - sizeof(flash_log_block_t)) / RECORD_LEN)
+#define FULL_BLOCK_UNITS (1 + RECORDS_PER_BLOCK * RECORD_LEN + sizeof(flash_log_block_t))
+
+typedef struct {
+    double rate_hz;
+    double seconds;
+    int sectors;
+    double erase_ms;
+    double page_us;
+    int cuts;
+    uint64_t seed;
+    bool expect_no_drops;
+} options_t;
+
+// In memory shared with the children.
+typedef struct {
+    uint32_t next_index;            // next record index; never reused across boots
+    flash_log_stats_t stats;
+    uint32_t erase_counts[MAX_SECTORS];
+    double produce_s;
+    double drain_s;
+    // From the last verify
+    uint32_t blocks;
+    uint32_t first_seq;
+    uint32_t last_seq;
+    uint32_t records;
+    uint32_t last_index;
+} shared_t;
+
+static options_t opt = {
+    .rate_hz = 500, .seconds = 2, .sectors = 16, .erase_ms = 45, .page_us = 700, .cuts = 0, .seed = 1,
+};
+static uint8_t *flash;
+static shared_t *shared;
+
+static double now_s(void) {
+    return esp_timer_get_time() / 1e6;
+}
+
+static void log_record(uint32_t t_ms) {
+    uint8_t payload[PAYLOAD_LEN];
+    memset(payload, 0x5A, sizeof(payload));
+    uint32_t index = shared->next_index++;
+    memcpy(payload, &index, sizeof(index));
+    flash_log_telemetry(payload, sizeof(payload), t_ms);
+}
+
+// Child: one boot that logs at the configured rate and waits for the writer
+// to drain, including the idle flush of the last partial block.
+static int boot_and_log(void) {
+    host_flash_set_timing((uint32_t)(opt.erase_ms * 1000), (uint32_t)opt.page_us);
+    if (flash_log_init() != ESP_OK) return 2;
+
+    uint64_t total = (uint64_t)(opt.rate_hz * opt.seconds);
+    int64_t period_ns = (int64_t)(1e9 / opt.rate_hz);
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    double t0 = now_s();
+    for (uint64_t i = 0; i < total; i++) {
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0) {}
+        log_record((uint32_t)(i * 1000 / opt.rate_hz));
+    }
+    double t1 = now_s();
+
+    flash_log_stats_t st;
+    double deadline = t1 + 60;
+    do {
+        usleep(10000);
+        flash_log_get_stats(&st);
+    } while (st.records_written + st.records_dropped < total && now_s() < deadline);
+
+    shared->stats = st;
+    shared->produce_s = t1 - t0;
+    shared->drain_s = now_s() - t1;
+    for (int s = 0; s < opt.sectors; s++) shared->erase_counts[s] = host_flash_erase_count(s);
+    return st.records_written + st.records_dropped == total ? 0 : 3;
+}
+
+// Child: boots, logs as fast as the writer takes records and loses power
+// after `units` more flash units.
+static uint64_t cut_units;
+
+static int boot_and_cut(void) {
+    host_flash_set_timing(0, 0);
+    if (flash_log_init() != ESP_OK) return 2;
+    host_flash_cut_after(cut_units);
+    double deadline = now_s() + 10;
+    for (uint32_t t = 0; now_s() < deadline; t++) {
+        log_record(t);
+        sched_yield();
+    }
+    return 3;   // the cut never came
+}
+
+#define FAIL(...) do { fprintf(stderr, "verify: " __VA_ARGS__); fputc('\n', stderr); return 1; } while (0)
+
+// Child: boots and checks what the download handler returns.
+static int boot_and_verify(void) {
+    if (flash_log_init() != ESP_OK) FAIL("flash_log_init failed");
+    flash_log_stats_t st;
+    flash_log_get_stats(&st);
+
+    size_t cap = (size_t)opt.sectors * FLASH_LOG_BLOCK_SIZE + 1;
+    char *body = malloc(cap);
+    httpd_req_t req;
+    host_httpd_req_init(&req, "/log/download", NULL, body, cap);
+    if (flash_log_download_uri.handler(&req) != ESP_OK) FAIL("download failed");
+
+    uint32_t blocks = 0, records = 0, first_seq = 0, last_seq = 0, last_index = 0;
+    bool have_index = false;
+    for (size_t pos = 0; pos < req.body_len;) {
+        flash_log_block_t hdr;
+        if (req.body_len - pos < sizeof(hdr)) FAIL("truncated block header at %zu", pos);
+        memcpy(&hdr, body + pos, sizeof(hdr));
+        const uint8_t *data = (const uint8_t *)body + pos + sizeof(hdr);
+        if (hdr.magic != FLASH_LOG_MAGIC) FAIL("bad magic at %zu", pos);
+        if (hdr.used > req.body_len - pos - sizeof(hdr)) FAIL("block at %zu overruns the body", pos);
+        uint32_t crc = esp_crc32_le(0, (const uint8_t *)&hdr.seq, sizeof(hdr.seq) + sizeof(hdr.used) + sizeof(hdr.count));
+        if (esp_crc32_le(crc, data, hdr.used) != hdr.crc) FAIL("block %u fails its CRC", (unsigned)hdr.seq);
+        if (blocks == 0) first_seq = hdr.seq;
+        else if (hdr.seq != last_seq + 1) FAIL("block %u follows block %u", (unsigned)hdr.seq, (unsigned)last_seq);
+        last_seq = hdr.seq;
+
+        uint16_t count = 0;
+        for (size_t at = 0; at < hdr.used; count++) {
+            flash_log_record_t rec;
+            memcpy(&rec, data + at, sizeof(rec));
+            if (rec.type != FLASH_LOG_REC_TELEMETRY || rec.len != PAYLOAD_LEN) FAIL("bad record in block %u", (unsigned)hdr.seq);
+            uint32_t index;
+            memcpy(&index, data + at + sizeof(rec), sizeof(index));
+            if (have_index && index <= last_index) FAIL("record %u after %u", (unsigned)index, (unsigned)last_index);
+            last_index = index;
+            have_index = true;
+            at += sizeof(rec) + rec.len;
+        }
+        if (count != hdr.count) FAIL("block %u holds %u records, header says %u", (unsigned)hdr.seq, count, hdr.count);
+        records += count;
+        blocks++;
+        pos += sizeof(hdr) + hdr.used;
+    }
+
+    if (blocks > 0) {
+        if (st.next_seq != last_seq + 1) FAIL("resumes at seq %u, newest block is %u", (unsigned)st.next_seq, (unsigned)last_seq);
+        uint32_t prev = (st.head_sector + st.sector_count - 1) % st.sector_count;
+        flash_log_block_t hdr;
+        memcpy(&hdr, flash + (size_t)prev * FLASH_LOG_BLOCK_SIZE, sizeof(hdr));
+        if (hdr.magic != FLASH_LOG_MAGIC || hdr.seq != last_seq) FAIL("resumes at sector %u, not after the newest block", (unsigned)st.head_sector);
+    }
+
+    shared->blocks = blocks;
+    shared->first_seq = first_seq;
+    shared->last_seq = last_seq;
+    shared->records = records;
+    shared->last_index = last_index;
+    free(body);
+    return 0;
+}
+
+static int run_child(int (*fn)(void)) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) _exit(fn());
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+static int throughput_run(void) {
+    int rc = run_child(boot_and_log);
+    const flash_log_stats_t *st = &shared->stats;
+    printf("throughput: %.0f Hz for %.1f s, %d sectors, erase %.0f ms, page %.0f us\n",
+           opt.rate_hz, opt.seconds, opt.sectors, opt.erase_ms, opt.page_us);
+    printf("  %u records written in %u blocks, %u dropped, %u write errors, drained %.2f s after the last record\n",
+           (unsigned)st->records_written, (unsigned)st->blocks_written, (unsigned)st->records_dropped,
+           (unsigned)st->write_errors, shared->drain_s);
+    if (rc != 0) {
+        fprintf(stderr, "logging boot exited with %d\n", rc);
+        return 1;
+    }
+
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (int s = 0; s < opt.sectors; s++) {
+        if (shared->erase_counts[s] < lo) lo = shared->erase_counts[s];
+        if (shared->erase_counts[s] > hi) hi = shared->erase_counts[s];
+    }
+    printf("  erases per sector: %u..%u\n", (unsigned)lo, (unsigned)hi);
+
+    int bad = 0;
+    if (hi - lo > 1) {
+        fprintf(stderr, "uneven wear: erase counts %u..%u\n", (unsigned)lo, (unsigned)hi);
+        bad = 1;
+    }
+    if (st->write_errors) bad = 1;
+    if (opt.expect_no_drops && st->records_dropped) {
+        fprintf(stderr, "records dropped\n");
+        bad = 1;
+    }
+
+    if (run_child(boot_and_verify) != 0) return 1;
+    uint32_t expect_blocks = st->blocks_written < (uint32_t)opt.sectors ? st->blocks_written : (uint32_t)opt.sectors;
+    printf("  after reboot: %u blocks, seq %u..%u, %u records\n", (unsigned)shared->blocks,
+           (unsigned)shared->first_seq, (unsigned)shared->last_seq, (unsigned)shared->records);
+    if (shared->blocks != expect_blocks) {
+        fprintf(stderr, "download has %u blocks, expected %u\n", (unsigned)shared->blocks, (unsigned)expect_blocks);
+        bad = 1;
+    }
+    if (st->records_dropped == 0 && shared->last_index != shared->next_index - 1) {
+        fprintf(stderr, "newest record %u, expected %u\n", (unsigned)shared->last_index, (unsigned)(shared->next_index - 1));
+        bad = 1;
+    }
+    return bad;
+}
+
+static int crash_run(void) {
+    uint64_t rng = opt.seed * 0x9E3779B97F4A7C15ull + 1;
+    uint32_t prev_last = shared->last_seq;
+    uint32_t prev_blocks = shared->blocks;
+    int failures = 0;
+
+    for (int i = 0; i < opt.cuts; i++) {
+        // The first cuts walk through a full block write: the erase, the
+        // records, then every byte of the header. The rest land at random.
+        if (i < 3) cut_units = (uint64_t[]){ 1, 2, FULL_BLOCK_UNITS / 2 }[i];
+        else if (i < 3 + (int)sizeof(flash_log_block_t) + 1) cut_units = FULL_BLOCK_UNITS - sizeof(flash_log_block_t) + (i - 3);
+        else {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            cut_units = 1 + rng % (3 * FULL_BLOCK_UNITS);
+        }
+
+        int rc = run_child(boot_and_cut);
+        if (rc != HOST_FLASH_CUT_STATUS) {
+            fprintf(stderr, "cut %d: boot exited with %d before the power cut\n", i, rc);
+            failures++;
+            continue;
+        }
+        if (run_child(boot_and_verify) != 0) {
+            fprintf(stderr, "cut %d after %llu units: log inconsistent after reboot\n", i, (unsigned long long)cut_units);
+            failures++;
+            continue;
+        }
+        // Blocks committed before the cut survive; only the sector being
+        // overwritten may be lost.
+        if ((int32_t)(shared->last_seq - prev_last) < 0) {
+            fprintf(stderr, "cut %d: newest block went from %u back to %u\n", i, (unsigned)prev_last, (unsigned)shared->last_seq);
+            failures++;
+        }
+        uint32_t floor = prev_blocks < (uint32_t)opt.sectors - 1 ? prev_blocks : (uint32_t)opt.sectors - 1;
+        if (shared->blocks < floor) {
+            fprintf(stderr, "cut %d: %u blocks survived, had %u\n", i, (unsigned)shared->blocks, (unsigned)prev_blocks);
+            failures++;
+        }
+        prev_last = shared->last_seq;
+        prev_blocks = shared->blocks;
+    }
+    printf("crash: %d power cuts, %d inconsistent; log ends with %u blocks, seq %u..%u\n", opt.cuts, failures,
+           (unsigned)shared->blocks, (unsigned)shared->first_seq, (unsigned)shared->last_seq);
+    return failures ? 1 : 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--rate HZ] [--seconds S] [--sectors N] [--erase-ms MS] [--page-us US]\n"
+                    "          [--cuts N] [--seed N] [--expect-no-drops]\n", argv0);
+}
+
+static bool parse_args(int argc, char **argv) {
+    static const struct option longopts[] = {
+        { "rate", required_argument, NULL, 'r' },
+        { "seconds", required_argument, NULL, 's' },
+        { "sectors", required_argument, NULL, 'n' },
+        { "erase-ms", required_argument, NULL, 'e' },
+        { "page-us", required_argument, NULL, 'p' },
+        { "cuts", required_argument, NULL, 'c' },
+        { "seed", required_argument, NULL, 'S' },
+        { "expect-no-drops", no_argument, NULL, 'x' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'r': opt.rate_hz = atof(optarg); break;
+            case 's': opt.seconds = atof(optarg); break;
+            case 'n': opt.sectors = atoi(optarg); break;
+            case 'e': opt.erase_ms = atof(optarg); break;
+            case 'p': opt.page_us = atof(optarg); break;
+            case 'c': opt.cuts = atoi(optarg); break;
+            case 'S': opt.seed = strtoull(optarg, NULL, 10); break;
+            case 'x': opt.expect_no_drops = true; break;
+            default: return false;
+        }
+    }
+    return opt.rate_hz > 0 && opt.seconds > 0 && opt.sectors >= 2 && opt.sectors <= MAX_SECTORS && opt.cuts >= 0;
+}
+
+int main(int argc, char **argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t size = (size_t)opt.sectors * FLASH_LOG_BLOCK_SIZE;
+    flash = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (flash == MAP_FAILED || shared == MAP_FAILED) return 1;
+    memset(flash, 0xFF, size);
+    memset(shared, 0, sizeof(*shared));
+    host_flash_add_partition(FLASH_LOG_PARTITION_LABEL, flash, size);
+
+    int rc = throughput_run();
+    if (opt.cuts > 0) rc |= crash_run();
+    return rc;
+}
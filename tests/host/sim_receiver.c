@@ -0,0 +1,286 @@
+// Receive pipeline simulator. A generator thread plays the Wi-Fi task:
+// it builds frames at a fixed rate, applies the requested impairments and
+// hands each one to a copy of espnow_recv_cb (pool take, queue send). The
+// main thread plays espnow_task: frame check, telemetry_update, snapshot
+// and history_append, then returns the slot. At the end it reports
+// throughput, queueing latency and per-frame processing time.
+//
+//   sim_receiver [--rate HZ] [--seconds S] [--sources N] [--gate-hz HZ]
+//                [--loss PCT] [--dup PCT] [--corrupt PCT] [--seed N]
+//                [--expect-no-drops]
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "frame_gen.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "history.h"
+#include "packet_pool.h"
+#include "state_version.h"
+#include "telemetry.h"
+
+// As in ESP32_Receiver.c / ESP32_Receiver.h.
+#define ESPNOW_QUEUE_SIZE 16
+#define ESPNOW_MAXDELAY 512
+
+atomic_uint state_version;
+
+typedef struct {
+    espnow_data_t *pkt;   // NULL: generator finished
+    int len;
+    int sender;
+    int64_t rx_us;
+} sim_event_t;
+
+typedef struct {
+    double rate_hz;
+    double seconds;
+    int sources;
+    double gate_hz;
+    double loss_pct;
+    double dup_pct;
+    double corrupt_pct;
+    uint64_t seed;
+    bool expect_no_drops;
+} sim_options_t;
+
+typedef struct {
+    uint64_t offered;         // frames the generator built
+    uint64_t lost;            // dropped "on air" (--loss)
+    uint64_t duplicated;      // delivered a second time (--dup)
+    uint64_t corrupted;       // bit flipped (--corrupt)
+    uint64_t received;        // calls into the receive callback
+    uint64_t pool_drops;
+    uint64_t queue_drops;
+} producer_stats_t;
+
+static QueueHandle_t queue;
+static sim_options_t opt = {
+    .rate_hz = 1000, .seconds = 2, .sources = 1, .gate_hz = 5, .seed = 1,
+};
+static producer_stats_t prod;
+
+static bool chance(frame_gen_t *g, double pct) {
+    return pct > 0 && (frame_gen_rand(g) % 1000000) < (uint32_t)(pct * 10000);
+}
+
+// espnow_recv_cb, minus logging and metrics.
+static void recv_cb(int sender, const espnow_data_t *frame, int len) {
+    prod.received++;
+    espnow_data_t *pkt = packet_pool_take();
+    if (pkt == NULL) {
+        prod.pool_drops++;
+        return;
+    }
+    memcpy(pkt, frame, len);
+    sim_event_t evt = { pkt, len, sender, esp_timer_get_time() };
+    if (xQueueSend(queue, &evt, ESPNOW_MAXDELAY) != pdTRUE) {
+        prod.queue_drops++;
+        packet_pool_unget(pkt);
+    }
+}
+
+static void sleep_until(const struct timespec *t) {
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, t, NULL) != 0) {}
+}
+
+static void *generator(void *arg) {
+    frame_gen_t gens[TELEMETRY_MAX_SOURCES + 1];
+    for (int s = 0; s <= opt.sources; s++) {
+        uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0x00, 0x00, (uint8_t)(s + 1) };
+        frame_gen_init(&gens[s], mac, opt.seed * 131 + s);
+    }
+    frame_gen_t *gate = &gens[opt.sources];   // last generator sends gate requests
+
+    uint64_t total = (uint64_t)(opt.rate_hz * opt.seconds);
+    uint64_t gate_every = opt.gate_hz > 0 ? (uint64_t)(opt.rate_hz / opt.gate_hz) : 0;
+    int64_t period_ns = (int64_t)(1e9 / opt.rate_hz);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (uint64_t i = 0; i < total; i++) {
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        sleep_until(&next);
+
+        espnow_data_t frame;
+        int sender;
+        size_t len;
+        if (gate_every && i % gate_every == gate_every - 1) {
+            sender = opt.sources;
+            len = frame_gen_gate_request(gate, &frame, esp_timer_get_time(), 0);
+        } else {
+            sender = (int)(i % (uint64_t)opt.sources);
+            len = frame_gen_telemetry(&gens[sender], &frame);
+        }
+        frame_gen_t *g = &gens[sender];
+        prod.offered++;
+
+        if (chance(g, opt.loss_pct)) {
+            prod.lost++;
+            continue;
+        }
+        if (chance(g, opt.corrupt_pct)) {
+            frame_gen_corrupt(g, &frame, len);
+            prod.corrupted++;
+        }
+        recv_cb(sender, &frame, (int)len);
+        if (chance(g, opt.dup_pct)) {
+            prod.duplicated++;
+            recv_cb(sender, &frame, (int)len);
+        }
+    }
+
+    sim_event_t done = { NULL, 0, 0, 0 };
+    xQueueSend(queue, &done, portMAX_DELAY);
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report_dist(const char *name, uint32_t *v, size_t n) {
+    if (n == 0) return;
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    printf("  %-22s p50 %6u  p99 %6u  p99.9 %6u  max %6u us\n", name,
+           v[n / 2], v[n * 99 / 100], v[n * 999 / 1000], v[n - 1]);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--rate HZ] [--seconds S] [--sources N] [--gate-hz HZ]\n"
+                    "          [--loss PCT] [--dup PCT] [--corrupt PCT] [--seed N] [--expect-no-drops]\n", argv0);
+}
+
+static bool parse_args(int argc, char **argv) {
+    static const struct option longopts[] = {
+        { "rate", required_argument, NULL, 'r' },
+        { "seconds", required_argument, NULL, 's' },
+        { "sources", required_argument, NULL, 'n' },
+        { "gate-hz", required_argument, NULL, 'g' },
+        { "loss", required_argument, NULL, 'l' },
+        { "dup", required_argument, NULL, 'd' },
+        { "corrupt", required_argument, NULL, 'c' },
+        { "seed", required_argument, NULL, 'S' },
+        { "expect-no-drops", no_argument, NULL, 'x' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'r': opt.rate_hz = atof(optarg); break;
+            case 's': opt.seconds = atof(optarg); break;
+            case 'n': opt.sources = atoi(optarg); break;
+            case 'g': opt.gate_hz = atof(optarg); break;
+            case 'l': opt.loss_pct = atof(optarg); break;
+            case 'd': opt.dup_pct = atof(optarg); break;
+            case 'c': opt.corrupt_pct = atof(optarg); break;
+            case 'S': opt.seed = strtoull(optarg, NULL, 10); break;
+            case 'x': opt.expect_no_drops = true; break;
+            default: return false;
+        }
+    }
+    return opt.rate_hz > 0 && opt.seconds > 0 && opt.sources >= 1 && opt.sources <= TELEMETRY_MAX_SOURCES;
+}
+
+int main(int argc, char **argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    packet_pool_init();
+    if (telemetry_init() != ESP_OK || history_init() != ESP_OK) return 1;
+    queue = xQueueCreate(ESPNOW_QUEUE_SIZE, sizeof(sim_event_t));
+
+    size_t cap = (size_t)(opt.rate_hz * opt.seconds * 2) + 16;
+    uint32_t *latency = malloc(cap * sizeof(uint32_t));
+    uint32_t *process = malloc(cap * sizeof(uint32_t));
+    size_t samples = 0;
+    uint64_t processed = 0, rejected = 0, telemetry = 0, requests = 0;
+
+    pthread_t gen;
+    int64_t start_us = esp_timer_get_time();
+    pthread_create(&gen, NULL, generator, NULL);
+
+    // espnow_task
+    for (;;) {
+        sim_event_t evt;
+        xQueueReceive(queue, &evt, portMAX_DELAY);
+        if (evt.pkt == NULL) break;
+
+        int64_t t0 = esp_timer_get_time();
+        espnow_frame_status_t status = espnow_frame_check(evt.pkt, evt.len);
+        if (status != ESPNOW_FRAME_OK && status != ESPNOW_FRAME_OK_LEGACY) {
+            rejected++;
+        } else if (evt.pkt->type == ESPNOW_TELEMETRY) {
+            uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0x00, 0x00, (uint8_t)(evt.sender + 1) };
+            int src = telemetry_update(evt.sender, mac, evt.pkt->data, evt.pkt->len, (uint32_t)(t0 / 1000));
+            if (src >= 0) {
+                telemetry_snapshot_t snap;
+                telemetry_snapshot(src, &snap);
+                history_append(src, &snap);
+            }
+            telemetry++;
+        } else if (evt.pkt->type == ESPNOW_DATA_REQUEST) {
+            requests++;
+        }
+        packet_pool_give(evt.pkt);
+        processed++;
+
+        int64_t t1 = esp_timer_get_time();
+        if (samples < cap) {
+            latency[samples] = (uint32_t)(t0 - evt.rx_us);
+            process[samples] = (uint32_t)(t1 - t0);
+            samples++;
+        }
+    }
+    pthread_join(gen, NULL);
+    double elapsed = (esp_timer_get_time() - start_us) / 1e6;
+
+    packet_pool_stats_t pool;
+    packet_pool_get_stats(&pool);
+    uint64_t enqueued = prod.received - prod.pool_drops - prod.queue_drops;
+
+    printf("sim_receiver: %.0f Hz for %.1f s, %d source(s), gate requests at %.1f Hz\n",
+           opt.rate_hz, opt.seconds, opt.sources, opt.gate_hz);
+    printf("  offered %llu  lost %llu  duplicated %llu  corrupted %llu\n",
+           (unsigned long long)prod.offered, (unsigned long long)prod.lost,
+           (unsigned long long)prod.duplicated, (unsigned long long)prod.corrupted);
+    printf("  received %llu  pool drops %llu  queue drops %llu  processed %llu (%.0f/s)\n",
+           (unsigned long long)prod.received, (unsigned long long)prod.pool_drops,
+           (unsigned long long)prod.queue_drops, (unsigned long long)processed, processed / elapsed);
+    printf("  telemetry %llu  gate requests %llu  rejected %llu\n",
+           (unsigned long long)telemetry, (unsigned long long)requests, (unsigned long long)rejected);
+    report_dist("queue latency", latency, samples);
+    report_dist("processing", process, samples);
+
+    int rc = 0;
+    if (processed != enqueued) {
+        fprintf(stderr, "processed %llu frames, expected %llu\n",
+                (unsigned long long)processed, (unsigned long long)enqueued);
+        rc = 1;
+    }
+    // A slot whose queue send failed stays with the producer for its next take.
+    if (pool.taken - pool.returned > (prod.queue_drops ? 1u : 0u)) {
+        fprintf(stderr, "%u pool slots never returned\n", (unsigned)(pool.taken - pool.returned));
+        rc = 1;
+    }
+    if (opt.expect_no_drops && prod.pool_drops + prod.queue_drops > 0) {
+        fprintf(stderr, "frames dropped in the receive path\n");
+        rc = 1;
+    }
+    free(latency);
+    free(process);
+    return rc;
+}
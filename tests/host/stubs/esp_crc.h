@@ -0,0 +1,12 @@
+#ifndef HOST_STUB_ESP_CRC_H
+#define HOST_STUB_ESP_CRC_H
+
+#include <stdint.h>
+
+// Bitwise versions of the ROM CRC routines, with the ROM's conventions
+// (the running CRC is passed uninverted).
+
+uint16_t esp_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len);
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif //HOST_STUB_ESP_CRC_H
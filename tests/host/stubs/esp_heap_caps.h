@@ -0,0 +1,14 @@
+#ifndef HOST_STUB_ESP_HEAP_CAPS_H
+#define HOST_STUB_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+// Reports what host_heap_set_free() last set; 256 KB, about what the
+// receiver has left after Wi-Fi starts, until then.
+size_t heap_caps_get_free_size(uint32_t caps);
+void host_heap_set_free(size_t bytes);
+
+#endif //HOST_STUB_ESP_HEAP_CAPS_H
@@ -0,0 +1,186 @@
+#ifndef HOST_STUB_ESP_HTTP_SERVER_H
+#define HOST_STUB_ESP_HTTP_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+// Host stand-in for esp_http_server: a request is a capture buffer. Every
+// send call is counted, as each one is a separate lwIP write on the device,
+// and the response body is appended to body (truncated at body_cap).
+// Response headers are captured too; request headers and a request body
+// can be set by the test.
+//
+// httpd_start() records the config and the registered handlers, and
+// host_httpd_call() dispatches a request to them the way the server would:
+// first registered match on method and path, with config.uri_match_fn.
+// httpd_req_async_handler_begin() hands back the request itself, so sends
+// from another task land in the same capture buffer; the test waits on them
+// with host_httpd_wait().
+
+typedef void *httpd_handle_t;
+
+typedef enum { HTTP_DELETE, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_OPTIONS = 6 } httpd_method_t;
+
+#define HOST_HTTPD_HDRS_MAX 512
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    const char *uri;             // path and query, as on the device
+    const char *query;           // without the '?', or NULL
+    size_t content_len;
+    const char *content;         // request body, content_len bytes
+    size_t content_read;
+    const char *req_headers;     // "Name: value\n" lines, or NULL
+    char *body;
+    size_t body_cap;
+    size_t body_len;
+    size_t bytes_sent;
+    unsigned send_calls;         // httpd_resp_send and non-final httpd_resp_send_chunk calls
+    int status;
+    char content_type[48];
+    char headers[HOST_HTTPD_HDRS_MAX];   // response headers, "Name: value\n" lines
+    bool finished;               // httpd_resp_send or the final chunk
+    bool detached;               // httpd_req_async_handler_begin
+    bool completed;              // httpd_req_async_handler_complete
+    bool fail_sends;             // sends fail, as on a closed socket
+    void *user_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *req);
+    void *user_ctx;
+    bool is_websocket;
+} httpd_uri_t;
+
+typedef bool (*httpd_uri_match_func_t)(const char *reference_uri, const char *uri_to_match, size_t match_upto);
+typedef esp_err_t (*httpd_open_func_t)(httpd_handle_t hd, int sockfd);
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+typedef int (*httpd_send_func_t)(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags);
+
+typedef struct {
+    unsigned task_priority;
+    size_t stack_size;
+    uint16_t server_port;
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    uint16_t backlog_conn;
+    bool lru_purge_enable;
+    uint16_t recv_wait_timeout;
+    uint16_t send_wait_timeout;
+    httpd_open_func_t open_fn;
+    httpd_close_func_t close_fn;
+    httpd_uri_match_func_t uri_match_fn;
+} httpd_config_t;
+
+// The ESP-IDF defaults for the fields above.
+#define HTTPD_DEFAULT_CONFIG() {                                              \
+        .task_priority = 5,                                                   \
+        .stack_size = 4096,                                                   \
+        .server_port = 80,                                                    \
+        .max_open_sockets = 7,                                                \
+        .max_uri_handlers = 8,                                                \
+        .backlog_conn = 5,                                                    \
+        .lru_purge_enable = false,                                            \
+        .recv_wait_timeout = 5,                                               \
+        .send_wait_timeout = 5,                                               \
+        .open_fn = NULL,                                                      \
+        .close_fn = NULL,                                                     \
+        .uri_match_fn = NULL,                                                 \
+    }
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST = 400,
+    HTTPD_404_NOT_FOUND = 404,
+    HTTPD_408_REQ_TIMEOUT = 408,
+    HTTPD_500_INTERNAL_SERVER_ERROR = 500,
+} httpd_err_code_t;
+
+#define HTTPD_200 "200 OK"
+#define HTTPD_204 "204 No Content"
+#define HTTPD_304 "304 Not Modified"
+#define HTTPD_RESP_USE_STRLEN -1
+
+#define HTTPD_SOCK_ERR_FAIL -1
+#define HTTPD_SOCK_ERR_INVALID -2
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri);
+bool httpd_uri_match_wildcard(const char *reference_uri, const char *uri_to_match, size_t match_upto);
+esp_err_t httpd_sess_set_send_override(httpd_handle_t hd, int sockfd, httpd_send_func_t fn);
+const char *http_method_str(int method);
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t len);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg);
+esp_err_t httpd_resp_send_408(httpd_req_t *r);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size);
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+int httpd_req_to_sockfd(httpd_req_t *r);
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
+
+// WebSocket API: no host socket is ever a WebSocket, so sends fail.
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT = 0x1,
+    HTTPD_WS_TYPE_BINARY = 0x2,
+    HTTPD_WS_TYPE_CLOSE = 0x8,
+    HTTPD_WS_TYPE_PING = 0x9,
+    HTTPD_WS_TYPE_PONG = 0xA,
+} httpd_ws_type_t;
+
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID = 0x0,
+    HTTPD_WS_CLIENT_HTTP = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+typedef struct {
+    bool final;
+    bool fragmented;
+    httpd_ws_type_t type;
+    uint8_t *payload;
+    size_t len;
+} httpd_ws_frame_t;
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd);
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame);
+esp_err_t httpd_ws_recv_frame(httpd_req_t *r, httpd_ws_frame_t *frame, size_t max_len);
+
+// Test side: point req at a capture buffer.
+void host_httpd_req_init(httpd_req_t *r, const char *uri, const char *query, char *body, size_t body_cap);
+
+// The config httpd_start() was last called with, NULL before.
+const httpd_config_t *host_httpd_config(void);
+
+// Runs the handler registered for method and uri ("/path?query") on r, which
+// host_httpd_req_init() set up; r->uri and r->query are filled in from uri.
+// ESP_ERR_NOT_FOUND when no handler matches.
+esp_err_t host_httpd_call(httpd_req_t *r, int method, const char *uri);
+
+// Value of a captured response header, or NULL. The pointer is valid until
+// the next call.
+const char *host_httpd_resp_hdr(httpd_req_t *r, const char *field);
+
+// From now on sends on r fail, as after the client closed the socket.
+void host_httpd_close(httpd_req_t *r);
+
+// Waits until the request is completed (needle NULL) or its body contains
+// needle; false after timeout_ms. Use for requests sent to from other tasks.
+bool host_httpd_wait(httpd_req_t *r, const char *needle, unsigned timeout_ms);
+
+#endif //HOST_STUB_ESP_HTTP_SERVER_H
@@ -0,0 +1,17 @@
+#ifndef HOST_STUB_ESP_LOG_H
+#define HOST_STUB_ESP_LOG_H
+
+#include "esp_err.h"
+
+// Logs go to stderr. Only errors and warnings by default, so benchmarks
+// are not timing printf; set HOST_LOG=I (or D) to see the rest.
+
+void host_log(char level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...) host_log('E', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) host_log('W', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) host_log('I', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) host_log('D', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) host_log('V', tag, fmt, ##__VA_ARGS__)
+
+#endif //HOST_STUB_ESP_LOG_H
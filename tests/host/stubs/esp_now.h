@@ -0,0 +1,71 @@
+#ifndef HOST_STUB_ESP_NOW_H
+#define HOST_STUB_ESP_NOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_mac.h"
+
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_KEY_LEN 16
+#define ESP_NOW_MAX_DATA_LEN 250
+
+#define ESP_ERR_ESPNOW_BASE 0x3066
+#define ESP_ERR_ESPNOW_NOT_INIT (ESP_ERR_ESPNOW_BASE + 1)
+#define ESP_ERR_ESPNOW_ARG (ESP_ERR_ESPNOW_BASE + 2)
+#define ESP_ERR_ESPNOW_NO_MEM (ESP_ERR_ESPNOW_BASE + 3)
+#define ESP_ERR_ESPNOW_FULL (ESP_ERR_ESPNOW_BASE + 4)
+#define ESP_ERR_ESPNOW_NOT_FOUND (ESP_ERR_ESPNOW_BASE + 5)
+#define ESP_ERR_ESPNOW_INTERNAL (ESP_ERR_ESPNOW_BASE + 6)
+#define ESP_ERR_ESPNOW_EXIST (ESP_ERR_ESPNOW_BASE + 7)
+
+typedef enum { ESP_IF_WIFI_STA, ESP_IF_WIFI_AP } wifi_interface_t;
+
+typedef struct {
+    uint8_t peer_addr[ESP_NOW_ETH_ALEN];
+    uint8_t lmk[ESP_NOW_KEY_LEN];
+    uint8_t channel;
+    wifi_interface_t ifidx;
+    bool encrypt;
+    void *priv;
+} esp_now_peer_info_t;
+
+typedef enum { ESP_NOW_SEND_SUCCESS, ESP_NOW_SEND_FAIL } esp_now_send_status_t;
+
+typedef struct {
+    uint8_t *src_addr;
+    uint8_t *des_addr;
+} esp_now_recv_info_t;
+
+typedef struct {
+    uint8_t *src_addr;
+    uint8_t *des_addr;
+} esp_now_send_info_t;
+
+// Mocked: peers live in a table, sends are captured instead of transmitted.
+bool esp_now_is_peer_exist(const uint8_t *peer_addr);
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer);
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data, size_t len);
+
+// Test side.
+#define HOST_ESPNOW_PEER_MAX 20         // ESP_NOW_MAX_TOTAL_PEER_NUM
+#define HOST_ESPNOW_SENT_MAX 64
+
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+    size_t len;
+} host_espnow_sent_t;
+
+void host_espnow_reset(void);
+// Sends since the reset; the first HOST_ESPNOW_SENT_MAX are kept.
+int host_espnow_sent_count(void);
+const host_espnow_sent_t *host_espnow_sent(int i);
+int host_espnow_peer_count(void);
+const esp_now_peer_info_t *host_espnow_peer(int i);
+// The next calls return err instead (ESP_OK to clear).
+void host_espnow_fail_send(esp_err_t err);
+void host_espnow_fail_add_peer(esp_err_t err);
+
+#endif //HOST_STUB_ESP_NOW_H
@@ -0,0 +1,67 @@
+#include <string.h>
+#include "esp_now.h"
+
+static esp_now_peer_info_t peers[HOST_ESPNOW_PEER_MAX];
+static int peer_count;
+static host_espnow_sent_t sent[HOST_ESPNOW_SENT_MAX];
+static int sent_count;
+static esp_err_t send_err, add_peer_err;
+
+void host_espnow_reset(void) {
+    peer_count = sent_count = 0;
+    send_err = add_peer_err = ESP_OK;
+}
+
+int host_espnow_sent_count(void) {
+    return sent_count;
+}
+
+const host_espnow_sent_t *host_espnow_sent(int i) {
+    return i >= 0 && i < sent_count && i < HOST_ESPNOW_SENT_MAX ? &sent[i] : NULL;
+}
+
+int host_espnow_peer_count(void) {
+    return peer_count;
+}
+
+const esp_now_peer_info_t *host_espnow_peer(int i) {
+    return i >= 0 && i < peer_count ? &peers[i] : NULL;
+}
+
+void host_espnow_fail_send(esp_err_t err) {
+    send_err = err;
+}
+
+void host_espnow_fail_add_peer(esp_err_t err) {
+    add_peer_err = err;
+}
+
+bool esp_now_is_peer_exist(const uint8_t *peer_addr) {
+    for (int i = 0; i < peer_count; i++) {
+        if (memcmp(peers[i].peer_addr, peer_addr, ESP_NOW_ETH_ALEN) == 0) return true;
+    }
+    return false;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer) {
+    if (peer == NULL) return ESP_ERR_ESPNOW_ARG;
+    if (add_peer_err != ESP_OK) return add_peer_err;
+    if (esp_now_is_peer_exist(peer->peer_addr)) return ESP_ERR_ESPNOW_EXIST;
+    if (peer_count == HOST_ESPNOW_PEER_MAX) return ESP_ERR_ESPNOW_FULL;
+    peers[peer_count++] = *peer;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data, size_t len) {
+    if (peer_addr == NULL || data == NULL || len == 0 || len > ESP_NOW_MAX_DATA_LEN) return ESP_ERR_ESPNOW_ARG;
+    if (!esp_now_is_peer_exist(peer_addr)) return ESP_ERR_ESPNOW_NOT_FOUND;
+    if (send_err != ESP_OK) return send_err;
+    if (sent_count < HOST_ESPNOW_SENT_MAX) {
+        host_espnow_sent_t *s = &sent[sent_count];
+        memcpy(s->mac, peer_addr, ESP_NOW_ETH_ALEN);
+        memcpy(s->data, data, len);
+        s->len = len;
+    }
+    sent_count++;
+    return ESP_OK;
+}
@@ -0,0 +1,45 @@
+#ifndef HOST_STUB_ESP_PARTITION_H
+#define HOST_STUB_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Host stand-in for esp_partition over caller-provided memory, with NOR
+// flash semantics: erase sets a 4 KB sector to 0xFF and a write can only
+// clear bits. Erase and program times can be simulated, and a power cut
+// can be scheduled: the process exits with HOST_FLASH_CUT_STATUS partway
+// through the operation that crosses it, leaving that operation torn.
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0, ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+#define ESP_PARTITION_SUBTYPE_ANY 0xff
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size);
+
+// Test side.
+#define HOST_FLASH_SECTOR 4096
+#define HOST_FLASH_CUT_STATUS 99
+
+// One data partition backed by mem (size bytes, a multiple of the sector
+// size). Map mem shared to inspect it after a forked child is cut off.
+void host_flash_add_partition(const char *label, uint8_t *mem, size_t size);
+void host_flash_set_timing(uint32_t erase_us_per_sector, uint32_t program_us_per_page);
+// Cut power after this many more units: a byte programmed or a sector erased.
+void host_flash_cut_after(uint64_t units);
+uint32_t host_flash_erase_count(uint32_t sector);
+
+#endif //HOST_STUB_ESP_PARTITION_H
@@ -0,0 +1,173 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "esp_crc.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                  return "ESP_OK";
+        case ESP_FAIL:                return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:          return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:     return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:   return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:    return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:       return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_TIMEOUT:         return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NVS_NOT_FOUND:   return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_TYPE_MISMATCH: return "ESP_ERR_NVS_TYPE_MISMATCH";
+        case ESP_ERR_NVS_READ_ONLY:   return "ESP_ERR_NVS_READ_ONLY";
+        case ESP_ERR_NVS_INVALID_HANDLE: return "ESP_ERR_NVS_INVALID_HANDLE";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_ESPNOW_ARG:      return "ESP_ERR_ESPNOW_ARG";
+        case ESP_ERR_ESPNOW_NO_MEM:   return "ESP_ERR_ESPNOW_NO_MEM";
+        case ESP_ERR_ESPNOW_FULL:     return "ESP_ERR_ESPNOW_FULL";
+        case ESP_ERR_ESPNOW_NOT_FOUND: return "ESP_ERR_ESPNOW_NOT_FOUND";
+        case ESP_ERR_ESPNOW_EXIST:    return "ESP_ERR_ESPNOW_EXIST";
+        default:                      return "ESP_ERR_UNKNOWN";
+    }
+}
+
+static int level_rank(char level) {
+    switch (level) {
+        case 'E': return 1;
+        case 'W': return 2;
+        case 'I': return 3;
+        case 'D': return 4;
+        default:  return 5;
+    }
+}
+
+void host_log(char level, const char *tag, const char *fmt, ...) {
+    static int max_rank;
+    if (max_rank == 0) {
+        const char *env = getenv("HOST_LOG");
+        max_rank = env && env[0] ? level_rank(env[0]) : level_rank('W');
+    }
+    if (level_rank(level) > max_rank) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%c (%s) ", level, tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+int64_t esp_timer_get_time(void) {
+    static struct timespec start;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (start.tv_sec == 0 && start.tv_nsec == 0) start = now;
+    return (int64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+#define HOST_TIMER_MAX 8
+
+struct host_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool active;
+    uint64_t deadline_us;
+};
+
+static struct host_timer timers[HOST_TIMER_MAX];
+static int timer_count;
+static uint64_t timer_now_us;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+    if (args == NULL || args->callback == NULL || out == NULL) return ESP_ERR_INVALID_ARG;
+    if (timer_count == HOST_TIMER_MAX) return ESP_ERR_NO_MEM;
+    struct host_timer *t = &timers[timer_count++];
+    t->callback = args->callback;
+    t->arg = args->arg;
+    t->active = false;
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us) {
+    if (t->active) return ESP_ERR_INVALID_STATE;
+    t->active = true;
+    t->deadline_us = timer_now_us + timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+    if (t->active) return ESP_ERR_INVALID_STATE;
+    t->callback = NULL;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t) {
+    return t->active;
+}
+
+void host_timer_advance(uint64_t us) {
+    uint64_t end = timer_now_us + us;
+    for (;;) {
+        struct host_timer *next = NULL;
+        for (int i = 0; i < timer_count; i++) {
+            struct host_timer *t = &timers[i];
+            if (t->active && t->deadline_us <= end && (next == NULL || t->deadline_us < next->deadline_us)) {
+                next = t;
+            }
+        }
+        if (next == NULL) break;
+        timer_now_us = next->deadline_us;
+        next->active = false;
+        next->callback(next->arg);
+    }
+    timer_now_us = end;
+}
+
+static size_t heap_free = 256 * 1024;
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return heap_free;
+}
+
+void host_heap_set_free(size_t bytes) {
+    heap_free = bytes;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+uint16_t esp_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0x8408u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+uint32_t esp_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
@@ -0,0 +1,10 @@
+#ifndef HOST_STUB_ESP_SYSTEM_H
+#define HOST_STUB_ESP_SYSTEM_H
+
+#include <stdint.h>
+
+// Both report heap_caps_get_free_size(MALLOC_CAP_8BIT), see esp_heap_caps.h.
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#endif //HOST_STUB_ESP_SYSTEM_H
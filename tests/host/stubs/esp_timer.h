@@ -0,0 +1,31 @@
+#ifndef HOST_STUB_ESP_TIMER_H
+#define HOST_STUB_ESP_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Monotonic microseconds since the process started.
+int64_t esp_timer_get_time(void);
+
+// Timers run on a virtual clock that only moves in host_timer_advance(),
+// which fires due callbacks on the calling thread, in deadline order.
+typedef struct host_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+esp_err_t esp_timer_delete(esp_timer_handle_t t);
+bool esp_timer_is_active(esp_timer_handle_t t);
+
+// Test side.
+void host_timer_advance(uint64_t us);
+
+#endif //HOST_STUB_ESP_TIMER_H
@@ -0,0 +1,7 @@
+#ifndef HOST_STUB_ESP_WIFI_H
+#define HOST_STUB_ESP_WIFI_H
+
+// wifi_interface_t lives with the ESP-NOW mock in esp_now.h.
+#include "esp_now.h"
+
+#endif //HOST_STUB_ESP_WIFI_H
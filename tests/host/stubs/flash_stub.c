@@ -0,0 +1,105 @@
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_partition.h"
+
+#define PAGE_SIZE 256
+#define MAX_SECTORS 1024
+
+static esp_partition_t part;
+static uint8_t *flash;
+static uint32_t erase_us;
+static uint32_t page_us;
+static uint64_t cut_units;
+static bool cut_armed;
+static uint32_t erase_counts[MAX_SECTORS];
+
+void host_flash_add_partition(const char *label, uint8_t *mem, size_t size) {
+    memset(&part, 0, sizeof(part));
+    part.type = ESP_PARTITION_TYPE_DATA;
+    part.subtype = 0x40;
+    part.size = (uint32_t)size;
+    part.erase_size = HOST_FLASH_SECTOR;
+    strncpy(part.label, label, sizeof(part.label) - 1);
+    flash = mem;
+    memset(erase_counts, 0, sizeof(erase_counts));
+}
+
+void host_flash_set_timing(uint32_t erase_us_per_sector, uint32_t program_us_per_page) {
+    erase_us = erase_us_per_sector;
+    page_us = program_us_per_page;
+}
+
+void host_flash_cut_after(uint64_t units) {
+    cut_units = units;
+    cut_armed = true;
+}
+
+uint32_t host_flash_erase_count(uint32_t sector) {
+    return sector < MAX_SECTORS ? erase_counts[sector] : 0;
+}
+
+static void busy_us(uint64_t us) {
+    if (us == 0) return;
+    struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// How many of n units may run before the cut; n if no cut is due.
+static size_t units_before_cut(size_t n) {
+    if (!cut_armed || cut_units > n) {
+        if (cut_armed) cut_units -= n;
+        return n;
+    }
+    return (size_t)cut_units;
+}
+
+static void power_cut(void) {
+    _exit(HOST_FLASH_CUT_STATUS);
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (flash == NULL || type != part.type) return NULL;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != part.subtype) return NULL;
+    if (label && strcmp(label, part.label) != 0) return NULL;
+    return &part;
+}
+
+static bool in_range(const esp_partition_t *p, size_t offset, size_t size) {
+    return p == &part && offset <= p->size && size <= p->size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t offset, void *dst, size_t size) {
+    if (!in_range(p, offset, size)) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, flash + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t offset, const void *src, size_t size) {
+    if (!in_range(p, offset, size)) return ESP_ERR_INVALID_SIZE;
+    size_t n = units_before_cut(size);
+    const uint8_t *s = src;
+    for (size_t i = 0; i < n; i++) flash[offset + i] &= s[i];
+    busy_us((uint64_t)page_us * ((size + PAGE_SIZE - 1) / PAGE_SIZE));
+    if (n < size) power_cut();
+    return ESP_OK;
+}
+
+// An interrupted erase leaves the front of the sector erased.
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size) {
+    if (!in_range(p, offset, size) || offset % HOST_FLASH_SECTOR || size % HOST_FLASH_SECTOR) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t at = offset; at < offset + size; at += HOST_FLASH_SECTOR) {
+        if (units_before_cut(1) == 0) {
+            memset(flash + at, 0xFF, HOST_FLASH_SECTOR / 2);
+            power_cut();
+        }
+        memset(flash + at, 0xFF, HOST_FLASH_SECTOR);
+        if (at / HOST_FLASH_SECTOR < MAX_SECTORS) erase_counts[at / HOST_FLASH_SECTOR]++;
+        busy_us(erase_us);
+    }
+    return ESP_OK;
+}
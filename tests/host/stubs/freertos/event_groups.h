@@ -0,0 +1,15 @@
+#ifndef HOST_STUB_FREERTOS_EVENT_GROUPS_H
+#define HOST_STUB_FREERTOS_EVENT_GROUPS_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_event_group *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t eg, EventBits_t bits);
+// Returns the bits as they were when the wait ended, before any clear.
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t eg, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t wait);
+
+#endif //HOST_STUB_FREERTOS_EVENT_GROUPS_H
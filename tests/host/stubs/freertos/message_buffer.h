@@ -0,0 +1,14 @@
+#ifndef HOST_STUB_FREERTOS_MESSAGE_BUFFER_H
+#define HOST_STUB_FREERTOS_MESSAGE_BUFFER_H
+
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+// Each message takes its length plus a 4-byte length word, as on the device.
+typedef struct host_message_buffer *MessageBufferHandle_t;
+
+MessageBufferHandle_t xMessageBufferCreate(size_t size);
+size_t xMessageBufferSend(MessageBufferHandle_t mb, const void *data, size_t len, TickType_t wait);
+size_t xMessageBufferReceive(MessageBufferHandle_t mb, void *buf, size_t buf_len, TickType_t wait);
+
+#endif //HOST_STUB_FREERTOS_MESSAGE_BUFFER_H
@@ -0,0 +1,14 @@
+#ifndef HOST_STUB_FREERTOS_SEMPHR_H
+#define HOST_STUB_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+// Mutexes only, on pthread mutexes.
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
+void vSemaphoreDelete(SemaphoreHandle_t s);
+
+#endif //HOST_STUB_FREERTOS_SEMPHR_H
@@ -0,0 +1,329 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/message_buffer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_task {
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t value;
+    bool pending;
+};
+
+struct task_start {
+    TaskFunction_t fn;
+    void *arg;
+    TaskHandle_t task;
+};
+
+static __thread TaskHandle_t current_task;
+
+static void *task_main(void *p) {
+    struct task_start start = *(struct task_start *)p;
+    free(p);
+    current_task = start.task;
+    start.fn(start.arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    struct task_start *start = malloc(sizeof(*start));
+    TaskHandle_t task = calloc(1, sizeof(*task));
+    if (start == NULL || task == NULL) {
+        free(start);
+        free(task);
+        return pdFAIL;
+    }
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->notified, NULL);
+    start->fn = fn;
+    start->arg = arg;
+    start->task = task;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_main, start) != 0) {
+        free(start);
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = { ticks / 1000, (long)(ticks % 1000) * 1000000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+// Absolute CLOCK_REALTIME deadline for pthread_cond_timedwait.
+void host_deadline(struct timespec *ts, TickType_t wait) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += wait / 1000;
+    ts->tv_nsec += (long)(wait % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+// Waits on cond until pred holds; false on timeout. wait 0 polls once.
+#define WAIT_FOR(pred, cond, mutex, wait) ({                                  \
+        bool ok_ = true;                                                      \
+        if (!(pred)) {                                                        \
+            if ((wait) == 0) {                                                \
+                ok_ = false;                                                  \
+            } else if ((wait) == portMAX_DELAY) {                             \
+                while (!(pred)) pthread_cond_wait(cond, mutex);               \
+            } else {                                                          \
+                struct timespec ts_;                                          \
+                host_deadline(&ts_, wait);                                    \
+                while (!(pred) && ok_) {                                      \
+                    if (pthread_cond_timedwait(cond, mutex, &ts_) == ETIMEDOUT) ok_ = (pred); \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+        ok_;                                                                  \
+    })
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    if (q == NULL) return NULL;
+    q->items = malloc((size_t)length * item_size);
+    if (q->items == NULL) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait) {
+    pthread_mutex_lock(&q->lock);
+    bool ok = WAIT_FOR(q->count < q->length, &q->not_full, &q->lock, wait);
+    if (ok) {
+        UBaseType_t tail = (q->head + q->count) % q->length;
+        memcpy(q->items + (size_t)tail * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait) {
+    pthread_mutex_lock(&q->lock);
+    bool ok = WAIT_FOR(q->count > 0, &q->not_empty, &q->lock, wait);
+    if (ok) {
+        memcpy(item, q->items + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->items);
+    free(q);
+}
+
+// Byte ring of [uint32_t length][message] records.
+struct host_message_buffer {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    size_t size;
+    size_t head;
+    size_t used;
+    uint8_t *bytes;
+};
+
+#define MB_LEN_WORD sizeof(uint32_t)
+
+MessageBufferHandle_t xMessageBufferCreate(size_t size) {
+    MessageBufferHandle_t mb = calloc(1, sizeof(*mb));
+    if (mb == NULL) return NULL;
+    mb->bytes = malloc(size);
+    if (mb->bytes == NULL) {
+        free(mb);
+        return NULL;
+    }
+    pthread_mutex_init(&mb->lock, NULL);
+    pthread_cond_init(&mb->changed, NULL);
+    mb->size = size;
+    return mb;
+}
+
+static void mb_put(MessageBufferHandle_t mb, const void *src, size_t n) {
+    size_t at = (mb->head + mb->used) % mb->size;
+    size_t first = n < mb->size - at ? n : mb->size - at;
+    memcpy(mb->bytes + at, src, first);
+    memcpy(mb->bytes, (const uint8_t *)src + first, n - first);
+    mb->used += n;
+}
+
+static void mb_peek(MessageBufferHandle_t mb, size_t skip, void *dst, size_t n) {
+    size_t at = (mb->head + skip) % mb->size;
+    size_t first = n < mb->size - at ? n : mb->size - at;
+    memcpy(dst, mb->bytes + at, first);
+    memcpy((uint8_t *)dst + first, mb->bytes, n - first);
+}
+
+size_t xMessageBufferSend(MessageBufferHandle_t mb, const void *data, size_t len, TickType_t wait) {
+    size_t need = MB_LEN_WORD + len;
+    if (need > mb->size) return 0;
+    pthread_mutex_lock(&mb->lock);
+    bool ok = WAIT_FOR(mb->size - mb->used >= need, &mb->changed, &mb->lock, wait);
+    if (ok) {
+        uint32_t word = (uint32_t)len;
+        mb_put(mb, &word, MB_LEN_WORD);
+        mb_put(mb, data, len);
+        pthread_cond_broadcast(&mb->changed);
+    }
+    pthread_mutex_unlock(&mb->lock);
+    return ok ? len : 0;
+}
+
+// A message longer than buf_len stays queued and 0 is returned.
+size_t xMessageBufferReceive(MessageBufferHandle_t mb, void *buf, size_t buf_len, TickType_t wait) {
+    pthread_mutex_lock(&mb->lock);
+    bool ok = WAIT_FOR(mb->used > 0, &mb->changed, &mb->lock, wait);
+    size_t len = 0;
+    if (ok) {
+        uint32_t word;
+        mb_peek(mb, 0, &word, MB_LEN_WORD);
+        if (word <= buf_len) {
+            mb_peek(mb, MB_LEN_WORD, buf, word);
+            mb->head = (mb->head + MB_LEN_WORD + word) % mb->size;
+            mb->used -= MB_LEN_WORD + word;
+            len = word;
+            pthread_cond_broadcast(&mb->changed);
+        }
+    }
+    pthread_mutex_unlock(&mb->lock);
+    return len;
+}
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t s = calloc(1, sizeof(*s));
+    if (s) pthread_mutex_init(&s->lock, NULL);
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+    if (wait == portMAX_DELAY) return pthread_mutex_lock(&s->lock) == 0 ? pdTRUE : pdFALSE;
+    if (wait == 0) return pthread_mutex_trylock(&s->lock) == 0 ? pdTRUE : pdFALSE;
+    struct timespec ts;
+    host_deadline(&ts, wait);
+    return pthread_mutex_timedlock(&s->lock, &ts) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    return pthread_mutex_unlock(&s->lock) == 0 ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) {
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    pthread_mutex_lock(&task->lock);
+    if (action == eSetBits) task->value |= value;
+    task->pending = true;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t wait) {
+    TaskHandle_t task = current_task;
+    pthread_mutex_lock(&task->lock);
+    if (!task->pending) task->value &= ~clear_on_entry;
+    bool ok = WAIT_FOR(task->pending, &task->notified, &task->lock, wait);
+    if (value) *value = task->value;
+    if (ok) {
+        task->value &= ~clear_on_exit;
+        task->pending = false;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    EventGroupHandle_t eg = calloc(1, sizeof(*eg));
+    if (eg == NULL) return NULL;
+    pthread_mutex_init(&eg->lock, NULL);
+    pthread_cond_init(&eg->changed, NULL);
+    return eg;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t eg, EventBits_t bits) {
+    pthread_mutex_lock(&eg->lock);
+    eg->bits |= bits;
+    EventBits_t now = eg->bits;
+    pthread_cond_broadcast(&eg->changed);
+    pthread_mutex_unlock(&eg->lock);
+    return now;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t eg, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t wait) {
+    pthread_mutex_lock(&eg->lock);
+    bool ok = WAIT_FOR(wait_for_all ? (eg->bits & bits) == bits : (eg->bits & bits) != 0,
+                       &eg->changed, &eg->lock, wait);
+    EventBits_t seen = eg->bits;
+    if (ok && clear_on_exit) eg->bits &= ~bits;
+    pthread_mutex_unlock(&eg->lock);
+    return seen;
+}
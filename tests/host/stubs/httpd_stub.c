@@ -0,0 +1,290 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "esp_http_server.h"
+
+#define HOST_HTTPD_URIS 40
+
+// One lock for every request, so a test thread can read what another task
+// sent; changed is broadcast after every send and completion.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+
+static httpd_config_t config;
+static bool started;
+static httpd_uri_t uris[HOST_HTTPD_URIS];
+static int uri_count;
+
+void host_httpd_req_init(httpd_req_t *r, const char *uri, const char *query, char *body, size_t body_cap) {
+    memset(r, 0, sizeof(*r));
+    r->method = HTTP_GET;
+    r->uri = uri;
+    r->query = query;
+    r->body = body;
+    r->body_cap = body_cap;
+    r->status = 200;
+    if (body_cap) body[0] = '\0';
+}
+
+static void capture(httpd_req_t *r, const char *buf, size_t len) {
+    r->bytes_sent += len;
+    if (r->body == NULL || r->body_len >= r->body_cap) return;
+    size_t n = len < r->body_cap - 1 - r->body_len ? len : r->body_cap - 1 - r->body_len;
+    memcpy(r->body + r->body_len, buf, n);
+    r->body_len += n;
+    r->body[r->body_len] = '\0';
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t len) {
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? (ssize_t)strlen(buf) : 0;
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = r->fail_sends ? ESP_FAIL : ESP_OK;
+    if (ret == ESP_OK) {
+        r->send_calls++;
+        if (buf) capture(r, buf, (size_t)len);
+        r->finished = true;
+    }
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+// A NULL or empty chunk ends the response and is not counted as a write.
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t len) {
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? (ssize_t)strlen(buf) : 0;
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = r->fail_sends ? ESP_FAIL : ESP_OK;
+    if (ret == ESP_OK && (buf == NULL || len == 0)) {
+        r->finished = true;
+    } else if (ret == ESP_OK) {
+        r->send_calls++;
+        capture(r, buf, (size_t)len);
+    }
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str) {
+    return httpd_resp_send_chunk(r, str, str ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    strncpy(r->content_type, type, sizeof(r->content_type) - 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    size_t used = strlen(r->headers);
+    size_t need = strlen(field) + 2 + strlen(value) + 1;
+    if (used + need >= sizeof(r->headers)) return ESP_ERR_INVALID_SIZE;
+    snprintf(r->headers + used, sizeof(r->headers) - used, "%s: %s\n", field, value);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+    r->status = atoi(status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg) {
+    r->status = error;
+    return httpd_resp_send(r, msg, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_408(httpd_req_t *r) {
+    return httpd_resp_send_err(r, HTTPD_408_REQ_TIMEOUT, "Request Timeout");
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len) {
+    if (r->query == NULL) return ESP_ERR_NOT_FOUND;
+    if (strlen(r->query) >= buf_len) return ESP_ERR_INVALID_SIZE;
+    strcpy(buf, r->query);
+    return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size) {
+    size_t key_len = strlen(key);
+    for (const char *p = qry; p && *p; p = strchr(p, '&') ? strchr(p, '&') + 1 : NULL) {
+        if (strncmp(p, key, key_len) != 0 || p[key_len] != '=') continue;
+        const char *v = p + key_len + 1;
+        size_t n = strcspn(v, "&");
+        if (n >= val_size) return ESP_ERR_INVALID_SIZE;
+        memcpy(val, v, n);
+        val[n] = '\0';
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Header lines are "Name: value\n"; names compare case-insensitively.
+static const char *find_hdr(const char *lines, const char *field, size_t *len) {
+    size_t n = strlen(field);
+    for (const char *p = lines; p && *p; p = strchr(p, '\n') ? strchr(p, '\n') + 1 : NULL) {
+        if (strncasecmp(p, field, n) != 0 || p[n] != ':') continue;
+        const char *v = p + n + 1;
+        while (*v == ' ') v++;
+        *len = strcspn(v, "\n");
+        return v;
+    }
+    return NULL;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size) {
+    size_t n;
+    const char *v = find_hdr(r->req_headers, field, &n);
+    if (v == NULL) return ESP_ERR_NOT_FOUND;
+    if (n >= val_size) return ESP_ERR_INVALID_SIZE;
+    memcpy(val, v, n);
+    val[n] = '\0';
+    return ESP_OK;
+}
+
+const char *host_httpd_resp_hdr(httpd_req_t *r, const char *field) {
+    static char value[128];
+    size_t n;
+    const char *v = find_hdr(r->headers, field, &n);
+    if (v == NULL) return NULL;
+    if (n >= sizeof(value)) n = sizeof(value) - 1;
+    memcpy(value, v, n);
+    value[n] = '\0';
+    return value;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+    size_t left = r->content_len - r->content_read;
+    size_t n = buf_len < left ? buf_len : left;
+    if (n) memcpy(buf, r->content + r->content_read, n);
+    r->content_read += n;
+    return (int)n;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r) {
+    return 3;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out) {
+    pthread_mutex_lock(&lock);
+    r->detached = true;
+    pthread_mutex_unlock(&lock);
+    *out = r;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r) {
+    pthread_mutex_lock(&lock);
+    r->completed = true;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+void host_httpd_close(httpd_req_t *r) {
+    pthread_mutex_lock(&lock);
+    r->fail_sends = true;
+    pthread_mutex_unlock(&lock);
+}
+
+bool host_httpd_wait(httpd_req_t *r, const char *needle, unsigned timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&lock);
+    bool done;
+    for (;;) {
+        done = needle ? r->body && strstr(r->body, needle) != NULL : r->completed;
+        if (done || pthread_cond_timedwait(&changed, &lock, &deadline) == ETIMEDOUT) break;
+    }
+    if (!done) done = needle ? r->body && strstr(r->body, needle) != NULL : r->completed;
+    pthread_mutex_unlock(&lock);
+    return done;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd) {
+    return HTTPD_WS_CLIENT_HTTP;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame) {
+    return ESP_FAIL;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *r, httpd_ws_frame_t *frame, size_t max_len) {
+    frame->len = 0;
+    return ESP_OK;
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *cfg) {
+    config = *cfg;
+    started = true;
+    uri_count = 0;
+    *handle = &config;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    started = false;
+    return ESP_OK;
+}
+
+const httpd_config_t *host_httpd_config(void) {
+    return started ? &config : NULL;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri) {
+    if (uri_count >= config.max_uri_handlers || uri_count >= HOST_HTTPD_URIS) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < uri_count; i++) {
+        if (uris[i].method == uri->method && strcmp(uris[i].uri, uri->uri) == 0) return ESP_ERR_INVALID_STATE;
+    }
+    uris[uri_count++] = *uri;
+    return ESP_OK;
+}
+
+// As in ESP-IDF: a trailing '*' matches any rest, a trailing '?' makes the
+// character before it optional; anything else must match exactly.
+bool httpd_uri_match_wildcard(const char *tpl, const char *uri, size_t len) {
+    size_t tpl_len = strlen(tpl);
+    if (tpl_len && tpl[tpl_len - 1] == '*') {
+        return len >= tpl_len - 1 && strncmp(tpl, uri, tpl_len - 1) == 0;
+    }
+    if (tpl_len && tpl[tpl_len - 1] == '?') {
+        tpl_len--;
+        if (len == tpl_len - 1 && strncmp(tpl, uri, len) == 0) return true;
+    }
+    return len == tpl_len && strncmp(tpl, uri, len) == 0;
+}
+
+esp_err_t host_httpd_call(httpd_req_t *r, int method, const char *uri) {
+    size_t path_len = strcspn(uri, "?");
+    r->uri = uri;
+    r->query = uri[path_len] == '?' ? uri + path_len + 1 : NULL;
+    r->method = method;
+    r->handle = &config;
+    for (int i = 0; i < uri_count; i++) {
+        const httpd_uri_t *u = &uris[i];
+        if ((int)u->method != method) continue;
+        bool match = config.uri_match_fn ? config.uri_match_fn(u->uri, uri, path_len)
+                                         : strlen(u->uri) == path_len && strncmp(u->uri, uri, path_len) == 0;
+        if (!match) continue;
+        r->user_ctx = u->user_ctx;
+        return u->handler(r);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_sess_set_send_override(httpd_handle_t hd, int sockfd, httpd_send_func_t fn) {
+    return ESP_OK;
+}
+
+const char *http_method_str(int method) {
+    static const char *names[] = { "DELETE", "GET", "HEAD", "POST", "PUT", "CONNECT", "OPTIONS" };
+    return method >= 0 && method < (int)(sizeof(names) / sizeof(names[0])) ? names[method] : "<unknown>";
+}
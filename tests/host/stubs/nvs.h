@@ -0,0 +1,38 @@
+#ifndef HOST_STUB_NVS_H
+#define HOST_STUB_NVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Host stand-in for NVS, backed by a file so a test can "reboot" and read
+// back what was stored. Like the device, every set is written through to
+// storage; nvs_commit only checks the handle.
+
+#define ESP_ERR_NVS_BASE 0x1100
+#define ESP_ERR_NVS_NOT_INITIALIZED (ESP_ERR_NVS_BASE + 0x01)
+#define ESP_ERR_NVS_NOT_FOUND (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_TYPE_MISMATCH (ESP_ERR_NVS_BASE + 0x03)
+#define ESP_ERR_NVS_READ_ONLY (ESP_ERR_NVS_BASE + 0x04)
+#define ESP_ERR_NVS_INVALID_HANDLE (ESP_ERR_NVS_BASE + 0x07)
+#define ESP_ERR_NVS_INVALID_LENGTH (ESP_ERR_NVS_BASE + 0x0c)
+
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out);
+void nvs_close(nvs_handle_t h);
+esp_err_t nvs_commit(nvs_handle_t h);
+esp_err_t nvs_get_u16(nvs_handle_t h, const char *key, uint16_t *out);
+esp_err_t nvs_set_u16(nvs_handle_t h, const char *key, uint16_t value);
+// out NULL: *len is set to the stored size.
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *key, void *out, size_t *len);
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *key, const void *value, size_t len);
+
+// Test side. Loads path (missing is empty) and writes every change back to
+// it; calling it again is a reboot. NULL keeps NVS in memory only.
+void host_nvs_init(const char *path);
+// Sets since host_nvs_init, i.e. flash writes on the device.
+unsigned host_nvs_writes(void);
+
+#endif //HOST_STUB_NVS_H
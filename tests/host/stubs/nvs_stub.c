@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvs.h"
+
+#define MAX_ENTRIES 64
+#define MAX_HANDLES 8
+#define NAME_MAX_LEN 15         // NVS_KEY_NAME_MAX_SIZE - 1
+#define VALUE_MAX 4000          // largest single-page blob
+
+enum { TYPE_NAMESPACE, TYPE_U16, TYPE_BLOB };
+
+typedef struct {
+    char ns[NAME_MAX_LEN + 1];
+    char key[NAME_MAX_LEN + 1];
+    uint8_t type;
+    uint32_t len;
+    uint8_t value[VALUE_MAX];
+} entry_t;
+
+typedef struct {
+    bool open;
+    bool writable;
+    char ns[NAME_MAX_LEN + 1];
+} handle_t;
+
+static entry_t entries[MAX_ENTRIES];
+static int entry_count;
+static handle_t handles[MAX_HANDLES];
+static char file_path[256];
+static unsigned writes;
+
+// File: per entry ns[16] key[16] u8 type u32 len value[len].
+static void save(void) {
+    if (file_path[0] == '\0') return;
+    char tmp[sizeof(file_path) + 4];
+    snprintf(tmp, sizeof(tmp), "%s.new", file_path);
+    FILE *f = fopen(tmp, "wb");
+    if (f == NULL) return;
+    for (int i = 0; i < entry_count; i++) {
+        const entry_t *e = &entries[i];
+        fwrite(e->ns, sizeof(e->ns), 1, f);
+        fwrite(e->key, sizeof(e->key), 1, f);
+        fwrite(&e->type, 1, 1, f);
+        fwrite(&e->len, sizeof(e->len), 1, f);
+        fwrite(e->value, e->len, 1, f);
+    }
+    fclose(f);
+    rename(tmp, file_path);
+}
+
+static void load(void) {
+    FILE *f = fopen(file_path, "rb");
+    if (f == NULL) return;
+    while (entry_count < MAX_ENTRIES) {
+        entry_t *e = &entries[entry_count];
+        if (fread(e->ns, sizeof(e->ns), 1, f) != 1 || fread(e->key, sizeof(e->key), 1, f) != 1 ||
+            fread(&e->type, 1, 1, f) != 1 || fread(&e->len, sizeof(e->len), 1, f) != 1 ||
+            e->len > VALUE_MAX || (e->len && fread(e->value, e->len, 1, f) != 1)) {
+            break;
+        }
+        entry_count++;
+    }
+    fclose(f);
+}
+
+void host_nvs_init(const char *path) {
+    memset(entries, 0, sizeof(entries));
+    memset(handles, 0, sizeof(handles));
+    entry_count = 0;
+    writes = 0;
+    file_path[0] = '\0';
+    if (path) {
+        snprintf(file_path, sizeof(file_path), "%s", path);
+        load();
+    }
+}
+
+unsigned host_nvs_writes(void) {
+    return writes;
+}
+
+static entry_t *find(const char *ns, const char *key) {
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].ns, ns) == 0 && strcmp(entries[i].key, key) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+static handle_t *handle(nvs_handle_t h) {
+    return h >= 1 && h <= MAX_HANDLES && handles[h - 1].open ? &handles[h - 1] : NULL;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out) {
+    if (strlen(name) > NAME_MAX_LEN) return ESP_ERR_INVALID_ARG;
+    if (find(name, "") == NULL) {
+        if (mode == NVS_READONLY) return ESP_ERR_NVS_NOT_FOUND;
+        if (entry_count == MAX_ENTRIES) return ESP_ERR_NO_MEM;
+        entry_t *e = &entries[entry_count++];
+        memset(e, 0, sizeof(*e));
+        strcpy(e->ns, name);
+        e->type = TYPE_NAMESPACE;
+        save();
+    }
+    for (int i = 0; i < MAX_HANDLES; i++) {
+        if (handles[i].open) continue;
+        handles[i].open = true;
+        handles[i].writable = mode == NVS_READWRITE;
+        strcpy(handles[i].ns, name);
+        *out = (nvs_handle_t)(i + 1);
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t h) {
+    handle_t *hd = handle(h);
+    if (hd) hd->open = false;
+}
+
+esp_err_t nvs_commit(nvs_handle_t h) {
+    return handle(h) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+static esp_err_t get(nvs_handle_t h, const char *key, uint8_t type, void *out, size_t *len) {
+    handle_t *hd = handle(h);
+    if (hd == NULL) return ESP_ERR_NVS_INVALID_HANDLE;
+    const entry_t *e = find(hd->ns, key);
+    if (e == NULL) return ESP_ERR_NVS_NOT_FOUND;
+    if (e->type != type) return ESP_ERR_NVS_TYPE_MISMATCH;
+    if (out == NULL) {
+        *len = e->len;
+        return ESP_OK;
+    }
+    if (*len < e->len) return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out, e->value, e->len);
+    *len = e->len;
+    return ESP_OK;
+}
+
+static esp_err_t set(nvs_handle_t h, const char *key, uint8_t type, const void *value, size_t len) {
+    handle_t *hd = handle(h);
+    if (hd == NULL) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!hd->writable) return ESP_ERR_NVS_READ_ONLY;
+    if (key[0] == '\0' || strlen(key) > NAME_MAX_LEN) return ESP_ERR_INVALID_ARG;
+    if (len > VALUE_MAX) return ESP_ERR_NVS_INVALID_LENGTH;
+    entry_t *e = find(hd->ns, key);
+    if (e == NULL) {
+        if (entry_count == MAX_ENTRIES) return ESP_ERR_NO_MEM;
+        e = &entries[entry_count++];
+        memset(e, 0, sizeof(*e));
+        strcpy(e->ns, hd->ns);
+        strcpy(e->key, key);
+    }
+    e->type = type;
+    e->len = (uint32_t)len;
+    memcpy(e->value, value, len);
+    writes++;
+    save();
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t h, const char *key, uint16_t *out) {
+    size_t len = sizeof(*out);
+    return get(h, key, TYPE_U16, out, &len);
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t h, const char *key, uint16_t value) {
+    return set(h, key, TYPE_U16, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *key, void *out, size_t *len) {
+    return get(h, key, TYPE_BLOB, out, len);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *key, const void *value, size_t len) {
+    return set(h, key, TYPE_BLOB, value, len);
+}
@@ -0,0 +1,27 @@
+// What ESP32_Receiver.c and the embedded dashboard files provide to
+// server.c, for the host HTTP tests. The file contents are placeholders;
+// the .gz copies are not real gzip, only distinguishable from the rest.
+
+// ESP32_Receiver.h
+unsigned espnow_queue_depth(void);
+
+unsigned espnow_queue_depth(void) {
+    return 0;
+}
+
+// As EMBED_FILES lays them out: _binary_<name>_start/_end around the bytes.
+#define EMBED(name, text)                                                     \
+    __asm__(".section .rodata\n"                                              \
+            ".global _binary_" name "_start\n"                                \
+            "_binary_" name "_start:\n"                                       \
+            ".ascii \"" text "\"\n"                                           \
+            ".global _binary_" name "_end\n"                                  \
+            "_binary_" name "_end:\n"                                         \
+            ".previous\n")
+
+EMBED("index_html", "<!doctype html><script src=/assets/index.js?v=1></script>");
+EMBED("index_css", "body{margin:0}");
+EMBED("index_js", "console.log(1)");
+EMBED("index_html_gz", "gz:index.html");
+EMBED("index_css_gz", "gz:index.css");
+EMBED("index_js_gz", "gz:index.js");
@@ -0,0 +1,4 @@
+#ifndef HOST_STUB_ROM_ETS_SYS_H
+#define HOST_STUB_ROM_ETS_SYS_H
+
+#endif //HOST_STUB_ROM_ETS_SYS_H
@@ -0,0 +1,7 @@
+// What server.c provides to the modules built on the host.
+
+#include "esp_http_server.h"
+
+void set_cors(httpd_req_t *req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+}
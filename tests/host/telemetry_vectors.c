@@ -0,0 +1,140 @@
+// Writes the receiver's decoding of generated telemetry as JSON, for
+// test_ts_decoder.mjs to replay through the dashboard's decoder:
+//
+//   { "segments": [ { "key", "bytes": [[...]], "raw": [[...]], "text": [[...]] } ],
+//     "fields":   [ { "key", "field", "raw": [...], "text": [...] } ] }
+//
+// segments: per segment, edge-case and random byte patterns with each
+// field's raw value and telemetry_format_field() text. fields: per field,
+// a sweep of raw values across every rounding step near zero and strided
+// over the rest of its range.
+//
+//   telemetry_vectors OUT.json
+
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "json_writer.h"
+#include "state_version.h"
+#include "telemetry.h"
+#include "telemetry_schema.h"
+
+#define RANDOM_PATTERNS 300
+#define OUT_CAP (4 << 20)
+
+atomic_uint state_version;
+
+static uint64_t rng = 0x2545F4914F6CDD1Dull;
+
+static uint8_t rnd_byte(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (uint8_t)(rng >> 32);
+}
+
+static void field_text(const telemetry_field_t *f, int32_t raw, char *out, size_t len) {
+    CHECK(telemetry_format_field(f, raw, out, len) >= 0);
+}
+
+static void write_segment(json_writer_t *w, int s) {
+    const segment_t *seg = &segments[s];
+    static const uint8_t edges[][2] = {
+        { 0x00, 0x00 }, { 0xFF, 0xFF }, { 0x7F, 0xFF }, { 0x80, 0x00 },
+        { 0x00, 0x01 }, { 0x01, 0x00 }, { 0xFF, 0xFE }, { 0x80, 0x01 },
+    };
+    int patterns = (int)(sizeof(edges) / sizeof(edges[0])) + RANDOM_PATTERNS;
+    uint8_t payload[TELEMETRY_FRAME_LEN];
+    char text[TELEMETRY_VALUE_MAX];
+
+    json_begin_object(w);
+    json_key(w, "key");
+    json_string(w, seg->name);
+    for (int pass = 0; pass < 3; pass++) {
+        json_key(w, pass == 0 ? "bytes" : pass == 1 ? "raw" : "text");
+        json_begin_array(w);
+        rng = 0x2545F4914F6CDD1Dull + s;   // same patterns on every pass
+        for (int p = 0; p < patterns; p++) {
+            memset(payload, 0, sizeof(payload));
+            for (int i = 0; i < seg->len; i++) {
+                payload[seg->offset + i] = p < 8 ? edges[p][i & 1] : rnd_byte();
+            }
+            json_begin_array(w);
+            if (pass == 0) {
+                for (int i = 0; i < seg->len; i++) json_int(w, payload[seg->offset + i]);
+            }
+            for (int i = 0; pass > 0 && i < seg->field_count; i++) {
+                const telemetry_field_t *f = &telemetry_fields[seg->first_field + i];
+                int32_t raw = telemetry_field_raw(f, payload);
+                if (pass == 1) {
+                    json_int(w, raw);
+                } else {
+                    field_text(f, raw, text, sizeof(text));
+                    json_string(w, text);
+                }
+            }
+            json_end_array(w);
+        }
+        json_end_array(w);
+    }
+    json_end_object(w);
+}
+
+static void write_field(json_writer_t *w, int s, int i) {
+    const telemetry_field_t *f = &telemetry_fields[segments[s].first_field + i];
+    int32_t lo = f->type == TELEMETRY_I16 ? INT16_MIN : 0;
+    int32_t hi = f->type == TELEMETRY_U8 ? UINT8_MAX : f->type == TELEMETRY_U16 ? UINT16_MAX : INT16_MAX;
+    char text[TELEMETRY_VALUE_MAX];
+
+    json_begin_object(w);
+    json_key(w, "key");   json_string(w, segments[s].name);
+    json_key(w, "field"); json_string(w, f->name);
+    for (int pass = 0; pass < 2; pass++) {
+        json_key(w, pass == 0 ? "raw" : "text");
+        json_begin_array(w);
+        for (int32_t raw = lo; raw <= hi; raw += raw >= -1000 && raw < 1000 ? 1 : 97) {
+            if (pass == 0) {
+                json_int(w, raw);
+            } else {
+                field_text(f, raw, text, sizeof(text));
+                json_string(w, text);
+            }
+        }
+        json_end_array(w);
+    }
+    json_end_object(w);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s OUT.json\n", argv[0]);
+        return 2;
+    }
+
+    char *buf = malloc(OUT_CAP);
+    json_writer_t w;
+    json_init_buffer(&w, buf, OUT_CAP, 1);
+    json_begin_object(&w);
+    json_key(&w, "segments");
+    json_begin_array(&w);
+    for (int s = 0; s < NUM_SEGMENTS; s++) write_segment(&w, s);
+    json_end_array(&w);
+    json_key(&w, "fields");
+    json_begin_array(&w);
+    for (int s = 0; s < NUM_SEGMENTS; s++) {
+        for (int i = 0; i < segments[s].field_count; i++) write_field(&w, s, i);
+    }
+    json_end_array(&w);
+    json_end_object(&w);
+    size_t len = json_finish_buffer(&w);
+    CHECK(!w.overflow);
+
+    FILE *f = fopen(argv[1], "w");
+    CHECK(f != NULL);
+    if (f) {
+        CHECK_EQ(fwrite(buf, 1, len, f), len);
+        fclose(f);
+    }
+    free(buf);
+    return host_test_result("telemetry_vectors");
+}
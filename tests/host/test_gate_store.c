@@ -0,0 +1,172 @@
+// gate_store: a burst of saves inside the debounce window costs one NVS
+// write and an unchanged snapshot costs none; configs survive a reboot;
+// blobs of another format or cut short are rejected. Each boot is a forked
+// child reading the NVS file the previous one left.
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "esp_timer.h"
+#include "gate_store.h"
+#include "host_test.h"
+#include "nvs.h"
+#include "peers.h"
+
+#define MS 1000ull
+
+static char nvs_path[64];
+
+static const struct {
+    uint8_t mac[6];
+    gate_mode_t mode;
+    const char *group;
+    int order;
+    int stored_order;
+} gates[] = {
+    { { 0x24, 0x6f, 0x28, 0, 0, 1 }, GATE_MODE_SERIES, "track A", 0, 0 },
+    { { 0x24, 0x6f, 0x28, 0, 0, 2 }, GATE_MODE_SERIES, "track A", -5, -5 },
+    { { 0x24, 0x6f, 0x28, 0, 0, 3 }, GATE_MODE_DELTA, "0123456789abcdef0123456789abcde", 40000, INT16_MAX },
+};
+#define GATES (int)(sizeof(gates) / sizeof(gates[0]))
+
+static void boot(void) {
+    host_nvs_init(nvs_path);
+    peers_init();
+}
+
+// Runs fn as one boot in a child; its failed checks fail the parent.
+static void run_boot(void (*fn)(void)) {
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+        host_test_failures = 0;
+        boot();
+        fn();
+        _exit(host_test_failures ? 1 : 0);
+    }
+    int status = 0;
+    CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void configure(int i) {
+    peer_t *p = peer_get_or_add(gates[i].mac);
+    p->config.mode = gates[i].mode;
+    strcpy(p->config.group, gates[i].group);
+    p->config.order = gates[i].order;
+    peer_set(p, PEER_F_CONFIG);
+    gate_store_schedule_save();
+}
+
+static void first_boot(void) {
+    CHECK_EQ(gate_store_init(), ESP_OK);
+    CHECK_EQ(peer_count(), 0);
+
+    // A peer heard from but never configured is not stored.
+    peer_get_or_add((const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 9 });
+
+    // UI edits 500 ms apart keep pushing the write back.
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < GATES; i++) {
+            configure(i);
+            host_timer_advance(500 * MS);
+        }
+    }
+    CHECK_EQ(host_nvs_writes(), 0);
+    host_timer_advance((GATE_STORE_DEBOUNCE_MS - 500) * MS - 1);
+    CHECK_EQ(host_nvs_writes(), 0);
+    host_timer_advance(1);
+    CHECK_EQ(host_nvs_writes(), 1);
+
+    // Same configs again: no write.
+    gate_store_schedule_save();
+    host_timer_advance(GATE_STORE_DEBOUNCE_MS * MS);
+    CHECK_EQ(host_nvs_writes(), 1);
+}
+
+static void check_loaded(void) {
+    CHECK_EQ(gate_store_init(), ESP_OK);
+    CHECK_EQ(peer_count(), GATES);
+    for (int i = 0; i < GATES; i++) {
+        peer_t *p = peer_find(gates[i].mac);
+        CHECK(p != NULL);
+        if (p == NULL) continue;
+        CHECK(peer_has(p, PEER_F_CONFIG));
+        CHECK_EQ(p->config.mode, gates[i].mode);
+        CHECK(strcmp(p->config.group, gates[i].group) == 0);
+        CHECK_EQ(p->config.order, gates[i].stored_order);
+    }
+    CHECK(peer_find((const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 9 }) == NULL);
+
+    // Loading is not a change; the first real edit is one write.
+    gate_store_schedule_save();
+    host_timer_advance(GATE_STORE_DEBOUNCE_MS * MS);
+    CHECK_EQ(host_nvs_writes(), 0);
+}
+
+static void second_boot(void) {
+    check_loaded();
+    peer_t *p = peer_find(gates[1].mac);
+    p->config.mode = GATE_MODE_DELTA;
+    p->config.group[0] = '\0';
+    gate_store_schedule_save();
+    host_timer_advance(GATE_STORE_DEBOUNCE_MS * MS);
+    CHECK_EQ(host_nvs_writes(), 1);
+}
+
+static void third_boot(void) {
+    CHECK_EQ(gate_store_init(), ESP_OK);
+    peer_t *p = peer_find(gates[1].mac);
+    CHECK(p != NULL && p->config.mode == GATE_MODE_DELTA && p->config.group[0] == '\0');
+}
+
+static void put_blob(const uint8_t *blob, size_t len) {
+    nvs_handle_t nvs;
+    CHECK_EQ(nvs_open("peers", NVS_READWRITE, &nvs), ESP_OK);
+    CHECK_EQ(nvs_set_blob(nvs, "gate_cfg", blob, len), ESP_OK);
+    nvs_close(nvs);
+}
+
+static void wrong_format(void) {
+    put_blob((const uint8_t[]){ GATE_STORE_FORMAT + 1, 0 }, 2);
+    CHECK_EQ(gate_store_init(), ESP_ERR_INVALID_VERSION);
+    CHECK_EQ(peer_count(), 0);
+}
+
+static void truncated(void) {
+    // Two entries announced, the second cut off inside its MAC.
+    const uint8_t blob[] = { GATE_STORE_FORMAT, 2, 1, 2, 3, 4, 5, 6, GATE_MODE_SERIES, 7, 0, 1, 'g', 9, 9 };
+    put_blob(blob, sizeof(blob));
+    CHECK_EQ(gate_store_init(), ESP_ERR_INVALID_SIZE);
+}
+
+static void group_too_long(void) {
+    uint8_t blob[2 + 10 + 32] = { GATE_STORE_FORMAT, 1, 1, 2, 3, 4, 5, 6, GATE_MODE_DELTA, 0, 0, 32 };
+    memset(&blob[12], 'x', 32);
+    put_blob(blob, sizeof(blob));
+    CHECK_EQ(gate_store_init(), ESP_ERR_INVALID_SIZE);
+}
+
+static void fresh_nvs(void) {
+    unlink(nvs_path);
+}
+
+int main(void) {
+    snprintf(nvs_path, sizeof(nvs_path), "/tmp/test_gate_store.%d", (int)getpid());
+
+    fresh_nvs();
+    run_boot(first_boot);
+    run_boot(second_boot);
+    run_boot(third_boot);
+
+    fresh_nvs();
+    run_boot(wrong_format);
+    fresh_nvs();
+    run_boot(truncated);
+    fresh_nvs();
+    run_boot(group_too_long);
+
+    fresh_nvs();
+    return host_test_result("test_gate_store");
+}
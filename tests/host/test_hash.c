@@ -0,0 +1,180 @@
+// hash: random inserts, overwrites and removes against a plain array model,
+// through several resizes and with long probe runs for the backward shift
+// to repair; in-place overwrites keep their pointer; freed blocks are
+// reused, so steady churn makes no heap calls; refused entries leave the
+// table unchanged.
+
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_count.h"
+#include "hash.h"
+#include "host_test.h"
+
+#define KEYS 600
+#define OPS 200000
+
+static char keys[KEYS][48];
+static char *model[KEYS];     // NULL = absent
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rnd(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (uint32_t)(rng >> 16);
+}
+
+static void random_value(char *buf, size_t max) {
+    // Mostly short, like formatted readings, sometimes past a size class.
+    size_t len = rnd() % 4 ? rnd() % 12 : rnd() % (max - 1);
+    for (size_t i = 0; i < len; i++) buf[i] = (char)('a' + rnd() % 26);
+    buf[len] = '\0';
+}
+
+static int live_count(void) {
+    int n = 0;
+    for (int i = 0; i < KEYS; i++) n += model[i] != NULL;
+    return n;
+}
+
+// Every model entry is found with its value; the walk sees each once.
+static void check_table(const struct HashTable *t) {
+    CHECK_EQ(t->count, live_count());
+    CHECK(t->count * 4 <= t->capacity * 3);
+    int mismatched = 0;
+    for (int i = 0; i < KEYS; i++) {
+        const char *v = hashtable_get(t, keys[i]);
+        if (model[i] == NULL ? v != NULL : v == NULL || strcmp(v, model[i]) != 0) mismatched++;
+    }
+    CHECK_EQ(mismatched, 0);
+
+    uint32_t pos = 0, walked = 0;
+    const char *k, *v;
+    while (hashtable_next(t, &pos, &k, &v)) walked++;
+    CHECK_EQ(walked, t->count);
+}
+
+static void test_model(void) {
+    struct HashTable t = hashtable_create();
+    CHECK_EQ(t.capacity, HASH_INITIAL_CAPACITY);
+    CHECK(hashtable_get(&t, "missing") == NULL);
+    CHECK(!hashtable_remove(&t, "missing"));
+
+    char value[200];
+    for (int op = 0; op < OPS; op++) {
+        // Key space narrows and widens so the table fills, drains and grows.
+        int span = op % 50000 < 25000 ? KEYS : KEYS / 8;
+        int i = (int)(rnd() % span);
+        if (rnd() % 3 == 0) {
+            bool had = model[i] != NULL;
+            CHECK_EQ(hashtable_remove(&t, keys[i]), had);
+            free(model[i]);
+            model[i] = NULL;
+        } else {
+            random_value(value, sizeof(value));
+            CHECK(hashtable_insert(&t, keys[i], value));
+            free(model[i]);
+            model[i] = strdup(value);
+        }
+        if (op % 5000 == 0) check_table(&t);
+    }
+    check_table(&t);
+    CHECK(t.capacity >= 512);
+
+    // Drain completely: every slot must come back empty.
+    for (int i = 0; i < KEYS; i++) {
+        if (model[i] == NULL) continue;
+        CHECK(hashtable_remove(&t, keys[i]));
+        free(model[i]);
+        model[i] = NULL;
+    }
+    check_table(&t);
+    uint32_t pos = 0;
+    const char *k, *v;
+    CHECK(!hashtable_next(&t, &pos, &k, &v));
+    hashtable_destroy(&t);
+    CHECK(t.slots == NULL && t.capacity == 0);
+}
+
+static void test_overwrite(void) {
+    struct HashTable t = hashtable_create();
+    CHECK(hashtable_insert(&t, "speed", "12.5"));
+    const char *p = hashtable_get(&t, "speed");
+
+    // Fits the 8-byte block: rewritten in place.
+    CHECK(hashtable_insert(&t, "speed", "1234567"));
+    CHECK(hashtable_get(&t, "speed") == p);
+    CHECK(strcmp(p, "1234567") == 0);
+
+    // Does not fit: moves, and the old block serves the next 8-byte
+    // allocation, here the key of the next insert.
+    CHECK(hashtable_insert(&t, "speed", "123456789"));
+    CHECK(hashtable_get(&t, "speed") != p);
+    CHECK(strcmp(hashtable_get(&t, "speed"), "123456789") == 0);
+    CHECK(hashtable_insert(&t, "rpm", "900"));
+    uint32_t pos = 0;
+    const char *k, *v;
+    bool reused = false;
+    while (hashtable_next(&t, &pos, &k, &v)) reused |= k == p && strcmp(k, "rpm") == 0;
+    CHECK(reused);
+
+    // Too long for the largest class: refused, old value kept.
+    size_t huge = ((size_t)HASH_MIN_BLOCK << (HASH_NUM_CLASSES - 1)) + 1;
+    char *big = malloc(huge);
+    memset(big, 'x', huge - 1);
+    big[huge - 1] = '\0';
+    CHECK(!hashtable_insert(&t, "speed", big));
+    CHECK(strcmp(hashtable_get(&t, "speed"), "123456789") == 0);
+    CHECK(!hashtable_insert(&t, big, "1"));
+    CHECK_EQ(t.count, 2);
+    big[huge - 2] = '\0';
+    CHECK(hashtable_insert(&t, "speed", big));
+    CHECK_EQ(strlen(hashtable_get(&t, "speed")), huge - 2);
+    free(big);
+
+    CHECK(!hashtable_insert(&t, NULL, "v"));
+    CHECK(!hashtable_insert(&t, "k", NULL));
+    hashtable_destroy(&t);
+}
+
+// Once every size class has blocks on its free list, removing and
+// re-adding entries of the same sizes is served from the free lists.
+static void churn(struct HashTable *t, int round) {
+    char value[64];
+    for (int i = round % 2; i < 256; i += 2) CHECK(hashtable_remove(t, keys[i]));
+    for (int i = round % 2; i < 256; i += 2) {
+        snprintf(value, sizeof(value), "%0*d", i % 40, i + round);
+        CHECK(hashtable_insert(t, keys[i], value));
+    }
+    for (int i = 0; i < 256; i++) {
+        snprintf(value, sizeof(value), "%0*d", (i + round) % 40, i);
+        CHECK(hashtable_insert(t, keys[i], value));
+    }
+}
+
+static void test_churn_no_heap(void) {
+    struct HashTable t = hashtable_create();
+    char value[64];
+    for (int i = 0; i < 256; i++) {
+        snprintf(value, sizeof(value), "%0*d", i % 40, i);
+        CHECK(hashtable_insert(&t, keys[i], value));
+    }
+    // Value lengths cycle every 40 rounds; one cycle sizes the free lists.
+    int round = 0;
+    for (; round < 40; round++) churn(&t, round);
+    unsigned long allocs = host_allocs();
+    for (; round < 200; round++) churn(&t, round);
+    CHECK_EQ(host_allocs() - allocs, 0);
+    hashtable_destroy(&t);
+}
+
+int main(void) {
+    for (int i = 0; i < KEYS; i++) {
+        // Lengths 3..40 so keys land in several size classes.
+        snprintf(keys[i], sizeof(keys[i]), "%s.%d", "telemetry.channel.segment.name" + (i % 31), i);
+    }
+    test_model();
+    test_overwrite();
+    test_churn_no_heap();
+    return host_test_result("test_hash");
+}
@@ -0,0 +1,189 @@
+// history: queries over raw frames match a brute-force binning exactly,
+// queries over the whole retained span see every frame once, and extreme
+// ranges (from=0, to=UINT32_MAX) stay within HISTORY_MAX_POINTS. A range
+// starting inside an aggregate bucket counts that bucket.
+
+#include <stdlib.h>
+#include <string.h>
+#include "frame_gen.h"
+#include "history.h"
+#include "host_test.h"
+#include "state_version.h"
+#include "telemetry_schema.h"
+
+#define FRAMES 20000          // 200 s at 100 Hz, all within L3's reach
+#define PERIOD_MS 10
+#define T0_MS 1000
+
+atomic_uint state_version;
+
+static int32_t *values;       // per frame, of the channel under test
+static uint32_t *times;
+
+static int32_t channel_raw(int ch, const uint8_t *raw) {
+    return telemetry_field_raw(&telemetry_fields[telemetry_series[ch]], raw);
+}
+
+static void fill(int ch) {
+    frame_gen_t g;
+    frame_gen_init(&g, (const uint8_t[6]){ 0x24, 0x6f, 0x28, 0, 0, 1 }, 7);
+    for (int i = 0; i < FRAMES; i++) {
+        espnow_data_t frame;
+        frame_gen_telemetry(&g, &frame);
+        telemetry_snapshot_t snap = { 0 };
+        memcpy(snap.raw, frame.data, frame.len);
+        snap.rx_ms = T0_MS + (uint32_t)i * PERIOD_MS;
+        history_append(0, &snap);
+        values[i] = channel_raw(ch, snap.raw);
+        times[i] = snap.rx_ms;
+    }
+}
+
+static void check_ordered(const history_result_t *r, uint32_t from, uint32_t to) {
+    for (int i = 0; i < r->count; i++) {
+        const history_point_t *p = &r->points[i];
+        CHECK(p->t_ms >= from && p->t_ms <= to);
+        CHECK(p->min <= p->mean && p->mean <= p->max);
+        if (i) CHECK(p->t_ms > r->points[i - 1].t_ms);
+    }
+}
+
+// The last 200 frames are all still raw: bins must match exactly.
+static void test_raw_exact(int ch) {
+    static history_result_t r;
+    uint32_t from = times[FRAMES - 200], to = times[FRAMES - 1];
+    int points = 37;
+    CHECK(history_query(0, ch, from, to, points, &r));
+    CHECK_EQ(r.level, 0);
+    check_ordered(&r, from, to);
+
+    uint64_t span = (uint64_t)to - from + 1;
+    uint64_t width = (span + points - 1) / points;
+    int n = 0;
+    for (uint64_t b = 0; from + b * width <= to; b++) {
+        uint32_t lo = from + (uint32_t)(b * width);
+        uint64_t hi = lo + width;
+        int32_t min = INT32_MAX, max = INT32_MIN;
+        int64_t sum = 0;
+        int count = 0;
+        for (int i = FRAMES - 200; i < FRAMES; i++) {
+            if (times[i] < lo || times[i] >= hi) continue;
+            if (values[i] < min) min = values[i];
+            if (values[i] > max) max = values[i];
+            sum += values[i];
+            count++;
+        }
+        if (count == 0) continue;
+        if (n >= r.count) {
+            n++;
+            continue;
+        }
+        CHECK_EQ(r.points[n].t_ms, lo);
+        CHECK_EQ(r.points[n].min, min);
+        CHECK_EQ(r.points[n].max, max);
+        CHECK_EQ(r.points[n].mean, (int32_t)(sum / count));
+        n++;
+    }
+    CHECK_EQ(r.count, n);
+}
+
+// Everything appended is still covered by some level.
+static void test_full_span(int ch) {
+    static history_result_t r;
+    CHECK(history_query(0, ch, times[0], times[FRAMES - 1], 100, &r));
+    CHECK(r.level > 0);
+    CHECK(r.count > 0 && r.count <= 100);
+    check_ordered(&r, times[0], times[FRAMES - 1]);
+
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    for (int i = 0; i < FRAMES; i++) {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+    }
+    int32_t got_min = INT32_MAX, got_max = INT32_MIN;
+    for (int i = 0; i < r.count; i++) {
+        if (r.points[i].min < got_min) got_min = r.points[i].min;
+        if (r.points[i].max > got_max) got_max = r.points[i].max;
+    }
+    CHECK_EQ(got_min, min);
+    CHECK_EQ(got_max, max);
+}
+
+// Older than the raw ring, so read from L1, and starting 4 frames into a
+// bucket: that bucket and the next one, which holds the end, make the point.
+static void test_straddling_bucket(int ch) {
+    static history_result_t r;
+    int first = FRAMES - 300;
+    int bucket = first - first % HISTORY_FANOUT;
+    CHECK(first != bucket);
+    CHECK(history_query(0, ch, times[first], times[first + 15], 1, &r));
+    CHECK_EQ(r.level, 1);
+    CHECK_EQ(r.count, 1);
+
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    int64_t sum = 0;
+    for (int i = bucket; i < bucket + 2 * HISTORY_FANOUT; i++) {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+        sum += values[i];
+    }
+    CHECK_EQ(r.points[0].t_ms, times[first]);
+    CHECK_EQ(r.points[0].min, min);
+    CHECK_EQ(r.points[0].max, max);
+    CHECK_EQ(r.points[0].mean, (int32_t)(sum / (2 * HISTORY_FANOUT)));
+}
+
+static void test_extreme_ranges(int ch) {
+    static history_result_t r;
+    CHECK(history_query(0, ch, 0, UINT32_MAX, HISTORY_MAX_POINTS, &r));
+    CHECK(r.count >= 1 && r.count <= HISTORY_MAX_POINTS);
+    check_ordered(&r, 0, UINT32_MAX);
+
+    CHECK(history_query(0, ch, 0, UINT32_MAX, 7, &r));
+    CHECK(r.count >= 1 && r.count <= 7);
+
+    CHECK(history_query(0, ch, UINT32_MAX - 10, UINT32_MAX, HISTORY_MAX_POINTS, &r));
+    CHECK_EQ(r.count, 0);
+
+    // Clamped and defaulted point counts.
+    CHECK(history_query(0, ch, times[0], times[FRAMES - 1], 100000, &r));
+    CHECK(r.count <= HISTORY_MAX_POINTS);
+    CHECK(history_query(0, ch, times[0], times[FRAMES - 1], 0, &r));
+    CHECK(r.count <= HISTORY_DEFAULT_POINTS);
+
+    // A single millisecond holding one frame.
+    CHECK(history_query(0, ch, times[FRAMES - 1], times[FRAMES - 1], 10, &r));
+    CHECK_EQ(r.count, 1);
+    CHECK_EQ(r.points[0].min, values[FRAMES - 1]);
+
+    // Reversed range, unknown channel, source without history.
+    CHECK(history_query(0, ch, 500, 100, 10, &r));
+    CHECK_EQ(r.count, 0);
+    CHECK(history_query(0, history_channel_count(), 0, UINT32_MAX, 10, &r));
+    CHECK_EQ(r.count, 0);
+    CHECK(history_query(HISTORY_MAX_SOURCES, ch, 0, UINT32_MAX, 10, &r));
+    CHECK_EQ(r.count, 0);
+}
+
+int main(void) {
+    CHECK_EQ(history_init(), ESP_OK);
+    CHECK(history_channel_count() > 0);
+    for (int c = 0; c < history_channel_count(); c++) {
+        CHECK_EQ(history_find_channel(history_channel_name(c)), c);
+    }
+    CHECK_EQ(history_find_channel("no_such_series"), -1);
+
+    values = malloc(FRAMES * sizeof(*values));
+    times = malloc(FRAMES * sizeof(*times));
+    int ch = history_channel_count() / 2;
+    fill(ch);
+
+    test_raw_exact(ch);
+    test_full_span(ch);
+    test_straddling_bucket(ch);
+    test_extreme_ranges(ch);
+
+    free(values);
+    free(times);
+    return host_test_result("test_history");
+}
@@ -0,0 +1,362 @@
+// The HTTP handlers, dispatched through the host httpd as the server would:
+// static assets (ETag, 304, gzip, immutable with ?v=), /telemetry and
+// /timing deltas and 304s, /telemetry/<key> as hex or decoded,
+// /telemetry/history in the field's unit, the /telemetry array staying
+// well-formed when it overflows render_buf, /timing/export.csv across
+// several chunks, /timing/depth, /metrics, /laps, /timing/wait (immediate,
+// woken by a trigger, timed out, full) and /stream (initial events, full,
+// a client that went away).
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_http_server.h"
+#include "frame_gen.h"
+#include "gate_store.h"
+#include "gate_wait.h"
+#include "history.h"
+#include "host_test.h"
+#include "laps.h"
+#include "nvs.h"
+#include "packet_pool.h"
+#include "peers.h"
+#include "server.h"
+#include "state_version.h"
+#include "stream.h"
+#include "telemetry.h"
+#include "telemetry_schema.h"
+
+// server.c
+httpd_handle_t start(void);
+
+#define BODY_MAX 65536
+
+static char body[BODY_MAX];
+static const uint8_t car[6] = { 0x24, 0x6f, 0x28, 0, 0, 0x10 };
+static const uint8_t gate_macs[2][6] = {
+    { 0x24, 0x6f, 0x28, 0, 0, 1 },
+    { 0x24, 0x6f, 0x28, 0, 0, 2 },
+};
+
+static esp_err_t get(httpd_req_t *r, const char *uri, const char *req_headers) {
+    host_httpd_req_init(r, NULL, NULL, body, sizeof(body));
+    r->req_headers = req_headers;
+    return host_httpd_call(r, HTTP_GET, uri);
+}
+
+static esp_err_t post(httpd_req_t *r, const char *uri, const char *content) {
+    host_httpd_req_init(r, NULL, NULL, body, sizeof(body));
+    r->content = content;
+    r->content_len = strlen(content);
+    return host_httpd_call(r, HTTP_POST, uri);
+}
+
+static int count(const char *s, const char *needle) {
+    int n = 0;
+    for (const char *p = s; (p = strstr(p, needle)) != NULL; p += strlen(needle)) n++;
+    return n;
+}
+
+static void trigger(peer_t *peer, long long timestamp_us) {
+    char data[48];
+    snprintf(data, sizeof(data), "%lld,0", timestamp_us);
+    addGateTime(peer, data);
+}
+
+static void test_static_assets(void) {
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/", NULL), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(strstr(body, "/assets/index.js?v=") != NULL);
+    CHECK(strcmp(r.content_type, "text/html") == 0);
+    CHECK(strcmp(host_httpd_resp_hdr(&r, "Cache-Control"), "no-cache") == 0);
+    char etag[16];
+    snprintf(etag, sizeof(etag), "%s", host_httpd_resp_hdr(&r, "ETag"));
+    CHECK(etag[0] == '"');
+
+    char hdrs[64];
+    snprintf(hdrs, sizeof(hdrs), "If-None-Match: W/%s\n", etag);
+    CHECK_EQ(get(&r, "/", hdrs), ESP_OK);
+    CHECK_EQ(r.status, 304);
+    CHECK_EQ(r.body_len, 0);
+
+    // The gzip copy has its own tag; the identity one does not match it.
+    CHECK_EQ(get(&r, "/assets/index.js?v=1", "Accept-Encoding: br, gzip\n"), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(strcmp(host_httpd_resp_hdr(&r, "Content-Encoding"), "gzip") == 0);
+    CHECK(strncmp(body, "gz:", 3) == 0);
+    CHECK(strstr(host_httpd_resp_hdr(&r, "Cache-Control"), "immutable") != NULL);
+    CHECK(strstr(host_httpd_resp_hdr(&r, "ETag"), "-gz") != NULL);
+    snprintf(hdrs, sizeof(hdrs), "Accept-Encoding: gzip;q=0\nIf-None-Match: %s\n", etag);
+    CHECK_EQ(get(&r, "/assets/index.css", hdrs), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(host_httpd_resp_hdr(&r, "Content-Encoding") == NULL);
+    CHECK(strcmp(body, "body{margin:0}") == 0);
+}
+
+static void test_telemetry(void) {
+    frame_gen_t g;
+    espnow_data_t f;
+    frame_gen_init(&g, car, 7);
+    frame_gen_telemetry(&g, &f);
+    telemetry_update(0, car, f.data, f.len, 0);
+
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/telemetry", NULL), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(strstr(body, segments[0].name) != NULL);
+    CHECK(strstr(body, "\"key\":\"test\"") == NULL);   // no placeholder keys from start()
+    char cursor[80];
+    snprintf(cursor, sizeof(cursor), "/telemetry?since=%s", host_httpd_resp_hdr(&r, "X-State-Version"));
+
+    CHECK_EQ(get(&r, cursor, NULL), ESP_OK);
+    CHECK_EQ(r.status, 304);
+    CHECK_EQ(r.body_len, 0);
+
+    // Only what changed after the cursor: the table, not the segments.
+    addString("driver", "ada");
+    CHECK_EQ(get(&r, cursor, NULL), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(strstr(body, "{\"key\":\"driver\",\"value\":\"ada\"}") != NULL);
+    CHECK(strstr(body, segments[0].name) == NULL);
+
+    // /telemetry/<key> through the wildcard; /telemetry/history is not caught by it.
+    // Segments as hex by default, decoded only when asked.
+    telemetry_snapshot_t snap;
+    telemetry_snapshot(0, &snap);
+    char want[TELEMETRY_VALUE_MAX], uri[64];
+    snprintf(uri, sizeof(uri), "/telemetry/%s", segments[0].name);
+    CHECK_EQ(get(&r, uri, NULL), ESP_OK);
+    CHECK(strcmp(r.content_type, "application/json") == 0);
+    CHECK(telemetry_format_segment(&snap, 0, want, sizeof(want)) >= 0);
+    CHECK(strcmp(body, want) == 0);
+    snprintf(uri, sizeof(uri), "/telemetry/%s?decoded=1", segments[0].name);
+    CHECK_EQ(get(&r, uri, NULL), ESP_OK);
+    CHECK(telemetry_format_decoded(&snap, 0, want, sizeof(want)) >= 0);
+    CHECK(strcmp(body, want) == 0);
+    CHECK_EQ(get(&r, "/telemetry/driver?src=0", NULL), ESP_OK);
+    CHECK(strcmp(body, "ada") == 0);
+    CHECK_EQ(get(&r, "/telemetry/history", NULL), ESP_OK);
+    CHECK(body[0] == '[');
+
+    // History points come scaled, in the unit named alongside.
+    history_append(0, &snap);
+    int ch = history_find_channel("gyro_x");
+    const telemetry_field_t *gyro = history_channel_field(ch);
+    CHECK(ch >= 0 && gyro->decimals == 2);
+    CHECK_EQ(get(&r, "/telemetry/history?key=gyro_x&from=0&points=1", NULL), ESP_OK);
+    CHECK(strstr(body, "\"unit\":\"°/s\"") != NULL);
+    char *point = strstr(body, "\"points\":[[0,");
+    char scaled[24];
+    telemetry_format_field(gyro, telemetry_field_raw(gyro, snap.raw), scaled, sizeof(scaled));
+    snprintf(want, sizeof(want), "[[0,%s,%s,%s]]", scaled, scaled, scaled);
+    CHECK(point != NULL && strstr(point, want) != NULL);
+    CHECK_EQ(get(&r, "/telemetry?src=5", NULL), ESP_OK);
+    CHECK_EQ(r.status, 404);
+}
+
+// More rows than render_buf holds: the one cut short is rolled back.
+static void test_telemetry_overflow(void) {
+    char key[16], value[64];
+    memset(value, 'x', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    for (int i = 0; i < 2 * SERVER_RENDER_BUF_SIZE / (int)sizeof(value); i++) {
+        snprintf(key, sizeof(key), "k%02d", i);
+        addString(key, value);
+    }
+
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/telemetry", NULL), ESP_OK);
+    CHECK(r.body_len > SERVER_RENDER_BUF_SIZE / 2 && r.body_len < SERVER_RENDER_BUF_SIZE);
+    CHECK(body[0] == '[' && body[r.body_len - 1] == ']');
+    CHECK(strstr(body, "},]") == NULL);
+    CHECK_EQ(count(body, "{"), count(body, "}"));
+    CHECK_EQ(count(body, "\"key\""), count(body, "\"value\""));
+}
+
+static void test_timing(peer_t *gate) {
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/timing", NULL), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    char cursor[64];
+    snprintf(cursor, sizeof(cursor), "/timing?since=%s", host_httpd_resp_hdr(&r, "X-State-Version"));
+    CHECK_EQ(get(&r, cursor, NULL), ESP_OK);
+    CHECK_EQ(r.status, 304);
+
+    trigger(gate, 1000);
+    CHECK_EQ(get(&r, cursor, NULL), ESP_OK);
+    CHECK_EQ(r.status, 200);
+    CHECK(strstr(body, gate->mac_str) != NULL);
+    CHECK(strstr(body, "\"timestamp_us\":1000") != NULL);
+}
+
+// Rows from both gates, long enough that they take several render_buf
+// batches.
+static void test_export_csv(peer_t *gates[2]) {
+    int depth = (int)peers_history_depth();
+    for (int i = 0; i < depth + 10; i++) {
+        for (int k = 0; k < 2; k++) trigger(gates[k], 1000000000000ll + i * 1000);
+    }
+
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/timing/export.csv", NULL), ESP_OK);
+    CHECK(r.finished);
+    CHECK(strcmp(r.content_type, "text/csv") == 0);
+    CHECK(strncmp(body, "mac,trigger_index,timestamp_us,diff_us\r\n", 40) == 0);
+    CHECK_EQ(count(body, "\r\n"), 2 * depth + 1);
+    CHECK(r.body_len > SERVER_RENDER_BUF_SIZE);
+    CHECK(r.send_calls >= 3);   // the header, then render_buf-sized batches
+    char last[64];
+    snprintf(last, sizeof(last), "%s,%d,%lld,0\r\n", gates[1]->mac_str, depth + 9,
+             1000000000000ll + (depth + 9) * 1000);
+    CHECK(strstr(body, last) != NULL);
+}
+
+static void test_depth(void) {
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/timing/depth", NULL), ESP_OK);
+    CHECK(strstr(body, "\"depth\":") != NULL);
+    CHECK(r.finished);
+
+    CHECK_EQ(post(&r, "/timing/depth", "100"), ESP_OK);
+    CHECK(strstr(body, "\"configured\":100") != NULL);
+    CHECK_EQ(peers_history_depth_configured(), 100);
+
+    CHECK_EQ(post(&r, "/timing/depth", "lots"), ESP_OK);
+    CHECK_EQ(r.status, 400);
+}
+
+static void test_metrics(void) {
+    httpd_req_t r;
+    CHECK_EQ(get(&r, "/metrics", NULL), ESP_OK);
+    CHECK(r.finished);
+    CHECK(strstr(body, "espnow_rx_stale_total") != NULL);
+    CHECK(strstr(body, "heap_free_bytes") != NULL);
+    CHECK(strstr(body, "http_handler_duration_us_count{uri=\"/metrics\",method=\"GET\"}") != NULL);
+}
+
+static void test_laps(peer_t *gates[2]) {
+    httpd_req_t r;
+    char config[128];
+    for (int i = 0; i < 2; i++) {
+        snprintf(config, sizeof(config), "{\"mac\":\"%s\",\"mode\":\"series\",\"group\":\"A\",\"order\":%d}",
+                 gates[i]->mac_str, i);
+        CHECK_EQ(post(&r, "/gate-config", config), ESP_OK);
+        CHECK(strcmp(body, "OK") == 0);
+    }
+
+    trigger(gates[0], 10000000);
+    trigger(gates[1], 12500000);
+    CHECK_EQ(get(&r, "/laps", NULL), ESP_OK);
+    CHECK(strstr(body, "\"group\":\"A\"") != NULL);
+    CHECK(strstr(body, "\"laps\":1") != NULL);
+    CHECK(strstr(body, "\"last_us\":2500000") != NULL);
+}
+
+static void test_wait(peer_t *gate) {
+    static httpd_req_t r[GATE_WAIT_MAX_CLIENTS + 1];
+    static char bodies[GATE_WAIT_MAX_CLIENTS + 1][2048];
+    char uri[64];
+
+    // Events newer than the cursor already: answered from the handler.
+    host_httpd_req_init(&r[0], NULL, NULL, bodies[0], sizeof(bodies[0]));
+    CHECK_EQ(host_httpd_call(&r[0], HTTP_GET, "/timing/wait?since=0"), ESP_OK);
+    CHECK(!r[0].detached && r[0].finished);
+    CHECK_EQ(r[0].status, 200);
+    CHECK(strstr(bodies[0], gate->mac_str) != NULL);
+
+    // Nothing newer: the request waits until a trigger arrives.
+    uint32_t since = state_version_current();
+    snprintf(uri, sizeof(uri), "/timing/wait?since=%lu", (unsigned long)since);
+    host_httpd_req_init(&r[0], NULL, NULL, bodies[0], sizeof(bodies[0]));
+    CHECK_EQ(host_httpd_call(&r[0], HTTP_GET, uri), ESP_OK);
+    CHECK(r[0].detached && !r[0].finished);
+    trigger(gate, 99000000);
+    CHECK(host_httpd_wait(&r[0], NULL, 2000));
+    CHECK_EQ(r[0].status, 200);
+    CHECK(strstr(bodies[0], "\"timestamp_us\":99000000") != NULL);
+    CHECK(count(bodies[0], "\"mac\"") == 1);
+
+    // Every slot taken: the next one is turned away; the waiters time out.
+    since = state_version_current();
+    snprintf(uri, sizeof(uri), "/timing/wait?since=%lu&timeout_ms=1000", (unsigned long)since);
+    for (int i = 0; i <= GATE_WAIT_MAX_CLIENTS; i++) {
+        host_httpd_req_init(&r[i], NULL, NULL, bodies[i], sizeof(bodies[i]));
+        CHECK_EQ(host_httpd_call(&r[i], HTTP_GET, uri), ESP_OK);
+    }
+    CHECK_EQ(r[GATE_WAIT_MAX_CLIENTS].status, 503);
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < GATE_WAIT_MAX_CLIENTS; i++) {
+        CHECK(host_httpd_wait(&r[i], NULL, 3000));
+        CHECK_EQ(r[i].status, 204);
+    }
+    CHECK(host_now_ns() - t0 > 500000000ull);
+}
+
+static void test_stream(peer_t *gate) {
+    static httpd_req_t r[STREAM_MAX_CLIENTS + 1];
+    static char bodies[STREAM_MAX_CLIENTS + 1][8192];
+
+    for (int i = 0; i <= STREAM_MAX_CLIENTS; i++) {
+        host_httpd_req_init(&r[i], NULL, NULL, bodies[i], sizeof(bodies[i]));
+        CHECK_EQ(host_httpd_call(&r[i], HTTP_GET, "/stream"), ESP_OK);
+    }
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        CHECK(r[i].detached);
+        CHECK(strcmp(r[i].content_type, "text/event-stream") == 0);
+        CHECK(host_httpd_wait(&r[i], "event: telemetry\ndata: [", 2000));
+        CHECK(host_httpd_wait(&r[i], "event: timing\ndata: [", 2000));
+    }
+    CHECK_EQ(r[STREAM_MAX_CLIENTS].status, 503);
+
+    // A trigger reaches every client; one that went away frees its slot.
+    host_httpd_close(&r[0]);
+    trigger(gate, 123000000);
+    for (int i = 1; i < STREAM_MAX_CLIENTS; i++) CHECK(host_httpd_wait(&r[i], "123000000", 2000));
+    CHECK(host_httpd_wait(&r[0], NULL, 2000));
+
+    host_httpd_req_init(&r[0], NULL, NULL, bodies[0], sizeof(bodies[0]));
+    CHECK_EQ(host_httpd_call(&r[0], HTTP_GET, "/stream"), ESP_OK);
+    CHECK(r[0].detached);
+    CHECK(host_httpd_wait(&r[0], "123000000", 2000));
+}
+
+int main(void) {
+    char nvs_path[] = "/tmp/test_http_nvs_XXXXXX";
+    int fd = mkstemp(nvs_path);
+    CHECK(fd >= 0);
+    host_nvs_init(nvs_path);
+
+    packet_pool_init();
+    peers_init();
+    laps_init();
+    gate_store_init();
+    laps_reconfigure();
+    CHECK_EQ(telemetry_init(), ESP_OK);
+    CHECK_EQ(history_init(), ESP_OK);
+    CHECK(start() != NULL);
+
+    const httpd_config_t *config = host_httpd_config();
+    CHECK(config != NULL && config->uri_match_fn == httpd_uri_match_wildcard);
+    // Long-poll and stream sockets sit idle by design; LRU purge would close them.
+    CHECK(config != NULL && !config->lru_purge_enable);
+    CHECK(config != NULL && config->max_open_sockets == SERVER_MAX_OPEN_SOCKETS);
+
+    peer_t *gates[2] = { peer_get_or_add(gate_macs[0]), peer_get_or_add(gate_macs[1]) };
+    CHECK(gates[0] != NULL && gates[1] != NULL);
+    if (gates[0] == NULL || gates[1] == NULL) return host_test_result("test_http");
+
+    test_static_assets();
+    test_telemetry();
+    test_telemetry_overflow();
+    test_timing(gates[0]);
+    test_export_csv(gates);
+    test_depth();
+    test_metrics();
+    test_laps(gates);
+    test_wait(gates[0]);
+    test_stream(gates[0]);
+
+    unlink(nvs_path);
+    return host_test_result("test_http");
+}
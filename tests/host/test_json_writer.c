@@ -0,0 +1,122 @@
+// json_writer: escaping, commas, buffer-mode overflow and rollback, and
+// stream mode sending the same bytes in JSON_FLUSH_BYTES chunks.
+
+#include <string.h>
+#include "host_test.h"
+#include "json_writer.h"
+
+static char buf[4096];
+
+static const char *render_buffer(void (*fn)(json_writer_t *), size_t len, size_t reserve) {
+    json_writer_t w;
+    json_init_buffer(&w, buf, len, reserve);
+    fn(&w);
+    json_finish_buffer(&w);
+    return buf;
+}
+
+static void escapes(json_writer_t *w) {
+    json_begin_array(w);
+    json_string(w, "plain");
+    json_string(w, "quote \" backslash \\ slash /");
+    json_string(w, "nl\ncr\rtab\t");
+    json_string(w, "\x01\x1f\x7f");
+    json_string(w, "caf\xc3\xa9");
+    json_string(w, "");
+    json_end_array(w);
+}
+
+static void nesting(json_writer_t *w) {
+    json_begin_object(w);
+    json_key(w, "a");  json_int(w, -12);
+    json_key(w, "b");  json_uint(w, 18446744073709551615ull);
+    json_key(w, "c");
+    json_begin_array(w);
+    json_begin_object(w);
+    json_end_object(w);
+    json_begin_array(w);
+    json_end_array(w);
+    json_bool(w, true);
+    json_bool(w, false);
+    json_null(w);
+    json_end_array(w);
+    json_key(w, "d");  json_int(w, -9223372036854775807ll - 1);
+    json_key(w, "e");
+    json_begin_array(w);
+    json_fixed(w, -1234, 2);
+    json_fixed(w, 5, 3);
+    json_fixed(w, 42, 0);
+    json_end_array(w);
+    json_end_object(w);
+}
+
+// Rows until the buffer is full, dropping the one that did not fit.
+static int rows_written;
+
+static void rows(json_writer_t *w) {
+    json_begin_array(w);
+    rows_written = 0;
+    for (int i = 0; i < 1000; i++) {
+        json_mark_t m = json_mark(w);
+        json_begin_object(w);
+        json_key(w, "row"); json_int(w, i);
+        json_end_object(w);
+        if (w->overflow) {
+            json_rollback(w, m);
+            break;
+        }
+        rows_written++;
+    }
+    json_end_array(w);
+}
+
+static void big(json_writer_t *w) {
+    json_begin_array(w);
+    for (int i = 0; i < 400; i++) {
+        json_begin_object(w);
+        json_key(w, "mac");   json_string(w, "24:6F:28:AA:BB:CC");
+        json_key(w, "order"); json_int(w, i);
+        json_end_object(w);
+    }
+    json_end_array(w);
+}
+
+int main(void) {
+    CHECK(strcmp(render_buffer(escapes, sizeof(buf), 1),
+                 "[\"plain\",\"quote \\\" backslash \\\\ slash /\",\"nl\\ncr\\rtab\\t\","
+                 "\"\\u0001\\u001f\x7f\",\"caf\xc3\xa9\",\"\"]") == 0);
+    CHECK(strcmp(render_buffer(nesting, sizeof(buf), 1),
+                 "{\"a\":-12,\"b\":18446744073709551615,\"c\":[{},[],true,false,null],"
+                 "\"d\":-9223372036854775808,\"e\":[-12.34,0.005,42]}") == 0);
+
+    // 64 bytes: 62 for elements, one reserved for the bracket, one for the NUL.
+    const char *out = render_buffer(rows, 64, 1);
+    CHECK_EQ(rows_written, 6);
+    CHECK(strcmp(out, "[{\"row\":0},{\"row\":1},{\"row\":2},{\"row\":3},{\"row\":4},{\"row\":5}]") == 0);
+    out = render_buffer(rows, 12, 1);
+    CHECK_EQ(rows_written, 1);
+    CHECK(strcmp(out, "[{\"row\":0}]") == 0);
+    out = render_buffer(rows, 8, 1);
+    CHECK_EQ(rows_written, 0);
+    CHECK(strcmp(out, "[]") == 0);
+
+    // Stream mode: same bytes as buffer mode, in full-size chunks.
+    static char expect[16384], body[16384];
+    json_writer_t w;
+    json_init_buffer(&w, expect, sizeof(expect), 1);
+    big(&w);
+    size_t len = json_finish_buffer(&w);
+    CHECK(!w.overflow);
+    CHECK(len > 3 * JSON_FLUSH_BYTES);
+
+    httpd_req_t req;
+    host_httpd_req_init(&req, "/", NULL, body, sizeof(body));
+    json_init_stream(&w, &req, buf, sizeof(buf));
+    big(&w);
+    CHECK_EQ(json_finish_stream(&w), ESP_OK);
+    CHECK_EQ(req.body_len, len);
+    CHECK(strcmp(body, expect) == 0);
+    CHECK_EQ(req.send_calls, (len + JSON_FLUSH_BYTES - 1) / JSON_FLUSH_BYTES);
+
+    return host_test_result("test_json_writer");
+}
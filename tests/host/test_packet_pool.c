@@ -0,0 +1,177 @@
+// packet_pool: exhaustion and unget, an SPSC stress run with a producer
+// and a consumer thread, and a paced 5 kHz run with a stalling consumer
+// that reports drops and heap calls on the receive path.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_count.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "host_test.h"
+#include "packet_pool.h"
+
+#define STRESS_FRAMES 1000000
+#define PACED_HZ 5000
+#define PACED_FRAMES 2500          // half a second
+#define STALL_EVERY 500            // consumer sleeps STALL_MS every this many frames
+#define STALL_MS 10
+
+static QueueHandle_t queue;
+static atomic_bool in_flight[PACKET_POOL_SIZE];
+static atomic_int overlaps;
+static bool paced;
+static unsigned long producer_drops;
+
+static espnow_data_t *slot_base;
+
+static int slot_of(const espnow_data_t *p) {
+    return (int)(p - slot_base);
+}
+
+static void stamp(espnow_data_t *p, uint32_t n) {
+    p->seq_num = (uint16_t)n;
+    p->len = (uint8_t)n;
+    memcpy(p->data, &n, sizeof(n));
+    memset(p->data + sizeof(n), (uint8_t)n, 16);
+}
+
+static bool stamp_ok(const espnow_data_t *p, uint32_t n) {
+    uint32_t got;
+    memcpy(&got, p->data, sizeof(got));
+    if (got != n || p->seq_num != (uint16_t)n || p->len != (uint8_t)n) return false;
+    for (int i = 0; i < 16; i++) {
+        if (p->data[sizeof(n) + i] != (uint8_t)n) return false;
+    }
+    return true;
+}
+
+// The receive callback: never waits for a slot.
+static void *producer(void *arg) {
+    uint32_t frames = paced ? PACED_FRAMES : STRESS_FRAMES;
+    uint64_t period_ns = 1000000000ull / PACED_HZ;
+    uint64_t next = host_now_ns();
+
+    for (uint32_t n = 0; n < frames;) {
+        if (paced) {
+            next += period_ns;
+            while (host_now_ns() < next) {}
+        }
+        espnow_data_t *p = packet_pool_take();
+        if (p == NULL) {
+            producer_drops++;
+            if (paced) n++;       // a real frame is lost; the stress run retries
+            else sched_yield();
+            continue;
+        }
+        if (atomic_exchange(&in_flight[slot_of(p)], true)) atomic_fetch_add(&overlaps, 1);
+        stamp(p, n);
+        xQueueSend(queue, &p, portMAX_DELAY);
+        n++;
+    }
+    espnow_data_t *done = NULL;
+    xQueueSend(queue, &done, portMAX_DELAY);
+    return NULL;
+}
+
+// espnow_task: checks each frame arrives intact and in order.
+static uint32_t consume(void) {
+    uint32_t received = 0;
+    uint32_t last = 0;
+    bool first = true;
+    int corrupt = 0, reordered = 0;
+    for (;;) {
+        espnow_data_t *p;
+        xQueueReceive(queue, &p, portMAX_DELAY);
+        if (p == NULL) break;
+
+        uint32_t n;
+        memcpy(&n, p->data, sizeof(n));
+        if (!stamp_ok(p, n)) corrupt++;
+        if (!first && n <= last) reordered++;
+        first = false;
+        last = n;
+        received++;
+
+        atomic_store(&in_flight[slot_of(p)], false);
+        packet_pool_give(p);
+        if (paced && received % STALL_EVERY == 0) vTaskDelay(STALL_MS);
+    }
+    CHECK_EQ(corrupt, 0);
+    CHECK_EQ(reordered, 0);
+    return received;
+}
+
+static void run(bool is_paced, const char *name) {
+    paced = is_paced;
+    producer_drops = 0;
+    packet_pool_init();
+    packet_pool_stats_t before, after;
+    packet_pool_get_stats(&before);
+
+    unsigned long allocs = host_allocs();
+    uint64_t t0 = host_now_ns();
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, NULL);
+    uint32_t received = consume();
+    pthread_join(thread, NULL);
+    uint64_t elapsed_ns = host_now_ns() - t0;
+    allocs = host_allocs() - allocs;
+
+    packet_pool_get_stats(&after);
+    uint32_t taken = after.taken - before.taken;
+    uint32_t returned = after.returned - before.returned;
+    uint32_t exhausted = after.exhausted - before.exhausted;
+
+    printf("%s: %u frames in %.2f s (%.0f/s), pool empty %u times, %lu heap calls\n",
+           name, received, elapsed_ns / 1e9, received / (elapsed_ns / 1e9), exhausted, allocs);
+    CHECK_EQ(taken, received);
+    CHECK_EQ(returned, received);
+    CHECK_EQ(exhausted, producer_drops);
+    CHECK_EQ(atomic_load(&overlaps), 0);
+    CHECK_EQ(allocs, 0);
+    if (paced) {
+        CHECK_EQ(received + producer_drops, PACED_FRAMES);
+        // Each stall backs up ~STALL_MS * PACED_HZ / 1000 frames, more than the pool holds.
+        CHECK(producer_drops > 0);
+    } else {
+        CHECK_EQ(received, STRESS_FRAMES);
+    }
+}
+
+int main(void) {
+    CHECK(host_alloc_count_live());
+
+    // Slot addresses: the pool hands out its array in index order after init.
+    packet_pool_init();
+    espnow_data_t *all[PACKET_POOL_SIZE];
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        all[i] = packet_pool_take();
+        CHECK(all[i] != NULL);
+    }
+    slot_base = all[0];
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) CHECK(slot_of(all[i]) == i);
+
+    packet_pool_stats_t st;
+    packet_pool_get_stats(&st);
+    CHECK(packet_pool_take() == NULL);
+    packet_pool_stats_t st2;
+    packet_pool_get_stats(&st2);
+    CHECK_EQ(st2.exhausted - st.exhausted, 1);
+
+    packet_pool_give(all[5]);
+    CHECK(packet_pool_take() == all[5]);
+    // A slot the callback could not queue comes back on its next take.
+    packet_pool_unget(all[5]);
+    CHECK(packet_pool_take() == all[5]);
+
+    queue = xQueueCreate(2 * PACKET_POOL_SIZE, sizeof(espnow_data_t *));
+    run(false, "stress");
+    run(true, "paced");
+
+    return host_test_result("test_packet_pool");
+}
@@ -0,0 +1,242 @@
+// peer_seq_check: in-order runs across the 65535 -> 0 wrap, gaps filled
+// late, duplicates, the window edges, sender restarts after an idle gap
+// (including one inside the old window) and without one, frames from
+// before a restart arriving late, lone stale frames, and the loss rates.
+
+#include <string.h>
+#include "host_test.h"
+#include "peers.h"
+
+static peer_seq_t s;
+static uint32_t now_ms;
+
+// One frame 10 ms after the previous.
+static peer_seq_result_t check(uint16_t seq) {
+    now_ms += 10;
+    return peer_seq_check(&s, seq, now_ms);
+}
+
+static void idle(void) {
+    now_ms += PEER_SEQ_IDLE_MS;
+}
+
+static void reset(uint16_t first) {
+    memset(&s, 0, sizeof(s));
+    CHECK_EQ(check(first), PEER_SEQ_RESTART);
+    CHECK_EQ(s.restarts, 0);
+}
+
+// from..to inclusive, wrapping, every frame new.
+static void run(uint16_t from, uint16_t to) {
+    for (uint16_t q = from;; q++) {
+        CHECK_EQ(check(q), PEER_SEQ_NEW);
+        if (q == to) break;
+    }
+}
+
+static void test_wrap(void) {
+    reset(65500);
+    run(65501, 65535);
+    run(0, 40);
+    CHECK_EQ(s.highest, 40);
+    CHECK_EQ(s.accepted, 77);
+    CHECK_EQ(s.lost, 0);
+    CHECK_EQ(s.restarts, 0);
+
+    // A gap straddling the wrap, then filled from both sides of it.
+    reset(65533);
+    CHECK_EQ(check(2), PEER_SEQ_NEW);
+    CHECK_EQ(s.lost, 4);              // 65534, 65535, 0, 1
+    CHECK_EQ(check(65535), PEER_SEQ_LATE);
+    CHECK_EQ(check(0), PEER_SEQ_LATE);
+    CHECK_EQ(s.lost, 2);
+    CHECK_EQ(s.reordered, 2);
+    CHECK_EQ(check(0), PEER_SEQ_DUPLICATE);
+}
+
+static void test_duplicates_and_reorder(void) {
+    reset(100);
+    run(101, 110);
+    CHECK_EQ(check(110), PEER_SEQ_DUPLICATE);   // the highest itself
+    CHECK_EQ(check(105), PEER_SEQ_DUPLICATE);
+    CHECK_EQ(s.duplicates, 2);
+
+    CHECK_EQ(check(115), PEER_SEQ_NEW);
+    CHECK_EQ(s.lost, 4);
+    CHECK_EQ(check(113), PEER_SEQ_LATE);
+    CHECK_EQ(check(113), PEER_SEQ_DUPLICATE);
+    CHECK_EQ(check(111), PEER_SEQ_LATE);
+    CHECK_EQ(s.lost, 2);
+    CHECK_EQ(s.reordered, 2);
+    CHECK_EQ(s.accepted, 14);
+    CHECK_EQ(s.duplicates, 3);
+}
+
+static void test_window_edges(void) {
+    reset(1000);
+    run(1001, 1100);
+    CHECK_EQ(s.tracked, PEER_SEQ_WINDOW);
+
+    // One short of the window: still tracked, and a duplicate of it is one.
+    CHECK_EQ(check(1100 - (PEER_SEQ_WINDOW - 1)), PEER_SEQ_DUPLICATE);
+    // At the window: stale.
+    CHECK_EQ(check(1100 - PEER_SEQ_WINDOW), PEER_SEQ_STALE);
+    CHECK_EQ(s.highest, 1100);
+    // Far below it, a frame following on from a stale one makes it a restart.
+    CHECK_EQ(check(10), PEER_SEQ_STALE);
+    CHECK_EQ(check(11), PEER_SEQ_RESTART);
+    CHECK_EQ(s.restarts, 1);
+    CHECK_EQ(s.highest, 11);
+
+    // Forward: MAX_JUMP - 1 ahead is a gap, MAX_JUMP ahead stale, then a
+    // restart once the next frame follows it.
+    reset(0);
+    CHECK_EQ(check(PEER_SEQ_MAX_JUMP - 1), PEER_SEQ_NEW);
+    CHECK_EQ(s.lost, PEER_SEQ_MAX_JUMP - 2);
+    uint32_t lost = s.lost;
+    CHECK_EQ(check(2 * PEER_SEQ_MAX_JUMP - 1), PEER_SEQ_STALE);
+    CHECK_EQ(check(2 * PEER_SEQ_MAX_JUMP + 1), PEER_SEQ_RESTART);
+    CHECK_EQ(s.lost, lost);           // a restart is not loss
+    CHECK_EQ(s.restarts, 1);
+
+    // After an idle gap the same jump is a restart straight away.
+    reset(0);
+    idle();
+    CHECK_EQ(check(PEER_SEQ_MAX_JUMP), PEER_SEQ_RESTART);
+    CHECK_EQ(s.lost, 0);
+
+    // A gap wider than the window: the oldest missing numbers can no
+    // longer be filled, the newest still can.
+    reset(0);
+    CHECK_EQ(check(200), PEER_SEQ_NEW);
+    CHECK_EQ(s.lost, 199);
+    CHECK_EQ(check(199), PEER_SEQ_LATE);
+    CHECK_EQ(s.lost, 198);
+    CHECK_EQ(check(100), PEER_SEQ_STALE);
+    CHECK_EQ(s.stale, 1);
+}
+
+// The sender rebooted and counts from 0 again while a few of its older
+// frames are still in flight.
+static void test_restart_late_frames(void) {
+    reset(5000);
+    run(5001, 5040);
+    idle();
+    CHECK_EQ(check(3), PEER_SEQ_RESTART);
+    CHECK_EQ(s.tracked, 0);
+    uint32_t lost = s.lost, reordered = s.reordered;
+
+    // 0..2 were sent before we saw 3, but after the restart: never counted
+    // as lost, so not reordered either.
+    CHECK_EQ(check(2), PEER_SEQ_LATE);
+    CHECK_EQ(check(0), PEER_SEQ_LATE);
+    CHECK_EQ(s.reordered, reordered);
+    CHECK_EQ(s.lost, lost);
+    CHECK_EQ(check(2), PEER_SEQ_DUPLICATE);
+
+    // Numbers after the restart point are tracked again as usual.
+    CHECK_EQ(check(6), PEER_SEQ_NEW);
+    CHECK_EQ(s.tracked, 3);
+    CHECK_EQ(s.lost, lost + 2);
+    CHECK_EQ(check(4), PEER_SEQ_LATE);
+    CHECK_EQ(s.reordered, reordered + 1);
+    CHECK_EQ(s.lost, lost + 1);
+    // 1 is below the restart point: applied, not counted.
+    CHECK_EQ(check(1), PEER_SEQ_LATE);
+    CHECK_EQ(s.reordered, reordered + 1);
+    CHECK_EQ(s.lost, lost + 1);
+
+    // An in-flight frame from the old run does not re-anchor the tracker.
+    CHECK_EQ(check(5041), PEER_SEQ_STALE);
+    CHECK_EQ(s.highest, 6);
+    CHECK_EQ(check(7), PEER_SEQ_NEW);
+    CHECK_EQ(s.restarts, 1);
+    CHECK_EQ(s.lost, lost + 1);
+}
+
+// A gate power-cycled after fewer triggers than the window counts from 0
+// again, inside the old window: every trigger after the reboot is applied.
+static void test_reboot_inside_window(void) {
+    reset(0);
+    run(1, 19);
+    idle();
+    CHECK_EQ(check(0), PEER_SEQ_RESTART);
+    run(1, 19);
+    CHECK_EQ(s.duplicates, 0);
+    CHECK_EQ(s.restarts, 1);
+    CHECK_EQ(s.accepted, 40);
+    CHECK_EQ(s.lost, 0);
+
+    // After a single trigger the first number after the reboot is the
+    // highest itself.
+    reset(0);
+    idle();
+    CHECK_EQ(check(0), PEER_SEQ_RESTART);
+    CHECK_EQ(check(1), PEER_SEQ_NEW);
+
+    // A retransmit shortly after the original is still a duplicate, and an
+    // idle gap followed by a forward number is ordinary loss.
+    reset(0);
+    run(1, 5);
+    CHECK_EQ(check(5), PEER_SEQ_DUPLICATE);
+    idle();
+    CHECK_EQ(check(8), PEER_SEQ_NEW);
+    CHECK_EQ(s.lost, 2);
+    CHECK_EQ(s.restarts, 0);
+}
+
+// One very late frame far below the window is dropped as stale; the run
+// carries on with no loss or restart counted.
+static void test_one_very_late_frame(void) {
+    reset(1000);
+    run(1001, 1100);
+    CHECK_EQ(check(900), PEER_SEQ_STALE);
+    CHECK(peer_seq_drop(PEER_SEQ_STALE));
+    run(1101, 1110);
+    CHECK_EQ(s.highest, 1110);
+    CHECK_EQ(s.lost, 0);
+    CHECK_EQ(s.restarts, 0);
+    CHECK_EQ(s.stale, 1);
+
+    // Stale frames that do not follow on from each other never restart.
+    CHECK_EQ(check(500), PEER_SEQ_STALE);
+    CHECK_EQ(check(800), PEER_SEQ_STALE);
+    CHECK_EQ(check(499), PEER_SEQ_STALE);
+    // Nor does a stale frame followed by one from the current run.
+    CHECK_EQ(check(600), PEER_SEQ_STALE);
+    CHECK_EQ(check(1111), PEER_SEQ_NEW);
+    CHECK_EQ(check(601), PEER_SEQ_STALE);
+    CHECK_EQ(s.restarts, 0);
+    CHECK_EQ(s.lost, 0);
+    CHECK_EQ(s.stale, 6);
+}
+
+static void test_loss_rates(void) {
+    reset(0);
+    CHECK_EQ(peer_seq_loss_permille(&s), 0);
+
+    // Every tenth number dropped over many windows.
+    for (uint16_t q = 1; q < 20 * PEER_RX_WINDOW; q++) {
+        if (q % 10 == 0) continue;
+        CHECK(check(q) == PEER_SEQ_NEW);
+    }
+    CHECK(peer_seq_loss_permille(&s) >= 99 && peer_seq_loss_permille(&s) <= 100);
+    CHECK(s.recent_loss_permille >= 95 && s.recent_loss_permille <= 105);
+
+    // A clean stretch brings the recent rate to zero; the total stays.
+    uint16_t q = s.highest;
+    for (int i = 0; i < 2 * PEER_RX_WINDOW; i++) CHECK(check(++q) == PEER_SEQ_NEW);
+    CHECK_EQ(s.recent_loss_permille, 0);
+    CHECK(peer_seq_loss_permille(&s) > 80);
+}
+
+int main(void) {
+    test_wrap();
+    test_duplicates_and_reorder();
+    test_window_edges();
+    test_restart_late_frames();
+    test_reboot_inside_window();
+    test_one_very_late_frame();
+    test_loss_rates();
+    return host_test_result("test_peer_seq");
+}
@@ -0,0 +1,60 @@
+// Frame check against frames built the way the senders build them.
+
+#include <string.h>
+#include "esp_crc.h"
+#include "frame_gen.h"
+#include "host_test.h"
+#include "protocol.h"
+
+int main(void) {
+    static const uint8_t mac[6] = { 1, 2, 3, 4, 5, 6 };
+    frame_gen_t g;
+    frame_gen_init(&g, mac, 7);
+    espnow_data_t f;
+
+    size_t len = frame_gen_telemetry(&g, &f);
+    CHECK_EQ(espnow_frame_check(&f, len), ESPNOW_FRAME_OK);
+    // Trailing bytes past len are allowed; the CRC only covers header + len.
+    CHECK_EQ(espnow_frame_check(&f, sizeof(f)), ESPNOW_FRAME_OK);
+    CHECK_EQ(espnow_frame_check(&f, len - 1), ESPNOW_FRAME_BAD_LEN);
+    CHECK_EQ(espnow_frame_check(&f, ESPNOW_HEADER_LEN - 1), ESPNOW_FRAME_SHORT);
+
+    len = frame_gen_gate_request(&g, &f, 123456789, 4200);
+    CHECK_EQ(espnow_frame_check(&f, len), ESPNOW_FRAME_OK);
+    CHECK(memcmp(f.data, "123456789,4200", f.len) == 0);
+
+    len = frame_gen_ping(&g, &f);
+    CHECK_EQ(len, ESPNOW_HEADER_LEN);
+    CHECK_EQ(espnow_frame_check(&f, len), ESPNOW_FRAME_OK);
+
+    // Legacy senders CRC all of espnow_data_t whatever len says.
+    frame_gen_gate_request(&g, &f, 1, 2);
+    f.crc = espnow_frame_crc(&f, sizeof(f));
+    CHECK_EQ(espnow_frame_check(&f, sizeof(f)), ESPNOW_FRAME_OK_LEGACY);
+
+    // Every single-bit error in the covered bytes is caught.
+    len = frame_gen_telemetry(&g, &f);
+    int missed = 0;
+    for (size_t bit = 0; bit < len * 8; bit++) {
+        espnow_data_t c = f;
+        ((uint8_t *)&c)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        espnow_frame_status_t st = espnow_frame_check(&c, len);
+        if (st == ESPNOW_FRAME_OK || st == ESPNOW_FRAME_OK_LEGACY) missed++;
+    }
+    CHECK_EQ(missed, 0);
+
+    // The table matches the bitwise CRC (esp_crc16_le's), whole and chained.
+    uint8_t buf[512];
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)frame_gen_rand(&g);
+    int mismatched = 0;
+    for (size_t n = 0; n <= sizeof(buf); n += 7) {
+        uint16_t seed = (uint16_t)frame_gen_rand(&g);
+        uint16_t want = esp_crc16_le(seed, buf, n);
+        if (protocol_crc16_le(seed, buf, n) != want) mismatched++;
+        if (protocol_crc16_le(protocol_crc16_le(seed, buf, n / 3), buf + n / 3, n - n / 3) != want) mismatched++;
+    }
+    CHECK_EQ(mismatched, 0);
+    CHECK_EQ(protocol_crc16_le(UINT16_MAX, NULL, 0), UINT16_MAX);
+
+    return host_test_result("test_protocol");
+}
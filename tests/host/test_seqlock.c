@@ -0,0 +1,146 @@
+// Torn-read stress for seqlock.h: one writer thread rewrites a block
+// continuously while reader threads copy it and check every copy is from a
+// single write. Run twice, on a bare seqlock-protected block and through
+// telemetry_update / telemetry_snapshot.
+//
+//   test_seqlock [SECONDS]
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "seqlock.h"
+#include "state_version.h"
+#include "telemetry.h"
+
+#define READERS 3
+#define BLOCK_WORDS 64
+
+atomic_uint state_version;
+
+static atomic_bool stop;
+static double seconds = 0.5;
+
+typedef struct {
+    uint64_t reads;
+    uint64_t retries;
+    uint64_t torn;
+} reader_stats_t;
+
+// --- bare seqlock ----------------------------------------------------------
+
+static seqlock_t block_lock;
+static uint32_t block[BLOCK_WORDS];
+
+// The yields inside and between writes, and halfway through each reader
+// copy, make the threads interleave even on a single core.
+static void *block_writer(void *arg) {
+    for (uint32_t gen = 1; !atomic_load_explicit(&stop, memory_order_relaxed); gen++) {
+        seqlock_write_begin(&block_lock);
+        for (int i = 0; i < BLOCK_WORDS; i++) {
+            block[i] = gen;
+            if (i == BLOCK_WORDS / 2 && gen % 64 == 0) sched_yield();
+        }
+        seqlock_write_end(&block_lock);
+        if (gen % 8 == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void *block_reader(void *arg) {
+    reader_stats_t *st = arg;
+    uint32_t copy[BLOCK_WORDS];
+    const size_t half = sizeof(copy) / 2;
+    unsigned attempts = 0;
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        unsigned seq;
+        do {
+            seq = seqlock_read_begin(&block_lock);
+            memcpy(copy, block, half);
+            if (++attempts % 16 == 0) sched_yield();
+            memcpy((char *)copy + half, (const char *)block + half, half);
+            st->retries++;
+        } while (seqlock_read_retry(&block_lock, seq));
+        st->retries--;
+        st->reads++;
+        for (int i = 1; i < BLOCK_WORDS; i++) {
+            if (copy[i] != copy[0]) {
+                st->torn++;
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+// --- telemetry -------------------------------------------------------------
+
+static const uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0, 0, 1 };
+
+// Every payload byte and rx_ms carry the same generation, so a snapshot
+// mixing two frames shows up as a mismatch.
+static void *telemetry_writer(void *arg) {
+    uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    size_t len = telemetry_frame_len();
+    for (uint32_t gen = 1; !atomic_load_explicit(&stop, memory_order_relaxed); gen++) {
+        memset(payload, (uint8_t)gen, len);
+        telemetry_update(0, mac, payload, len, gen & 0xff);
+    }
+    return NULL;
+}
+
+static void *telemetry_reader(void *arg) {
+    reader_stats_t *st = arg;
+    size_t len = telemetry_frame_len();
+    telemetry_snapshot_t snap;
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        telemetry_snapshot(0, &snap);
+        st->reads++;
+        if (snap.valid == 0) continue;
+        bool torn = snap.rx_ms != snap.raw[0];
+        for (size_t i = 1; i < len && !torn; i++) torn = snap.raw[i] != snap.raw[0];
+        if (torn) st->torn++;
+    }
+    return NULL;
+}
+
+static void run(const char *name, void *(*writer)(void *), void *(*reader)(void *)) {
+    pthread_t w, r[READERS];
+    reader_stats_t st[READERS];
+    memset(st, 0, sizeof(st));
+    atomic_store(&stop, false);
+
+    pthread_create(&w, NULL, writer, NULL);
+    for (int i = 0; i < READERS; i++) pthread_create(&r[i], NULL, reader, &st[i]);
+    struct timespec ts = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&ts, NULL);
+    atomic_store(&stop, true);
+    pthread_join(w, NULL);
+
+    reader_stats_t total = { 0 };
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(r[i], NULL);
+        total.reads += st[i].reads;
+        total.retries += st[i].retries;
+        total.torn += st[i].torn;
+    }
+    printf("%s: %llu reads by %d readers, %llu retries, %llu torn\n", name,
+           (unsigned long long)total.reads, READERS,
+           (unsigned long long)total.retries, (unsigned long long)total.torn);
+    CHECK(total.reads > 0);
+    CHECK_EQ(total.torn, 0);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) seconds = atof(argv[1]);
+
+    run("seqlock", block_writer, block_reader);
+
+    CHECK_EQ(telemetry_init(), ESP_OK);
+    run("telemetry", telemetry_writer, telemetry_reader);
+
+    return host_test_result("test_seqlock");
+}
@@ -0,0 +1,110 @@
+// Replays telemetry_vectors' output through the dashboard's decoder
+// (frontend/src/lib/telemetry.ts) and fails on any field whose raw value
+// or text differs from the receiver's by so much as a byte.
+//
+//   node test_ts_decoder.mjs VECTORS.json
+//
+// telemetry.ts is loaded with the frontend's own TypeScript when it is
+// installed (npm ci in frontend/), else with Node's type stripping (22.6+).
+// Without either the test exits 77, which ctest reports as skipped.
+
+import { spawnSync } from "node:child_process";
+import { mkdtempSync, readFileSync, rmSync, writeFileSync } from "node:fs";
+import { createRequire } from "node:module";
+import { tmpdir } from "node:os";
+import { dirname, join } from "node:path";
+import { fileURLToPath, pathToFileURL } from "node:url";
+
+const SKIP = 77;
+const lib = join(dirname(fileURLToPath(import.meta.url)), "../../frontend/src/lib");
+
+function loadTypeScript() {
+  try {
+    return createRequire(join(lib, "../../package.json"))("typescript");
+  } catch {
+    return null;
+  }
+}
+
+// Loads the two modules from a temp copy, with the extensionless relative
+// import rewritten so Node's ESM loader can resolve it.
+async function load(ext, transform) {
+  const dir = mkdtempSync(join(tmpdir(), "ts_decoder-"));
+  try {
+    for (const name of ["telemetry_schema", "telemetry"]) {
+      const src = readFileSync(join(lib, `${name}.ts`), "utf8")
+        .replace(/from "\.\/telemetry_schema"/g, `from "./telemetry_schema${ext}"`);
+      writeFileSync(join(dir, name + ext), transform(src));
+    }
+    const url = name => pathToFileURL(join(dir, name + ext)).href;
+    return { ...await import(url("telemetry_schema")), ...await import(url("telemetry")) };
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+async function loadDecoder() {
+  const ts = loadTypeScript();
+  if (ts) {
+    return load(".mjs", src => ts.transpileModule(src, {
+      compilerOptions: { module: ts.ModuleKind.ESNext, target: ts.ScriptTarget.ES2022 },
+    }).outputText);
+  }
+  if (process.features.typescript) return load(".ts", src => src);
+
+  const [major, minor] = process.versions.node.split(".").map(Number);
+  if (major > 22 || (major === 22 && minor >= 6)) {
+    const r = spawnSync(process.execPath, ["--experimental-strip-types", "--no-warnings", ...process.argv.slice(1)],
+                        { stdio: "inherit" });
+    process.exit(r.status ?? 1);
+  }
+  console.log(`test_ts_decoder: skipped, no TypeScript (npm ci in frontend/) and node ${process.versions.node} < 22.6`);
+  process.exit(SKIP);
+}
+
+const vectorsPath = process.argv[2];
+if (!vectorsPath) {
+  console.error("usage: node test_ts_decoder.mjs VECTORS.json");
+  process.exit(2);
+}
+const vectors = JSON.parse(readFileSync(vectorsPath, "utf8"));
+const { TELEM_SEGMENTS, decode, fieldRaw, formatField } = await loadDecoder();
+const segmentByKey = new Map(TELEM_SEGMENTS.map(s => [s.key, s]));
+
+let failures = 0, checked = 0;
+function expect(what, got, want) {
+  checked++;
+  if (got === want) return;
+  if (failures++ < 20) console.error(`${what}: dashboard ${JSON.stringify(got)}, receiver ${JSON.stringify(want)}`);
+}
+
+// Whole segments: byte order, sign extension, offsets and decode()'s text.
+for (const v of vectors.segments) {
+  const seg = segmentByKey.get(v.key);
+  expect(`${v.key} in dashboard schema`, !!seg, true);
+  if (!seg) continue;
+  v.bytes.forEach((bytes, p) => {
+    const decoded = decode(v.key, bytes);
+    seg.fields.forEach((f, i) => {
+      const what = `${v.key}.${f.name} [${bytes.join(" ")}]`;
+      expect(`${what} raw`, fieldRaw(f, bytes), v.raw[p][i]);
+      const text = f.unit ? `${v.text[p][i]} ${f.unit}` : v.text[p][i];
+      expect(`${what} text`, decoded?.fields[i]?.value, text);
+    });
+  });
+}
+
+// Field sweeps: scaling and rounding at every step near zero.
+for (const v of vectors.fields) {
+  const f = segmentByKey.get(v.key)?.fields.find(f => f.name === v.field);
+  expect(`${v.key}.${v.field} in dashboard schema`, !!f, true);
+  if (!f) continue;
+  v.raw.forEach((raw, i) => expect(`${v.key}.${v.field} raw ${raw}`, formatField(f, raw), v.text[i]));
+}
+
+expect("segment count", TELEM_SEGMENTS.length, vectors.segments.length);
+if (failures) {
+  console.error(`test_ts_decoder: ${failures} of ${checked} check(s) failed`);
+  process.exit(1);
+}
+console.log(`test_ts_decoder: ok (${checked} checks)`);
@@ -0,0 +1,134 @@
+// tx against the mocked ESP-NOW: each message goes out as header + len
+// bytes with a valid CRC, the destination is registered once, sequence
+// numbers are shared across types (OK echoes the sender's instead), send
+// and add-peer errors reach the caller, and no builder touches the heap.
+
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_count.h"
+#include "esp_now.h"
+#include "host_test.h"
+#include "metrics.h"
+#include "protocol.h"
+#include "tx.h"
+
+static const uint8_t gate[6] = { 0x24, 0x6f, 0x28, 0, 0, 1 };
+static const uint8_t car[6] = { 0x24, 0x6f, 0x28, 0, 0, 2 };
+
+// The i-th captured frame, checked for destination, CRC and on-air length.
+static const espnow_data_t *sent(int i, const uint8_t *mac, espnow_msg_type_t type) {
+    static espnow_data_t f;
+    const host_espnow_sent_t *s = host_espnow_sent(i);
+    CHECK(s != NULL);
+    if (s == NULL) return memset(&f, 0, sizeof(f));
+    memset(&f, 0, sizeof(f));
+    memcpy(&f, s->data, s->len);
+    CHECK(memcmp(s->mac, mac, 6) == 0);
+    CHECK_EQ(f.type, type);
+    CHECK_EQ(s->len, espnow_frame_len(&f));
+    CHECK_EQ(espnow_frame_check(&f, s->len), ESPNOW_FRAME_OK);
+    return &f;
+}
+
+static void test_messages(void) {
+    host_espnow_reset();
+    CHECK_EQ(tx_ack(gate), ESP_OK);
+    CHECK_EQ(tx_ping(gate), ESP_OK);
+    CHECK_EQ(tx_ident(car), ESP_OK);
+    CHECK_EQ(tx_ok(gate, 4242), ESP_OK);
+    CHECK_EQ(tx_set_logger_name(car, "logger-7"), ESP_OK);
+    CHECK_EQ(host_espnow_sent_count(), 5);
+
+    // One registration per destination: channel 1, STA, unencrypted.
+    CHECK_EQ(host_espnow_peer_count(), 2);
+    for (int i = 0; i < host_espnow_peer_count(); i++) {
+        const esp_now_peer_info_t *p = host_espnow_peer(i);
+        CHECK_EQ(p->channel, 1);
+        CHECK_EQ(p->ifidx, ESP_IF_WIFI_STA);
+        CHECK(!p->encrypt);
+    }
+    CHECK(memcmp(host_espnow_peer(0)->peer_addr, gate, 6) == 0);
+    CHECK(memcmp(host_espnow_peer(1)->peer_addr, car, 6) == 0);
+
+    const espnow_data_t *f = sent(0, gate, ESPNOW_DATA_ACK);
+    CHECK_EQ(f->len, 0);
+    uint16_t seq = f->seq_num;
+    CHECK_EQ(sent(1, gate, ESPNOW_DATA_PING)->seq_num, (uint16_t)(seq + 1));
+    CHECK_EQ(sent(2, car, ESPNOW_GATE_IDENT)->seq_num, (uint16_t)(seq + 2));
+    f = sent(3, gate, ESPNOW_DATA_OK);
+    CHECK_EQ(f->seq_num, 4242);
+    CHECK_EQ(f->len, 0);
+    f = sent(4, car, ESPNOW_GATE_IDENT);
+    CHECK_EQ(f->seq_num, (uint16_t)(seq + 3));
+    CHECK_EQ(f->len, sizeof("logger-7"));
+    CHECK(memcmp(f->data, "logger-7", sizeof("logger-7")) == 0);
+}
+
+static void test_long_name(void) {
+    host_espnow_reset();
+    char name[300];
+    memset(name, 'n', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    CHECK_EQ(tx_set_logger_name(gate, name), ESP_OK);
+    const espnow_data_t *f = sent(0, gate, ESPNOW_GATE_IDENT);
+    CHECK_EQ(f->len, sizeof(f->data));
+    CHECK_EQ(f->data[sizeof(f->data) - 1], '\0');
+    CHECK_EQ(f->data[sizeof(f->data) - 2], 'n');
+}
+
+static void test_errors(void) {
+    host_espnow_reset();
+    unsigned frames = metrics_counters[METRIC_TX_FRAMES];
+
+    host_espnow_fail_add_peer(ESP_ERR_ESPNOW_FULL);
+    CHECK_EQ(tx_ping(gate), ESP_ERR_ESPNOW_FULL);
+    CHECK_EQ(host_espnow_sent_count(), 0);
+
+    // Another task registered it between the check and the add.
+    host_espnow_fail_add_peer(ESP_ERR_ESPNOW_EXIST);
+    CHECK_EQ(tx_ensure_peer(gate), ESP_OK);
+    host_espnow_fail_add_peer(ESP_OK);
+
+    CHECK_EQ(tx_ensure_peer(gate), ESP_OK);
+    host_espnow_fail_send(ESP_ERR_ESPNOW_NO_MEM);
+    CHECK_EQ(tx_ping(gate), ESP_ERR_ESPNOW_NO_MEM);
+    host_espnow_fail_send(ESP_OK);
+    CHECK_EQ(metrics_counters[METRIC_TX_FRAMES], frames);
+
+    CHECK_EQ(tx_ping(gate), ESP_OK);
+    CHECK_EQ(host_espnow_peer_count(), 1);
+    CHECK_EQ(metrics_counters[METRIC_TX_FRAMES], frames + 1);
+}
+
+static void test_no_heap(void) {
+    host_espnow_reset();
+    unsigned bytes = metrics_counters[METRIC_TX_BYTES];
+    unsigned airtime = metrics_counters[METRIC_TX_AIRTIME_US];
+    unsigned fixed = metrics_counters[METRIC_TX_AIRTIME_FIXED_US];
+
+    unsigned long allocs = host_allocs();
+    for (int i = 0; i < 1000; i++) {
+        const uint8_t *mac = i & 1 ? gate : car;
+        tx_ack(mac);
+        tx_ping(mac);
+        tx_ok(mac, (uint16_t)i);
+        tx_ident(mac);
+        tx_set_logger_name(mac, "logger");
+    }
+    CHECK_EQ(host_allocs() - allocs, 0);
+
+    // Sent at their real size: 4 empty frames and one 7-byte name per round.
+    size_t expect = 1000 * (5 * ESPNOW_HEADER_LEN + sizeof("logger"));
+    CHECK_EQ(metrics_counters[METRIC_TX_BYTES] - bytes, expect);
+    CHECK(metrics_counters[METRIC_TX_AIRTIME_US] - airtime < metrics_counters[METRIC_TX_AIRTIME_FIXED_US] - fixed);
+}
+
+int main(void) {
+    CHECK(host_alloc_count_live());
+
+    test_messages();
+    test_long_name();
+    test_errors();
+    test_no_heap();
+    return host_test_result("test_tx");
+}
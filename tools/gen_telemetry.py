@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""Generate the telemetry decoder tables from tools/telemetry_schema.json.
+
+Writes
+  main/telemetry_schema.h              counts and the series map
+  main/telemetry_schema.c              segments[] and telemetry_fields[]
+  frontend/src/lib/telemetry_schema.ts TELEM_SEGMENTS for the dashboard
+
+Both sides decode a field the same way: read the integer in the field's
+byte order, multiply by scale (kept as an exact fraction num/den) and by
+10^decimals, round half away from zero in integer arithmetic, and print
+the result with the decimal point inserted. No floating point is involved,
+so the receiver and the dashboard produce identical strings.
+
+Run after editing the schema; --check exits non-zero if the generated files
+are out of date instead of rewriting them.
+"""
+
+import argparse
+import json
+import sys
+from fractions import Fraction
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+SCHEMA = ROOT / "tools" / "telemetry_schema.json"
+OUT_H = ROOT / "main" / "telemetry_schema.h"
+OUT_C = ROOT / "main" / "telemetry_schema.c"
+OUT_TS = ROOT / "frontend" / "src" / "lib" / "telemetry_schema.ts"
+
+TYPE_SIZE = {"u8": 1, "u16": 2, "i16": 2}
+C_TYPE = {"u8": "TELEMETRY_U8", "u16": "TELEMETRY_U16", "i16": "TELEMETRY_I16"}
+BANNER = "Generated by tools/gen_telemetry.py from tools/telemetry_schema.json. Do not edit."
+MAX_SEGMENTS = 32   # TELEMETRY_MAX_SEGMENTS, the width of the valid mask
+MAX_PAYLOAD = 200   # espnow_data_t.data
+
+
+def fail(msg):
+    sys.exit(f"telemetry_schema.json: {msg}")
+
+
+def load(path):
+    schema = json.loads(path.read_text(encoding="utf-8"))
+    default_order = schema.get("byte_order", "big")
+    segments, fields = [], []
+    offset = 0
+    for s in schema["segments"]:
+        seg = {
+            "id": s["id"], "key": s["key"], "label": s["label"], "len": s["len"],
+            "offset": offset, "first_field": len(fields), "fields": [],
+        }
+        pos = 0
+        for f in s["fields"]:
+            if f["type"] not in TYPE_SIZE:
+                fail(f"{s['key']}.{f['name']}: unknown type {f['type']}")
+            scale = Fraction(f.get("scale", "1"))
+            decimals = int(f.get("decimals", 0))
+            field = {
+                "name": f["name"],
+                "type": f["type"],
+                "big_endian": f.get("byte_order", default_order) == "big",
+                "pos": f.get("offset", pos),
+                "num": scale.numerator,
+                "den": scale.denominator,
+                "decimals": decimals,
+                "unit": f.get("unit", ""),
+                "series": f.get("series"),
+                "labels": f.get("labels", []),
+            }
+            pos = field["pos"] + TYPE_SIZE[f["type"]]
+            if pos > seg["len"]:
+                fail(f"{s['key']}.{f['name']} runs past the {seg['len']}-byte segment")
+            if decimals > 6:
+                fail(f"{s['key']}.{f['name']}: at most 6 decimals")
+            # Worst case numerator must stay exact in a JS number and an int64.
+            if 65535 * field["num"] * 10 ** decimals * 2 >= 2 ** 53:
+                fail(f"{s['key']}.{f['name']}: scale too fine")
+            # telemetry_field_scaled() returns an int32.
+            if 65535 * scale * 10 ** decimals >= 2 ** 31:
+                fail(f"{s['key']}.{f['name']}: scaled value overflows int32")
+            field["offset"] = offset + field["pos"]
+            seg["fields"].append(field)
+            fields.append(field)
+        offset += seg["len"]
+        segments.append(seg)
+
+    if len(segments) > MAX_SEGMENTS:
+        fail(f"more than {MAX_SEGMENTS} segments")
+    if offset > MAX_PAYLOAD:
+        fail(f"segments cover {offset} bytes, more than a frame carries")
+    series = [i for i, f in enumerate(fields) if f["series"]]
+    names = [fields[i]["series"] for i in series]
+    if len(set(names)) != len(names):
+        fail("duplicate series key")
+    return segments, fields, series
+
+
+def c_str(s):
+    if s is None:
+        return "NULL"
+    return json.dumps(s, ensure_ascii=False)
+
+
+def render_h(segments, fields, series):
+    return f"""// {BANNER}
+#ifndef ESP32_RECEIVER_TELEMETRY_SCHEMA_H
+#define ESP32_RECEIVER_TELEMETRY_SCHEMA_H
+
+#include "protocol.h"
+
+#define TELEMETRY_NUM_FIELDS {len(fields)}
+#define TELEMETRY_NUM_SERIES {len(series)}
+#define TELEMETRY_FRAME_LEN {segments[-1]['offset'] + segments[-1]['len']}
+
+extern const telemetry_field_t telemetry_fields[TELEMETRY_NUM_FIELDS];
+// Index into telemetry_fields[] of each field recorded in history, in schema order.
+extern const uint8_t telemetry_series[TELEMETRY_NUM_SERIES];
+
+#endif //ESP32_RECEIVER_TELEMETRY_SCHEMA_H
+"""
+
+
+def render_c(segments, fields, series):
+    out = [f"// {BANNER}", '#include "telemetry_schema.h"', ""]
+    for i, f in enumerate(fields):
+        if f["labels"]:
+            labels = ", ".join(c_str(l) for l in f["labels"])
+            out.append(f"static const char *const labels_{i}[] = {{ {labels} }};")
+    out += ["", "const segment_t segments[] = {"]
+    for s in segments:
+        out.append(f"    {{ .id = 0x{s['id']:02X}, .len = {s['len']}, .offset = {s['offset']}, "
+                   f".name = {c_str(s['key'])}, .first_field = {s['first_field']}, "
+                   f".field_count = {len(s['fields'])} }},")
+    out += ["};", "const int NUM_SEGMENTS = sizeof(segments) / sizeof(segments[0]);", "",
+            "const telemetry_field_t telemetry_fields[TELEMETRY_NUM_FIELDS] = {"]
+    for i, f in enumerate(fields):
+        labels = f"labels_{i}" if f["labels"] else "NULL"
+        out.append(f"    {{ .name = {c_str(f['name'])}, .unit = {c_str(f['unit'])}, "
+                   f".series = {c_str(f['series'])}, .labels = {labels}, "
+                   f".label_count = {len(f['labels'])}, .offset = {f['offset']}, "
+                   f".type = {C_TYPE[f['type']]}, .big_endian = {int(f['big_endian'])}, "
+                   f".decimals = {f['decimals']}, .scale_num = {f['num']}, .scale_den = {f['den']} }},")
+    out += ["};", "", "const uint8_t telemetry_series[TELEMETRY_NUM_SERIES] = {"]
+    out.append("    " + ", ".join(str(i) for i in series) + ",")
+    out += ["};", ""]
+    return "\n".join(out)
+
+
+def render_ts(segments, fields, series):
+    out = [f"// {BANNER}", "",
+           'export type TelemetryFieldType = "u8" | "u16" | "i16";',
+           "",
+           "export interface TelemetryFieldDef {",
+           "  name: string;",
+           "  type: TelemetryFieldType;",
+           "  be: boolean;",
+           "  offset: number;    // within the segment",
+           "  num: number;       // scale = num / den",
+           "  den: number;",
+           "  decimals: number;",
+           "  unit: string;",
+           "  labels?: string[];",
+           "  series?: string;",
+           "}",
+           "",
+           "export interface TelemetrySegmentDef {",
+           "  id: number;",
+           "  key: string;",
+           "  label: string;",
+           "  len: number;",
+           "  offset: number;    // within the payload",
+           "  fields: TelemetryFieldDef[];",
+           "}",
+           "",
+           "export const TELEM_SEGMENTS: TelemetrySegmentDef[] = ["]
+    for s in segments:
+        out.append(f"  {{ id: {s['id']}, key: {json.dumps(s['key'])}, label: {json.dumps(s['label'])}, "
+                   f"len: {s['len']}, offset: {s['offset']}, fields: [")
+        for f in s["fields"]:
+            extra = ""
+            if f["labels"]:
+                extra += f", labels: {json.dumps(f['labels'], ensure_ascii=False)}"
+            if f["series"]:
+                extra += f", series: {json.dumps(f['series'])}"
+            out.append(f"    {{ name: {json.dumps(f['name'])}, type: \"{f['type']}\", "
+                       f"be: {'true' if f['big_endian'] else 'false'}, offset: {f['pos']}, "
+                       f"num: {f['num']}, den: {f['den']}, decimals: {f['decimals']}, "
+                       f"unit: {json.dumps(f['unit'], ensure_ascii=False)}{extra} }},")
+        out.append("  ]},")
+    out += ["];", ""]
+    return "\n".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--check", action="store_true", help="fail if the outputs are stale")
+    args = ap.parse_args()
+
+    tables = load(SCHEMA)
+    outputs = {
+        OUT_H: render_h(*tables),
+        OUT_C: render_c(*tables),
+        OUT_TS: render_ts(*tables),
+    }
+    stale = []
+    for path, text in outputs.items():
+        current = path.read_text(encoding="utf-8") if path.exists() else None
+        if current == text:
+            continue
+        stale.append(path.relative_to(ROOT))
+        if not args.check:
+            path.write_text(text, encoding="utf-8")
+    if args.check and stale:
+        sys.exit("stale: " + ", ".join(map(str, stale)) + " (run tools/gen_telemetry.py)")
+    for p in stale:
+        print(f"wrote {p}")
+
+
+if __name__ == "__main__":
+    main()